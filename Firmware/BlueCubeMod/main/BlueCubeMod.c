@@ -42,7 +42,6 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
-#include <math.h>
 
 #include "btstack.h"
 #include "btstack_event.h"
@@ -57,9 +56,16 @@
 
 #include "esp_err.h"
 #include "esp_log.h"
-#include "driver/rmt.h"
-#include "driver/periph_ctrl.h"
-#include "soc/rmt_reg.h"
+#include "esp_timer.h"
+
+#include "latency_hist.h"
+#include "log_ring.h"
+#include "pad.h"
+#include "report_gate.h"
+
+#if PAD_DRIVER != PAD_DRIVER_GC
+#error "BlueCubeMod reads a GameCube controller, build with PAD_DRIVER=PAD_DRIVER_GC"
+#endif
 
 /*
  GameCube controller advertises as a Dualshock 4 "Wireless Controller"
@@ -82,9 +88,31 @@
 
 #define RMT_TX_CHANNEL    2     /*!< RMT channel for transmitter */
 #define RMT_RX_CHANNEL    3     /*!< RMT channel for receiver */
-#define RMT_CLK_DIV      80    /*!< RMT counter clock divider */
-#define RMT_TICK_10_US    (80000000/RMT_CLK_DIV/100000)   /*!< RMT counter value for 10 us.(Source clock is APB clock) */
-#define rmt_item32_tIMEOUT_US  9500   /*!< RMT receiver timeout value(us) */
+#define GC_POLL_MS       2      /*!< Time between controller polls */
+#define GC_RX_TIMEOUT_MS 2      /*!< Give up on a transfer after this long */
+#define GC_ANALOG_MODE   3      /*!< Poll analog mode 0..4, see components/joybus/include/joybus_cmd.h */
+#define REPORT_RATE_LOG_MS 10000    /*!< Log reports per second this often */
+#define LOG_RING_DRAIN_MS 20        /*!< Print deferred log lines this often, see components/log_ring */
+
+//Only send a report when the input changed, or every REPORT_KEEPALIVE_MS.
+//Otherwise reports go out as fast as the link takes them.
+//#define SEND_ON_CHANGE
+#define REPORT_KEEPALIVE_MS 100
+#define REPORT_RECHECK_MS GC_POLL_MS    /*!< Look for new input this often while holding reports back */
+
+//Raw RX frame capture (CFLAGS += -DGC_CAPTURE) and per-stage latency histograms
+//(CFLAGS += -DLATENCY_TRACE, 'l' typed on the console dumps them) are switched on
+//in the Makefile, see components/pad/include/pad_gc.h and components/input/include/latency_hist.h
+
+//Stick shaping, see components/input/include/stick_shape.h
+#define GC_STICK_RANGE 100      /*!< Raw main stick travel from center to the gate */
+#define GC_CSTICK_RANGE 88      /*!< Raw C-stick travel from center to the gate */
+#define STICK_DEADZONE 256      /*!< Radial deadzone, STICK_NORM (4096) is full deflection */
+#define STICK_OUTER 3840        /*!< Radius that already gives full deflection */
+#define STICK_CURVE 0           /*!< Response curve, 0 linear .. 255 nearly quadratic */
+
+//Stick and trigger ranges are learned while playing, see components/input/include/pad_cal.h
+#define CAL_SAVE_MS 60000       /*!< Write a changed calibration to flash at most this often */
 
 
 //HID Descriptor for GameCube Controller matching a DS4
@@ -155,14 +183,9 @@ static uint8_t device_id_sdp_service_buffer[400];
 static const char hid_device_name[] = "Wireless Controller";
 static btstack_packet_callback_registration_t hci_event_callback_registration;
 static uint16_t hid_cid = 0;
+static report_gate_t gate;
+static btstack_timer_source_t recheck_timer;
 
-// Calibration
-static int lxcalib = 0;
-static int lycalib = 0;
-static int cxcalib = 0;
-static int cycalib = 0;
-static int lcalib = 0;
-static int rcalib = 0;
 //Buttons and sticks
 static uint8_t but1_send = 0;
 static uint8_t but2_send = 0;
@@ -173,313 +196,81 @@ static uint8_t cy_send = 0;
 static uint8_t lt_send = 0;
 static uint8_t rt_send = 0;
 
-//RMT Transmitter Init
-rmt_item32_t items[25];
-rmt_config_t rmt_tx;
-static void rmt_tx_init()
-{
-    
-    rmt_tx.channel = RMT_TX_CHANNEL;
-    rmt_tx.gpio_num = RMT_TX_GPIO_NUM;
-    rmt_tx.mem_block_num = 1;
-    rmt_tx.clk_div = RMT_CLK_DIV;
-    rmt_tx.tx_config.loop_en = false;
-    rmt_tx.tx_config.carrier_freq_hz = 24000000;
-    rmt_tx.tx_config.carrier_level = 1;
-    rmt_tx.tx_config.carrier_en = 0;
-    rmt_tx.tx_config.idle_level = 1;
-    rmt_tx.tx_config.idle_output_en = true;
-    rmt_tx.rmt_mode = 0;
-    rmt_config(&rmt_tx);
-    rmt_driver_install(rmt_tx.channel, 0, 0);
-    
-    //Fill items[] with console->controller command: 0100 0000 0000 0011 0000 0010
-    
-    items[0].duration0 = 3;
-    items[0].level0 = 0;
-    items[0].duration1 = 1;
-    items[0].level1 = 1;
-    items[1].duration0 = 1;
-    items[1].level0 = 0;
-    items[1].duration1 = 3;
-    items[1].level1 = 1;
-    int j;
-    for(j = 0; j < 12; j++) {
-        items[j+2].duration0 = 3;
-        items[j+2].level0 = 0;
-        items[j+2].duration1 = 1;
-        items[j+2].level1 = 1;
-    }
-    items[14].duration0 = 1;
-    items[14].level0 = 0;
-    items[14].duration1 = 3;
-    items[14].level1 = 1;
-    items[15].duration0 = 1;
-    items[15].level0 = 0;
-    items[15].duration1 = 3;
-    items[15].level1 = 1;
-    for(j = 0; j < 8; j++) {
-        items[j+16].duration0 = 3;
-        items[j+16].level0 = 0;
-        items[j+16].duration1 = 1;
-        items[j+16].level1 = 1;
-    }
-    items[24].duration0 = 1;
-    items[24].level0 = 0;
-    items[24].duration1 = 3;
-    items[24].level1 = 1;
-    
-}
-
-//RMT Receiver Init
-rmt_config_t rmt_rx;
-static void rmt_rx_init()
-{
-    rmt_rx.channel = RMT_RX_CHANNEL;
-    rmt_rx.gpio_num = RMT_RX_GPIO_NUM;
-    rmt_rx.clk_div = RMT_CLK_DIV;
-    rmt_rx.mem_block_num = 4;
-    rmt_rx.rmt_mode = RMT_MODE_RX;
-    rmt_rx.rx_config.idle_threshold = rmt_item32_tIMEOUT_US / 10 * (RMT_TICK_10_US);
-    rmt_config(&rmt_rx);
-}
-
 //Polls controller and formats response
-//GameCube Controller Protocol: http://www.int03.co.uk/crema/hardware/gamecube/gc-control.html
 static void get_buttons()
 {
-
     uint8_t but1 = 0;
     uint8_t but2 = 0;
     uint8_t dpad = 0x08;//Released
-    uint8_t lx = 0;
-    uint8_t ly = 0;
-    uint8_t cx = 0;
-    uint8_t cy = 0;
-    uint8_t lt = 0;
-    uint8_t rt = 0;
-    
-    //Sample and find calibration value for sticks
-    int calib_loop = 0;
-    int xsum = 0;
-    int ysum = 0;
-    int cxsum = 0;
-    int cysum = 0;
-    int lsum = 0;
-    int rsum = 0;
-    while(calib_loop < 5)
-    {
-        lx = 0;
-        ly = 0;
-        cx = 0;
-        cy = 0;
-        lt = 0;
-        rt = 0;
-        rmt_write_items(rmt_tx.channel, items, 25, 0);
-        rmt_rx_start(rmt_rx.channel, 1);
-        
-        vTaskDelay(10);
-        
-        rmt_item32_t* item = (rmt_item32_t*) (RMT_CHANNEL_MEM(rmt_rx.channel));
-        if(item[33].duration0 == 1 && item[27].duration0 == 1 && item[26].duration0 == 3 && item[25].duration0 == 3)
-        {
-            
-            //LEFT STICK X
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+41].duration0 == 1))
-                {
-                    lx += pow(2, 8-x-1);
-                }
-            }
-
-            //LEFT STICK Y
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+49].duration0 == 1))
-                {
-                    ly += pow(2, 8-x-1);
-                }
-            }
-            //C STICK X
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+57].duration0 == 1))
-                {
-                    cx += pow(2, 8-x-1);
-                }
-            }
-
-            //C STICK Y
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+65].duration0 == 1))
-                {
-                    cy += pow(2, 8-x-1);
-                }
-            }
-
-            //R AN
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+73].duration0 == 1))
-                {
-                    rt += pow(2, 8-x-1);
-                }
-            }
-
-            //L AN
-            for(int x = 8; x > -1; x--)
-            {
-                if((item[x+81].duration0 == 1))
-                {
-                    lt += pow(2, 8-x-1);
-                }
-            }
-            
-            xsum += lx;
-            ysum += ly;
-            cxsum += cx;
-            cysum += cy;
-            lsum += lt;
-            rsum += rt;
-            calib_loop++;
-        }
-        
-    }
-    
-    //Set Stick Calibration
-    lxcalib = 127-(xsum/5);
-    lycalib = 127-(ysum/5);
-    cxcalib = 127-(cxsum/5);
-    cycalib = 127-(cysum/5);
-    lcalib = 127-(lsum/5);
-    rcalib = 127-(rsum/5);
-
+    pad_state_t state;
     
+    TickType_t last_poll = xTaskGetTickCount();
     while(1)
     {
         but1 = 0;
         but2 = 0;
         dpad = 0x08;
-        lx = 0;
-        ly = 0;
-        cx = 0;
-        cy = 0;
-        lt = 0;
-        rt = 0;
         
-        //Write command to controller
-        rmt_write_items(rmt_tx.channel, items, 25, 0);
-        rmt_rx_start(rmt_rx.channel, 1);
+        vTaskDelayUntil(&last_poll, GC_POLL_MS / portTICK_PERIOD_MS);
         
-        vTaskDelay(6); //6ms between sample
-        
-        rmt_item32_t* item = (rmt_item32_t*) (RMT_CHANNEL_MEM(rmt_rx.channel));
+        LATENCY_STAMP(LATENCY_POLL);
+        pad_event_t event = pad_poll();
+        LATENCY_STAMP(LATENCY_DECODE);
+        if(event == PAD_EVENT_LOST)
+        {
+            //unplugged, let go of everything until it is back
+            but1_send = 0x08;
+            but2_send = 0;
+            lx_send = ly_send = cx_send = cy_send = 0x80;
+            lt_send = rt_send = 0;
+        }
         
-        //Check first 3 bits and high bit at index 33
-        if(item[33].duration0 == 1 && item[27].duration0 == 1 && item[26].duration0 == 3 && item[25].duration0 == 3)
+        if(event == PAD_EVENT_SAMPLE)
         {
-            
-            //Button report: first item is item[25]
-            //0 0 1 S Y X B A
-            //1 L R Z U D R L
-            //Joystick X (8bit)
-            //Joystick Y (8bit)
-            //C-Stick X (8bit)
-            //C-Stick Y (8bit)
-            //L Trigger Analog (8/4bit)
-            //R Trigger Analog (8/4bit)
+            //Switch layout from switch_gc_map(), back to the DS4 buttons
+            pad_decode(0, &state);
             
             //Buttons1
-            if(item[32].duration0 == 1) but1 += 0x40;//A
-            if(item[31].duration0 == 1) but1 += 0x20;//B
-            if(item[30].duration0 == 1) but1 += 0x80;//X
-            if(item[29].duration0 == 1) but1 += 0x10;//Y
+            if(state.buttons & PAD_BTN_A) but1 += 0x40;//A
+            if(state.buttons & PAD_BTN_B) but1 += 0x20;//B
+            if(state.buttons & PAD_BTN_X) but1 += 0x80;//X
+            if(state.buttons & PAD_BTN_Y) but1 += 0x10;//Y
             //DPAD
-            if(item[40].duration0 == 1) dpad = 0x06;//L
-            if(item[39].duration0 == 1) dpad = 0x02;//R
-            if(item[38].duration0 == 1) dpad = 0x04;//D
-            if(item[37].duration0 == 1) dpad = 0x00;//U
+            if(state.buttons & PAD_BTN_LEFT) dpad = 0x06;//L
+            if(state.buttons & PAD_BTN_RIGHT) dpad = 0x02;//R
+            if(state.buttons & PAD_BTN_DOWN) dpad = 0x04;//D
+            if(state.buttons & PAD_BTN_UP) dpad = 0x00;//U
             
             //Buttons2
-            if(item[36].duration0 == 1) but2 += 0x02;//Z
-            if(item[35].duration0 == 1) but2 += 0x08;//RB
-            if(item[34].duration0 == 1) but2 += 0x04;//LB
-            if(item[28].duration0 == 1) but2 += 0x20;//START/OPTIONS/+
-            if(but2 == 0x22)  but2 += 0x10;//Select =  Z + Start
-
-            //LEFT STICK X
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+41].duration0 == 1)
-                {
-                    lx += pow(2, 8-x-1);
-                }
-            }
-
-            //LEFT STICK Y
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+49].duration0 == 1)
-                {
-                    ly += pow(2, 8-x-1);
-                }
-            }
-            
-            //C STICK X
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+57].duration0 == 1)
-                {
-                    cx += pow(2, 8-x-1);
-                }
-            }
-            
-            //C STICK Y
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+65].duration0 == 1)
-                {
-                    cy += pow(2, 8-x-1);
-                }
-            }
-            
-            //R AN
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+73].duration0 == 1)
-                {
-                    rt += pow(2, 8-x-1);
-                }
-            }
-            
-            //L AN
-            for(int x = 8; x > -1; x--)
-            {
-                if(item[x+81].duration0 == 1)
-                {
-                    lt += pow(2, 8-x-1);
-                }
-            }
+            if(state.buttons & PAD_BTN_R) but2 += 0x02;//Z
+            if(state.buttons & PAD_BTN_ZR) but2 += 0x08;//RB
+            if(state.buttons & PAD_BTN_ZL) but2 += 0x04;//LB
+            if(state.buttons & PAD_BTN_PLUS) but2 += 0x20;//START/OPTIONS/+
+            if(state.buttons & PAD_BTN_MINUS) but2 += 0x30;//Select =  Z + Start, Options stays held
             
             but1_send = but1 + dpad;
             but2_send = but2;
-            lx_send = lx + lxcalib;
-            ly_send = ly + lycalib;
-            cx_send = cx + cxcalib;
-            cy_send = cy + cycalib;
-            lt_send = lt;
-            rt_send = rt;
-            
-        }else{
-            //log_info("read fail");
+            //12 bit shaped sticks, the DS4 report has 8 bits
+            lx_send = state.lx >> 4;
+            ly_send = state.ly >> 4;
+            cx_send = state.rx >> 4;
+            cy_send = state.ry >> 4;
+            lt_send = state.lt;
+            rt_send = state.rt;
+            LATENCY_STAMP(LATENCY_PUBLISH);
         }
-        
     }
 }
 
 
+//Input unchanged: ask for another send slot once the controller was polled again
+static void recheck_handler(btstack_timer_source_t *ts)
+{
+    UNUSED(ts);
+    if(hid_cid != 0)
+        hid_device_request_can_send_now_event(hid_cid);
+}
+
 static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t * packet, uint16_t packet_size){
     UNUSED(channel);
     UNUSED(packet_size);
@@ -496,6 +287,7 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t * pack
                             break;
                         case HID_SUBEVENT_CONNECTION_CLOSED:
                             log_info("HID Disconnected");
+                            btstack_run_loop_remove_timer(&recheck_timer);
                             hid_cid = 0;
                             break;
                         case HID_SUBEVENT_CAN_SEND_NOW:
@@ -507,8 +299,24 @@ static void packet_handler(uint8_t packet_type, uint16_t channel, uint8_t * pack
                             send_report[9] = but2_send;
                             send_report[11] = lt_send;
                             send_report[12] = rt_send;
-                            hid_device_send_interrupt_message(hid_cid, &send_report[0], sizeof(send_report));
-                            hid_device_request_can_send_now_event(hid_cid);
+                            if(report_gate_check(&gate, &send_report[4], sizeof(send_report) - 4, esp_timer_get_time()))
+                            {
+                                LATENCY_STAMP(LATENCY_SEND);
+                                hid_device_send_interrupt_message(hid_cid, &send_report[0], sizeof(send_report));
+                                LATENCY_STAMP(LATENCY_SENT);
+                                hid_device_request_can_send_now_event(hid_cid);
+                            }
+                            else
+                            {
+                                btstack_run_loop_set_timer_handler(&recheck_timer, recheck_handler);
+                                btstack_run_loop_set_timer(&recheck_timer, REPORT_RECHECK_MS);
+                                btstack_run_loop_add_timer(&recheck_timer);
+                            }
+                            report_gate_stats_t rate;
+                            if(report_gate_rates(&gate, esp_timer_get_time(), REPORT_RATE_LOG_MS * 1000, &rate))
+                                log_info("%u reports/s (%u changed, %u keepalive, %u unchanged), %u/s skipped",
+                                    (unsigned)rate.sent, (unsigned)rate.changed, (unsigned)rate.keepalive,
+                                    (unsigned)rate.unchanged, (unsigned)rate.skipped);
                             break;
                         default:
                             break;
@@ -529,16 +337,37 @@ int btstack_main(int argc, const char * argv[]){
     (void)argc;
     (void)argv;
     
-    //RMT init
-    rmt_tx_init();
-    rmt_rx_init();
+    static const pad_config_t pad_config = {
+        .tx_gpio = RMT_TX_GPIO_NUM,
+        .rx_gpio = RMT_RX_GPIO_NUM,
+        .tx_channel = RMT_TX_CHANNEL,
+        .rx_channel = RMT_RX_CHANNEL,
+        .analog_mode = GC_ANALOG_MODE,
+        .rx_timeout_ms = GC_RX_TIMEOUT_MS,
+        .stick_range = GC_STICK_RANGE,
+        .cstick_range = GC_CSTICK_RANGE,
+        .deadzone = STICK_DEADZONE,
+        .outer = STICK_OUTER,
+        .curve = STICK_CURVE,
+        .cal_save_ms = CAL_SAVE_MS,
+    };
+    
+    log_ring_start(LOG_RING_DRAIN_MS);
+#ifdef LATENCY_TRACE
+    latency_console_start();
+#endif
+#ifdef SEND_ON_CHANGE
+    report_gate_init(&gate, true, REPORT_KEEPALIVE_MS * 1000);
+#else
+    report_gate_init(&gate, false, 0);
+#endif
+    
+    //RMT and stick tables from the stored calibration, learning goes on in get_buttons
+    pad_init(&pad_config);
     
     //format button report from controller
     xTaskCreate(get_buttons, "get_buttons", 2048, NULL, 1, NULL);
     
-    // Wait for stick calibration
-    vTaskDelay(200);
-    
     hci_event_callback_registration.callback = &packet_handler;
     hci_add_event_handler(&hci_event_callback_registration);
     hci_register_sco_packet_handler(&packet_handler);
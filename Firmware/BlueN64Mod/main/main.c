@@ -0,0 +1,70 @@
+//
+//  BlueN64Mod Firmware
+//
+//
+//  Created by Nathan Reeves 2019
+//
+
+#include "switch_app.h"
+
+#if PAD_DRIVER != PAD_DRIVER_N64
+#error "BlueN64Mod reads an N64 controller, build with PAD_DRIVER=PAD_DRIVER_N64"
+#endif
+
+#define LED_GPIO    25
+
+//for reading the N64 controller
+#define RMT_TX_GPIO_NUM  23     // N64 TX GPIO ----
+#define RMT_RX_GPIO_NUM  18     // N64 RX GPIO ----
+#define RMT_TX_CHANNEL    2     /*!< RMT channel for transmitter */
+#define RMT_RX_CHANNEL    3     /*!< RMT channel for receiver */
+#define N64_POLL_MS      1      /*!< Time between controller polls, 1 polls at 1kHz */
+#define N64_RX_TIMEOUT_MS 2     /*!< Give up on a transfer after this long */
+#define REPORT_PERIOD_US 15000  /*!< Time between Switch input reports, e.g. 8000, 15000 or 16667 */
+#define SCHED_STATS_REPORTS 1000    /*!< Log sample age and report jitter every this many reports */
+#define REPORT_RATE_LOG_MS 10000    /*!< Log reports per second this often */
+#define LOG_RING_DRAIN_MS 20        /*!< Print deferred log lines this often, see components/log_ring */
+
+//Only send a report when the input changed, or every REPORT_KEEPALIVE_MS
+//#define SEND_ON_CHANGE
+#define REPORT_KEEPALIVE_MS 100
+#define REPORT_MIN_GAP_US 8000  /*!< A change goes out right away, but no sooner than this after the previous report */
+
+//HID report trace, raw RX frame capture, latency histograms and
+//microbenchmarks are switched on in the Makefile, see
+//components/switch_app/include/switch_app.h and components/pad/include/pad_n64.h
+
+//Stick shaping, see components/input/include/stick_shape.h and switch_n64.h
+#define STICK_DEADZONE 256      /*!< Radial deadzone, STICK_NORM (4096) is full deflection */
+#define STICK_OUTER 3584        /*!< Radius that already gives full deflection, worn sticks rarely reach the gate */
+#define STICK_CURVE 0           /*!< Response curve, 0 linear .. 255 nearly quadratic */
+
+void app_main() {
+    static const switch_app_config_t config = {
+        .name = "BlueN64Mod",
+        .description = "BlueN64Mod Example",
+        .led_gpio = LED_GPIO,
+        .poll_ms = N64_POLL_MS,
+        .report_period_us = REPORT_PERIOD_US,
+#ifdef SEND_ON_CHANGE
+        .send_on_change = true,
+#endif
+        .keepalive_ms = REPORT_KEEPALIVE_MS,
+        .min_gap_us = REPORT_MIN_GAP_US,
+        .sched_stats_reports = SCHED_STATS_REPORTS,
+        .rate_log_ms = REPORT_RATE_LOG_MS,
+        .log_drain_ms = LOG_RING_DRAIN_MS,
+        .pad = {
+            .tx_gpio = RMT_TX_GPIO_NUM,
+            .rx_gpio = RMT_RX_GPIO_NUM,
+            .tx_channel = RMT_TX_CHANNEL,
+            .rx_channel = RMT_RX_CHANNEL,
+            .rx_timeout_ms = N64_RX_TIMEOUT_MS,
+            .deadzone = STICK_DEADZONE,
+            .outer = STICK_OUTER,
+            .curve = STICK_CURVE,
+        },
+    };
+
+    switch_app_start(&config);
+}
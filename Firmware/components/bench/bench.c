@@ -0,0 +1,85 @@
+//
+//  Microbenchmarks of the hot paths
+//
+
+#include <stdio.h>
+
+#include "bench.h"
+
+#ifdef __XTENSA__
+#include "rom/ets_sys.h"
+#endif
+
+void bench_run(const bench_case_t *c, uint32_t rounds, uint32_t iters, bench_result_t *result)
+{
+    uint32_t per_op[BENCH_ROUNDS_MAX];
+
+    if(rounds > BENCH_ROUNDS_MAX)
+        rounds = BENCH_ROUNDS_MAX;
+    if(rounds == 0)
+        rounds = 1;
+    if(iters == 0)
+        iters = 1;
+    if(c->setup != NULL)
+        c->setup();
+
+    //warm-up round, not counted
+    c->fn(iters);
+    for(uint32_t r = 0; r < rounds; r++)
+    {
+        uint32_t start = bench_now();
+        c->fn(iters);
+        uint32_t elapsed = bench_now() - start;
+        per_op[r] = ((uint64_t)elapsed * 10 + iters / 2) / iters;
+    }
+
+    //insertion sort, rounds are few
+    for(uint32_t i = 1; i < rounds; i++)
+    {
+        uint32_t v = per_op[i];
+        uint32_t j = i;
+        for(; j > 0 && per_op[j - 1] > v; j--)
+            per_op[j] = per_op[j - 1];
+        per_op[j] = v;
+    }
+    result->name = c->name;
+    result->min = per_op[0];
+    result->med = per_op[rounds / 2];
+    result->max = per_op[rounds - 1];
+}
+
+void bench_print_header(uint32_t rounds, uint32_t iters)
+{
+    printf(BENCH_LOG_PREFIX " target=" BENCH_TARGET " unit=" BENCH_UNIT);
+#ifdef __XTENSA__
+    printf(" mhz=%u", (unsigned)ets_get_cpu_frequency());
+#endif
+    printf(" rounds=%u iters=%u\n", (unsigned)rounds, (unsigned)iters);
+}
+
+void bench_print(const bench_result_t *result)
+{
+    printf(BENCH_LOG_PREFIX " case=%s min=%u.%u med=%u.%u max=%u.%u\n", result->name,
+        (unsigned)(result->min / 10), (unsigned)(result->min % 10),
+        (unsigned)(result->med / 10), (unsigned)(result->med % 10),
+        (unsigned)(result->max / 10), (unsigned)(result->max % 10));
+}
+
+void bench_print_end(void)
+{
+    printf(BENCH_LOG_PREFIX " end\n");
+    fflush(stdout);
+}
+
+void bench_run_all(void)
+{
+    bench_result_t result;
+
+    bench_print_header(BENCH_ROUNDS, BENCH_ITERS);
+    for(uint32_t i = 0; i < bench_case_count; i++)
+    {
+        bench_run(&bench_cases[i], BENCH_ROUNDS, BENCH_ITERS, &result);
+        bench_print(&result);
+    }
+    bench_print_end();
+}
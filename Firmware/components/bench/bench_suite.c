@@ -0,0 +1,370 @@
+//
+//  Benchmark cases
+//
+//  Every case cycles through BENCH_SAMPLES inputs made up in its setup, so
+//  a single input's branch pattern does not make the figure look better
+//  than it is, and folds each result into a volatile sink so the work
+//  cannot be optimized away.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "gc_frame.h"
+#include "joybus_cmd.h"
+#include "log_ring.h"
+#include "n64_frame.h"
+#include "pad_cal.h"
+#include "stick_shape.h"
+#include "switch_gc.h"
+#include "switch_input.h"
+#include "switch_n64.h"
+#include "switch_spi.h"
+#include "switch_subcmd.h"
+#include "switch_xnes.h"
+
+#define BENCH_SAMPLES       16      // a power of two
+#define SAMPLE(i)           ((i) & (BENCH_SAMPLES - 1))
+
+#define OUTPUT_REPORT_LEN   49
+#define INPUT_REPORT_LEN    13
+
+static volatile uint32_t sink;
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+//Empty loop, the overhead every other case includes
+static void loop_fn(uint32_t iters)
+{
+    for(uint32_t i = 0; i < iters; i++)
+        sink += i;
+}
+
+//
+//  Controller frames
+//
+
+static uint32_t gc_frames[BENCH_SAMPLES][GC_FRAME_ITEMS + 1];
+static uint32_t n64_frames[BENCH_SAMPLES][N64_FRAME_ITEMS + 1];
+
+static uint32_t *put_byte(uint32_t *p, uint8_t b)
+{
+    for(int bit = 7; bit >= 0; bit--)
+        *p++ = (b >> bit) & 1 ? JOYBUS_ITEM_ONE : JOYBUS_ITEM_ZERO;
+    return p;
+}
+
+//RX frame as the RMT receiver sees it: command echo, stop bit, response,
+//stop bit and the idle that ends the frame
+static void make_frame(joybus_cmd_id_t id, const uint8_t *response, uint8_t len, uint32_t *items)
+{
+    const joybus_cmd_t *cmd = &joybus_cmds[id];
+
+    for(int i = 0; i < cmd->len; i++)
+        items = put_byte(items, cmd->bytes[i]);
+    *items++ = JOYBUS_ITEM(1, 5);
+    for(int i = 0; i < len; i++)
+        items = put_byte(items, response[i]);
+    *items = JOYBUS_ITEM(1, 0);
+}
+
+static void gc_setup(void)
+{
+    uint32_t seed = 0x4743;
+    uint8_t status[GC_STATUS_LEN];
+
+    for(int s = 0; s < BENCH_SAMPLES; s++)
+    {
+        for(int i = 0; i < GC_STATUS_LEN; i++)
+            status[i] = xorshift(&seed);
+        //valid header: 0 0 1 in the first byte, 1 opens the second
+        status[GC_BYTE_BUTTONS0] = (status[GC_BYTE_BUTTONS0] & 0x1F) | 0x20;
+        status[GC_BYTE_BUTTONS1] |= 0x80;
+        make_frame(JOYBUS_POLL, status, GC_STATUS_LEN, gc_frames[s]);
+    }
+}
+
+static void gc_fn(uint32_t iters)
+{
+    uint8_t status[GC_STATUS_LEN];
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        gc_frame_decode(gc_frames[SAMPLE(i)], status);
+        sink += status[GC_BYTE_LX];
+    }
+}
+
+static void n64_setup(void)
+{
+    uint32_t seed = 0x4E36;
+    uint8_t status[N64_STATUS_LEN];
+
+    for(int s = 0; s < BENCH_SAMPLES; s++)
+    {
+        for(int i = 0; i < N64_STATUS_LEN; i++)
+            status[i] = xorshift(&seed);
+        make_frame(JOYBUS_N64_POLL, status, N64_STATUS_LEN, n64_frames[s]);
+    }
+}
+
+static void n64_fn(uint32_t iters)
+{
+    uint8_t status[N64_STATUS_LEN];
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        n64_frame_decode(n64_frames[SAMPLE(i)], status);
+        sink += status[N64_BYTE_X];
+    }
+}
+
+//
+//  Button mapping and report encoding
+//
+
+static uint8_t gc_status[BENCH_SAMPLES][GC_STATUS_LEN];
+static uint8_t n64_status[BENCH_SAMPLES][N64_STATUS_LEN];
+static stick_shape_t lstick, cstick;
+static pad_cal_t cal;
+static uint32_t pressed[BENCH_SAMPLES];
+
+//Decoded status words and the stick tables of the default calibration
+static void gc_map_setup(void)
+{
+    static const uint8_t range[PAD_CAL_STICK_AXES] = { 100, 100, 88, 88 };
+    stick_shape_config_t config = { .deadzone = 256, .outer = 3840, .octagon = true };
+
+    gc_setup();
+    for(int s = 0; s < BENCH_SAMPLES; s++)
+        gc_frame_decode(gc_frames[s], gc_status[s]);
+    pad_cal_init(&cal, range);
+    config.x = cal.data.axis[PAD_CAL_LX];
+    config.y = cal.data.axis[PAD_CAL_LY];
+    stick_shape_init(&lstick, &config);
+    config.x = cal.data.axis[PAD_CAL_CX];
+    config.y = cal.data.axis[PAD_CAL_CY];
+    stick_shape_init(&cstick, &config);
+}
+
+static void gc_map_fn(uint32_t iters)
+{
+    pad_state_t state;
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        switch_gc_map(gc_status[SAMPLE(i)], &lstick, &cstick, &cal, &state);
+        sink += state.buttons + state.lx;
+    }
+}
+
+static void n64_map_setup(void)
+{
+    n64_setup();
+    for(int s = 0; s < BENCH_SAMPLES; s++)
+        n64_frame_decode(n64_frames[s], n64_status[s]);
+    switch_n64_stick_init(&lstick, 256, 3584, 0);
+}
+
+static void n64_map_fn(uint32_t iters)
+{
+    pad_state_t state;
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        switch_n64_map(n64_status[SAMPLE(i)], &lstick, &state);
+        sink += state.buttons + state.lx;
+    }
+}
+
+static void xnes_setup(void)
+{
+    uint32_t seed = 0x584E;
+
+    for(int s = 0; s < BENCH_SAMPLES; s++)
+        pressed[s] = xorshift(&seed) & 0xFFF;
+}
+
+static void xnes_map(uint32_t iters, switch_xnes_layout_t layout)
+{
+    pad_state_t state;
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        switch_xnes_map(pressed[SAMPLE(i)], layout, &state);
+        sink += state.buttons;
+    }
+}
+
+static void xnes_nes_fn(uint32_t iters)
+{
+    xnes_map(iters, SWITCH_XNES_NES);
+}
+
+static void xnes_snes_fn(uint32_t iters)
+{
+    xnes_map(iters, SWITCH_XNES_SNES);
+}
+
+//Poller side: encode a decoded pad into the report bytes, publish to the sender
+static void publish_fn(uint32_t iters)
+{
+    pad_state_t state;
+    switch_input_t input;
+
+    pad_state_neutral(&state);
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        uint32_t v = pressed[SAMPLE(i)];
+        state.buttons = v | v << 12;
+        state.lx = v & 0xFFF;
+        state.ly = (v >> 1) & 0xFFF;
+        switch_input_encode_state(&input, &state);
+        switch_input_publish(&input);
+    }
+}
+
+//Sender side of send_buttons(): copy the published input into report 0x30
+//and stamp the timer byte
+static uint8_t report30[INPUT_REPORT_LEN] = { 0x30, 0x00, 0x80, [INPUT_REPORT_LEN - 1] = 0x08 };
+
+static void report30_fn(uint32_t iters)
+{
+    switch_input_t input;
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        switch_input_read(&input);
+        memcpy(&report30[SWITCH_INPUT_OFFSET], input.data, SWITCH_INPUT_LEN);
+        report30[1] = switch_input_timer();
+        sink += report30[SWITCH_INPUT_OFFSET];
+    }
+}
+
+//
+//  Subcommand replies
+//
+
+//Device info reply of the Switch firmwares, MAC left as is
+static const uint8_t device_info[] = { 0x03, 0x48, 0x03, 0x02, 0xD8, 0xA0, 0x1D, 0x40, 0x15, 0x66, 0x03, 0x00 };
+
+#define DATA(d) d, sizeof(d)
+static const switch_subcmd_t subcmd_table[] = {
+    //subcmd key_len key    handler                  ack   payload
+    { 0x02, 0, 0,           NULL,                    0x82, DATA(device_info) },
+    { 0x03, 0, 0,           NULL,                    0x80, NULL, 0 },
+    { 0x10, 0, 0,           switch_spi_read_subcmd,  0x90, NULL, 0 },
+    { 0x30, 1, 0x01,        NULL,                    0x80, NULL, 0 },
+    { 0x40, 1, 0x01,        NULL,                    0x80, NULL, 0 },
+    { 0x48, 1, 0x01,        NULL,                    0x80, NULL, 0 },
+};
+
+static uint8_t packet[OUTPUT_REPORT_LEN];
+
+static void send_reply(const uint8_t *reply, uint16_t len)
+{
+    sink += reply[SWITCH_REPLY_SUBCMD] + len;
+}
+
+static void subcmd_setup(uint8_t subcmd, const uint8_t *arg, uint8_t arg_len)
+{
+    switch_subcmd_init(subcmd_table, sizeof(subcmd_table) / sizeof(subcmd_table[0]), send_reply);
+    memset(packet, 0, sizeof(packet));
+    packet[0] = 0x01;
+    packet[SWITCH_SUBCMD_OFFSET] = subcmd;
+    if(arg_len > 0)
+        memcpy(&packet[SWITCH_SUBCMD_ARG], arg, arg_len);
+}
+
+static void device_info_setup(void)
+{
+    subcmd_setup(0x02, NULL, 0);
+}
+
+//Factory stick calibration, read during every pairing
+static void spi_read_setup(void)
+{
+    static const uint8_t arg[] = { 0x3D, 0x60, 0x00, 0x00, 0x19 };
+    subcmd_setup(SWITCH_SUBCMD_SPI_READ, arg, sizeof(arg));
+}
+
+//Shipment state has no entry, it gets the generic ACK
+static void ack_setup(void)
+{
+    subcmd_setup(0x08, NULL, 0);
+}
+
+static void subcmd_fn(uint32_t iters)
+{
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        packet[1] = i;
+        switch_subcmd_dispatch(packet, sizeof(packet));
+    }
+}
+
+//
+//  Logging from a callback
+//
+//  The line send_task logs every rate_log_ms, once through the ring (the
+//  write LOG_RING_I does plus the read the drain task does later) and once
+//  formatted the way ESP_LOGI does before the text goes out. Neither
+//  includes the UART: at 115200 baud ESP_LOGI also waits about 87 us per
+//  character once the 128 byte FIFO is full.
+//
+
+#define LOG_TAG     "send_task"
+#define LOG_FMT     "%u reports/s (%u changed, %u keepalive, %u unchanged), %u/s skipped"
+
+static void log_ring_fn(uint32_t iters)
+{
+    log_ring_entry_t entry;
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        const uint32_t args[] = { 66, i & 63, 6, 0, i >> 4 };
+        log_ring_write(LOG_RING_INFO, i, LOG_TAG, LOG_FMT, args, 5);
+        log_ring_read(&entry);
+        sink += entry.args[1];
+    }
+}
+
+static void log_format_fn(uint32_t iters)
+{
+    char line[128];
+
+    for(uint32_t i = 0; i < iters; i++)
+    {
+        //LOG_FORMAT(I, ...) of esp_log.h, colours included
+        snprintf(line, sizeof(line), "\033[0;32mI (%u) %s: " LOG_FMT "\033[0m\n",
+            (unsigned)i, LOG_TAG, 66u, (unsigned)(i & 63), 6u, 0u, (unsigned)(i >> 4));
+        sink += line[10];
+    }
+}
+
+const bench_case_t bench_cases[] = {
+    { "loop",               NULL,               loop_fn },
+    { "gc_frame_decode",    gc_setup,           gc_fn },
+    { "n64_frame_decode",   n64_setup,          n64_fn },
+    { "gc_map",             gc_map_setup,       gc_map_fn },
+    { "n64_map",            n64_map_setup,      n64_map_fn },
+    { "xnes_map_nes",       xnes_setup,         xnes_nes_fn },
+    { "xnes_map_snes",      xnes_setup,         xnes_snes_fn },
+    { "input_publish",      xnes_setup,         publish_fn },
+    { "report30",           NULL,               report30_fn },
+    { "subcmd_device_info", device_info_setup,  subcmd_fn },
+    { "subcmd_spi_read",    spi_read_setup,     subcmd_fn },
+    { "subcmd_ack",         ack_setup,          subcmd_fn },
+    { "log_ring",           NULL,               log_ring_fn },
+    { "log_format",         NULL,               log_format_fn },
+};
+
+const uint32_t bench_case_count = sizeof(bench_cases) / sizeof(bench_cases[0]);
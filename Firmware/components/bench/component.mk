@@ -0,0 +1,8 @@
+#
+# "bench" component makefile.
+#
+# Microbenchmarks of the decode, mapping, report and reply paths of the
+# firmwares, run at startup with CFLAGS += -DBENCH. Plain C apart from the
+# cycle counter, also built by Firmware/host.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
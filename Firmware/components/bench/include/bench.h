@@ -0,0 +1,110 @@
+//
+//  Microbenchmarks of the hot paths
+//
+//  Every case runs its operation iters times per round. The first round
+//  warms the caches (on the ESP32 the code runs from flash through the
+//  cache) and is dropped, the cost per operation of the other rounds gives
+//  min, median and max. The median is the figure to compare, the minimum is
+//  what the code costs without interrupts or preemption in between.
+//
+//  Time comes from the CCOUNT register on the ESP32 (CPU cycles) and from
+//  the monotonic clock elsewhere (ns), the unit is part of the output. The
+//  counter is 32 bit: a round must stay below 2^32 units, 17 s at 240 MHz
+//  and 4 s in ns.
+//
+//  Results are printed as BENCH_LOG_PREFIX lines of key=value fields,
+//  one header, one line per case and an end marker. The ESP32 header also
+//  gives the CPU clock (mhz=240).
+//
+//    BNCH: target=host unit=ns rounds=31 iters=256
+//    BNCH: case=gc_frame_decode min=57.4 med=58.6 max=61.6
+//    BNCH: end
+//
+//  Firmware/host bench_cmp compares two such runs, from a monitor log or
+//  from the host build of the suite (Firmware/host bench).
+//
+//  The firmwares run the suite at startup when BENCH is defined for the
+//  whole build (CFLAGS += -DBENCH in the project Makefile).
+//
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+
+#define BENCH_LOG_PREFIX    "BNCH:"
+
+#ifndef BENCH_ROUNDS
+#define BENCH_ROUNDS        31
+#endif
+#ifndef BENCH_ITERS
+#define BENCH_ITERS         256
+#endif
+#define BENCH_ROUNDS_MAX    255
+
+#ifdef __XTENSA__
+
+#define BENCH_TARGET        "esp32"
+#define BENCH_UNIT          "cycles"
+
+static inline uint32_t bench_now(void)
+{
+    uint32_t ccount;
+    __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+    return ccount;
+}
+
+#else
+
+#include <time.h>
+
+#define BENCH_TARGET        "host"
+#define BENCH_UNIT          "ns"
+
+static inline uint32_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000000000u + (uint32_t)ts.tv_nsec;
+}
+
+#endif
+
+//Runs the operation iters times
+typedef void (*bench_fn)(uint32_t iters);
+
+typedef struct {
+    const char *name;
+    void (*setup)(void);        // once before the rounds, may be NULL
+    bench_fn fn;
+} bench_case_t;
+
+//Cost per operation in tenths of BENCH_UNIT
+typedef struct {
+    const char *name;
+    uint32_t min;
+    uint32_t med;
+    uint32_t max;
+} bench_result_t;
+
+//rounds is cut to BENCH_ROUNDS_MAX
+void bench_run(const bench_case_t *c, uint32_t rounds, uint32_t iters, bench_result_t *result);
+
+void bench_print_header(uint32_t rounds, uint32_t iters);
+void bench_print(const bench_result_t *result);
+void bench_print_end(void);
+
+//The suite: GameCube and N64 frame decode, GameCube, N64 and NES/SNES
+//mapping to pad_state_t, input encoding, report 0x30 assembly,
+//subcommand replies and a log line through log_ring against formatting it
+//like ESP_LOGI.
+//
+//The subcommand cases install their own table with switch_subcmd_init(),
+//the firmware has to register its own afterwards.
+extern const bench_case_t bench_cases[];
+extern const uint32_t bench_case_count;
+
+//Runs every case with BENCH_ROUNDS x BENCH_ITERS and prints the results
+void bench_run_all(void);
+
+#endif
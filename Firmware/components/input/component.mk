@@ -0,0 +1,8 @@
+#
+# "input" component makefile.
+#
+# Controller independent input handling shared by the firmwares: poll
+# scheduling, report pacing, stick shaping, learned calibration, latency
+# histograms and input state between the poller and the Bluetooth sender.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,97 @@
+//
+//  Per-stage latency histograms
+//
+//  The poller and the sender stamp each step a sample goes through with
+//  esp_timer_get_time():
+//
+//  Poller:  LATENCY_POLL    command written to the controller
+//           LATENCY_RX      response received
+//           LATENCY_DECODE  response decoded
+//           LATENCY_PUBLISH input published to the sender
+//  Sender:  LATENCY_SEND    report handed to the Bluetooth stack
+//           LATENCY_SENT    send call returned
+//
+//  The time between neighbouring stamps goes into fixed bucket histograms
+//  in static memory. The poller spans are recorded for every published
+//  sample, the sender spans for every report, measured from the sample
+//  published last when the send started. latency_dump() prints them, the
+//  console task does that when 'l' is typed on the UART ('L' also resets).
+//
+//  Stamping costs one esp_timer_get_time() and a short critical section.
+//  Everything is compiled out unless LATENCY_TRACE is defined for the
+//  whole build (CFLAGS += -DLATENCY_TRACE in the project Makefile), the
+//  LATENCY_STAMP() calls then expand to nothing.
+//
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef enum {
+    LATENCY_POLL,
+    LATENCY_RX,
+    LATENCY_DECODE,
+    LATENCY_PUBLISH,
+    LATENCY_SEND,
+    LATENCY_SENT,
+    LATENCY_STAMPS
+} latency_stamp_t;
+
+typedef enum {
+    LATENCY_SPAN_BUS,           // poll -> rx, controller transfer
+    LATENCY_SPAN_DECODE,        // rx -> decode
+    LATENCY_SPAN_PUBLISH,       // decode -> publish, mapping and stick shaping
+    LATENCY_SPAN_WAIT,          // publish -> send, sample waiting for its report
+    LATENCY_SPAN_SEND,          // send -> sent, Bluetooth stack call
+    LATENCY_SPAN_TOTAL,         // poll -> sent
+    LATENCY_SPANS
+} latency_span_t;
+
+//Four buckets per power of two: 0..3us one each, then 4,5,6,7, 8,10,12,14,
+//16,20,24,28us and so on. The last bucket takes everything from 114688us.
+#define LATENCY_BUCKETS     64
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint64_t total_us;          // mean = total_us / count
+    uint32_t bucket[LATENCY_BUCKETS];
+} latency_hist_t;
+
+static inline uint8_t latency_bucket(uint32_t us)
+{
+    if(us < 4)
+        return us;
+    uint8_t msb = 31 - __builtin_clz(us);
+    uint32_t bucket = (msb - 1) * 4 + ((us >> (msb - 2)) & 3);
+    return bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1;
+}
+
+//Smallest value that lands in bucket
+static inline uint32_t latency_bucket_floor(uint8_t bucket)
+{
+    if(bucket < 4)
+        return bucket;
+    return (uint32_t)(4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+#ifdef LATENCY_TRACE
+
+void latency_stamp(latency_stamp_t stamp);
+void latency_get(latency_span_t span, latency_hist_t *out, bool reset);
+//Prints every span over the console
+void latency_dump(bool reset);
+//Starts a low priority task that dumps on 'l'/'L' from the console
+void latency_console_start(void);
+
+#define LATENCY_STAMP(stamp)    latency_stamp(stamp)
+
+#else
+
+#define LATENCY_STAMP(stamp)    do {} while(0)
+
+#endif
+
+#endif
@@ -0,0 +1,97 @@
+//
+//  Learned controller calibration
+//
+//  Learns center, min and max of the four stick axes and the rest and
+//  full press values of the two analog triggers from normal play:
+//
+//    center   follows the stick slowly while it rests within
+//             PAD_CAL_CENTER_WINDOW of the current center
+//    min/max  the furthest values seen on two polls in a row (a single
+//             glitched frame is ignored); until a side has been pushed to
+//             at least 3/4 of the default range the default range is used
+//    triggers lowest value seen on two polls in a row is the rest value, the
+//             highest one is full press once it is at least half the
+//             range above rest (255 until then)
+//
+//  The controller's own origin (pad_cal_set_origin()) or else the first
+//  valid sample seeds the calibration, so no sampling at boot is needed.
+//  pad_cal_data_t is the part worth storing (see pad_cal_nvs.h); a stored
+//  copy is loaded with pad_cal_load() and learning continues from there.
+//
+//  One task updates the calibration; pad_cal_snapshot() gives any other
+//  task a consistent copy of the data.
+//
+
+#ifndef PAD_CAL_H
+#define PAD_CAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "stick_shape.h"
+
+#define PAD_CAL_VERSION         1
+
+#ifndef PAD_CAL_CENTER_WINDOW
+#define PAD_CAL_CENTER_WINDOW   10  // raw units around the center that count as resting
+#endif
+#ifndef PAD_CAL_CENTER_SHIFT
+#define PAD_CAL_CENTER_SHIFT    9   // center moves 1/512 of the distance per resting sample
+#endif
+#define PAD_CAL_SEED_WINDOW     40  // first samples further than this from 128 are not a center
+
+enum {
+    PAD_CAL_LX,
+    PAD_CAL_LY,
+    PAD_CAL_CX,
+    PAD_CAL_CY,
+    PAD_CAL_STICK_AXES,
+};
+
+enum {
+    PAD_CAL_L,
+    PAD_CAL_R,
+    PAD_CAL_TRIGGERS,
+};
+
+typedef struct {
+    uint8_t version;
+    stick_axis_cal_t axis[PAD_CAL_STICK_AXES];
+    uint8_t trigger_min[PAD_CAL_TRIGGERS];
+    uint8_t trigger_max[PAD_CAL_TRIGGERS];
+} pad_cal_data_t;
+
+typedef struct {
+    pad_cal_data_t data;
+    uint8_t default_range[PAD_CAL_STICK_AXES];
+    uint32_t center_q16[PAD_CAL_STICK_AXES];
+    uint8_t seen_min[PAD_CAL_STICK_AXES];
+    uint8_t seen_max[PAD_CAL_STICK_AXES];
+    uint8_t prev_axis[PAD_CAL_STICK_AXES];
+    uint8_t seen_trigger[PAD_CAL_TRIGGERS];
+    uint8_t prev_trigger[PAD_CAL_TRIGGERS];
+    bool seeded;
+    uint32_t seq;               // odd while data is being changed
+    uint32_t generation;        // bumped on every change of data
+} pad_cal_t;
+
+//default_range: raw travel from center to the gate for each stick axis
+void pad_cal_init(pad_cal_t *cal, const uint8_t default_range[PAD_CAL_STICK_AXES]);
+//Continues from stored data, false (and nothing changed) if it is unusable
+bool pad_cal_load(pad_cal_t *cal, const pad_cal_data_t *stored);
+
+//Neutral position reported by the controller itself (GameCube origin),
+//replaces the learned centers and trigger rest values
+void pad_cal_set_origin(pad_cal_t *cal, const uint8_t axis[PAD_CAL_STICK_AXES], const uint8_t trigger[PAD_CAL_TRIGGERS]);
+
+//Feeds one sample, true when the stick axis calibration changed and the
+//stick tables need rebuilding
+bool pad_cal_update(pad_cal_t *cal, const uint8_t axis[PAD_CAL_STICK_AXES], const uint8_t trigger[PAD_CAL_TRIGGERS]);
+
+//Trigger value scaled to 0..255 between the learned rest and full press
+uint8_t pad_cal_trigger(const pad_cal_t *cal, int trigger, uint8_t raw);
+
+//Consistent copy of the data from any task, returns its generation
+uint32_t pad_cal_snapshot(const pad_cal_t *cal, pad_cal_data_t *out);
+
+#endif
@@ -0,0 +1,26 @@
+//
+//  Learned controller calibration in NVS
+//
+//  The calibration is loaded once at boot and written back from a low
+//  priority task at most every interval_ms, and only when it changed, so
+//  the flash sees a handful of writes per play session.
+//
+
+#ifndef PAD_CAL_NVS_H
+#define PAD_CAL_NVS_H
+
+#include <stdbool.h>
+
+#include "pad_cal.h"
+
+#define PAD_CAL_NVS_NAMESPACE   "calib"
+#define PAD_CAL_NVS_KEY         "gc_cal"
+
+//Initialises NVS if nobody did yet, false when nothing usable is stored
+bool pad_cal_nvs_load(pad_cal_data_t *data);
+bool pad_cal_nvs_save(const pad_cal_data_t *data);
+
+//Starts the task that keeps NVS up to date with cal
+void pad_cal_nvs_start(const pad_cal_t *cal, uint32_t interval_ms);
+
+#endif
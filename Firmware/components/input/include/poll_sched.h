@@ -0,0 +1,55 @@
+//
+//  Poll-then-send scheduling
+//
+//  Without coordination the controller poller and the HID sender run on
+//  unrelated clocks and a report can carry a sample that is almost a whole
+//  poll period old. Here the sender asks for a fresh sample right before it
+//  transmits and waits for it for at most the guard band, so the poll
+//  finishes just before the report goes on air.
+//
+//  Sender:  poll_sched_request() ... copy input, send ... poll_sched_sent()
+//  Poller:  poll_sched_wait() ... read controller, publish ... poll_sched_published()
+//
+//  The age of the sample at transmit time is measured in both modes, so
+//  POLL_SCHED_ALIGN can be turned off to compare against free running polls.
+//
+
+#ifndef POLL_SCHED_H
+#define POLL_SCHED_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef POLL_SCHED_ALIGN
+#define POLL_SCHED_ALIGN        1
+#endif
+//Longest the sender waits for a requested sample (us)
+#ifndef POLL_SCHED_GUARD_US
+#define POLL_SCHED_GUARD_US     1500
+#endif
+
+typedef struct {
+    uint32_t reports;           // reports sent since the last reset
+    uint32_t late;              // requests that ran out of guard band
+    uint32_t last_age_us;
+    uint32_t max_age_us;
+    uint64_t total_age_us;      // average = total_age_us / reports
+} poll_sched_stats_t;
+
+void poll_sched_init(void);
+
+//Sender: wakes the poller and waits for its sample, false if it came late
+bool poll_sched_request(void);
+//Sender: the report holding the latest sample has been handed to the stack
+void poll_sched_sent(void);
+
+//Poller: blocks until a sample is requested or max_wait_ms expires
+//(keeps the poller running while nothing is being sent)
+void poll_sched_wait(uint32_t max_wait_ms);
+//Poller: the poll is done, fresh is false if the controller read failed
+//and the previously published sample is still current
+void poll_sched_published(bool fresh);
+
+void poll_sched_get_stats(poll_sched_stats_t *stats, bool reset);
+
+#endif
@@ -0,0 +1,55 @@
+//
+//  Send-on-change report gating
+//
+//  Decides for every send opportunity whether a report goes out. With
+//  on_change set, a report is only sent when its input bytes differ from
+//  the last one sent or when keepalive_us passed without a send; otherwise
+//  every opportunity is used. Counters are kept in both modes, so the
+//  report rate with and without gating can be compared: a report without
+//  new input is a keepalive with on_change set and unchanged without.
+//
+//  The gate only decides; when the opportunities come is up to the caller.
+//  The paced Switch firmwares would otherwise see a change only at the next
+//  deadline, so their poller wakes the sender as soon as the input changed
+//  (report_pace_kick() in report_pace.h).
+//
+//  Plain C, the caller passes the time.
+//
+
+#ifndef REPORT_GATE_H
+#define REPORT_GATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define REPORT_GATE_MAX_LEN     16
+
+typedef struct {
+    uint32_t sent;              // reports sent
+    uint32_t changed;           // sent reports that carried new input
+    uint32_t keepalive;         // sent reports that only kept the link alive
+    uint32_t unchanged;         // sent reports without new input, on_change off
+    uint32_t skipped;           // opportunities left unused
+} report_gate_stats_t;
+
+typedef struct {
+    bool on_change;
+    uint32_t keepalive_us;
+    uint8_t len;                // 0 until the first report
+    uint8_t last[REPORT_GATE_MAX_LEN];
+    int64_t last_sent_us;
+    int64_t window_start_us;
+    report_gate_stats_t stats;
+} report_gate_t;
+
+void report_gate_init(report_gate_t *gate, bool on_change, uint32_t keepalive_us);
+
+//True if the report (its input bytes, at most REPORT_GATE_MAX_LEN) should
+//be sent now; it is then remembered as the last one sent
+bool report_gate_check(report_gate_t *gate, const uint8_t *input, uint8_t len, int64_t now_us);
+
+//Once window_us has passed since the previous call, stores the counters
+//scaled to one second in per_sec, restarts the window and returns true
+bool report_gate_rates(report_gate_t *gate, int64_t now_us, uint32_t window_us, report_gate_stats_t *per_sec);
+
+#endif
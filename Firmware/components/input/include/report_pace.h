@@ -0,0 +1,59 @@
+//
+//  Report pacing
+//
+//  A periodic esp_timer sets the report deadlines. Its alarms are computed
+//  from the previous alarm rather than from when the callback ran, so the
+//  cadence does not drift with send time or scheduling delays. The sender
+//  blocks in report_pace_wait() until the next deadline and calls
+//  report_pace_sent() once the report is handed to the stack; the distance
+//  between the ideal deadline and that call is recorded as jitter.
+//
+//  Sender:  report_pace_wait() ... build and send report ... report_pace_sent()
+//
+//  In send-on-change mode the poller calls report_pace_kick() when the input
+//  changed, which ends the wait right away. A report sent before the next
+//  deadline is counted as early and left out of the jitter.
+//
+
+#ifndef REPORT_PACE_H
+#define REPORT_PACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+
+#ifndef REPORT_PACE_PERIOD_US
+#define REPORT_PACE_PERIOD_US   15000
+#endif
+
+typedef struct {
+    uint32_t reports;           // reports sent since the last reset
+    uint32_t missed;            // deadlines that passed without a report
+    int32_t min_jitter_us;      // send time minus ideal deadline
+    int32_t max_jitter_us;
+    uint64_t total_jitter_us;   // sum of |jitter|, mean = total_jitter_us / reports
+    uint32_t last_interval_us;  // time between the last two reports
+    uint32_t early;             // reports sent between deadlines after a kick
+} report_pace_stats_t;
+
+//Creates and starts the timer, period_us 0 selects REPORT_PACE_PERIOD_US
+void report_pace_init(uint32_t period_us);
+//Changes the period, deadlines restart from now
+void report_pace_set_period(uint32_t period_us);
+uint32_t report_pace_get_period(void);
+
+//Blocks until the next deadline or a kick, false on timeout
+bool report_pace_wait(TickType_t timeout);
+//Ends the sender's wait before the deadline, callable from any task
+void report_pace_kick(void);
+//True while a deadline is waiting to be served, false after a kick
+bool report_pace_due(void);
+//The report for the current deadline has been sent
+void report_pace_sent(void);
+//The current deadline was deliberately left without a report
+void report_pace_skip(void);
+
+void report_pace_get_stats(report_pace_stats_t *out, bool reset);
+
+#endif
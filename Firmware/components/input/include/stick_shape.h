@@ -0,0 +1,81 @@
+//
+//  Stick shaping
+//
+//  Turns raw 8 bit stick axes into 12 bit Switch stick values:
+//
+//    1. per axis LUT: raw value -> signed position, 0 at the calibrated
+//       center and +-STICK_NORM at the calibrated min/max (asymmetric
+//       ranges are fine)
+//    2. optional octagon to circle mapping: the GameCube gate is an
+//       octagon with its corners on the axes and diagonals, the edges in
+//       between are scaled out so every direction reaches the same radius
+//    3. radial LUTs indexed by r^2: radial deadzone, response curve and
+//       saturation at the outer radius folded into one gain per radius
+//
+//  All tables are built by stick_shape_init() (at calibration time, with
+//  integer math only). A sample then costs three table lookups, one
+//  division (octant slope) and a few multiplies; no floating point.
+//  Firmware/host/stick_check compares the result against a double
+//  precision model of the same steps.
+//
+
+#ifndef STICK_SHAPE_H
+#define STICK_SHAPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define STICK_NORM          4096    // full deflection after the axis LUT
+#define STICK_NORM_MAX      5120    // axis LUT clamp, allows gate overshoot
+#define STICK_OUT_RANGE     2032    // full deflection in Switch units (0x7F0)
+#define STICK_OUT_CENTER    0x800
+#define STICK_OUT_MAX       0xFFF
+
+//The gain changes fastest just outside the deadzone, so small radii get a
+//finer table: r^2 < STICK_RADIAL_FINE_LEN << STICK_RADIAL_FINE_SHIFT (r < STICK_NORM / 2)
+#define STICK_RADIAL_FINE_SHIFT 12
+#define STICK_RADIAL_FINE_LEN   1024
+#define STICK_RADIAL_SHIFT  16
+#define STICK_RADIAL_LEN    ((((uint32_t)STICK_NORM_MAX * STICK_NORM_MAX * 2) >> STICK_RADIAL_SHIFT) + 1)
+#define STICK_GAIN_SHIFT    15      // radial gains are Q15, so outer - deadzone >= ~STICK_NORM / 4
+
+#define STICK_OCT_STEPS     128     // octagon gain table resolution (slope 0..1)
+#define STICK_OCT_SHIFT     14      // octagon gains are Q14
+
+typedef struct {
+    uint8_t center;
+    uint8_t min;                    // raw value at full deflection, negative side
+    uint8_t max;                    // raw value at full deflection, positive side
+} stick_axis_cal_t;
+
+typedef struct {
+    stick_axis_cal_t x;
+    stick_axis_cal_t y;
+    uint16_t deadzone;              // radial deadzone, STICK_NORM units
+    uint16_t outer;                 // radius mapped to full deflection, STICK_NORM units
+    uint8_t curve;                  // response curve, 0 linear .. 255 nearly quadratic
+    bool octagon;                   // map an octagonal gate onto the circle
+} stick_shape_config_t;
+
+typedef struct {
+    int16_t x_lut[256];
+    int16_t y_lut[256];
+    uint16_t radial_fine[STICK_RADIAL_FINE_LEN];
+    uint16_t radial[STICK_RADIAL_LEN];
+    bool octagon;
+} stick_shape_t;
+
+//Octagon edge gains (Q14) for slopes minor/major = i / STICK_OCT_STEPS
+extern const uint16_t stick_octagon_gain[STICK_OCT_STEPS + 1];
+
+//Fills in min/max as center -+ range, clamped to 0..255
+void stick_axis_cal_default(stick_axis_cal_t *cal, uint8_t center, uint8_t range);
+
+void stick_shape_init(stick_shape_t *shape, const stick_shape_config_t *config);
+//Rebuilds only the axis tables, for a calibration change at run time
+void stick_shape_set_axes(stick_shape_t *shape, const stick_axis_cal_t *x, const stick_axis_cal_t *y);
+
+//Shapes one raw sample into 12 bit Switch values
+void stick_shape_apply(const stick_shape_t *shape, uint8_t raw_x, uint8_t raw_y, uint16_t *out_x, uint16_t *out_y);
+
+#endif
@@ -0,0 +1,173 @@
+//
+//  Per-stage latency histograms
+//
+
+#include "latency_hist.h"
+
+#ifdef LATENCY_TRACE
+
+#include <stdio.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#define POLLER_STAMPS   ((1 << LATENCY_POLL) | (1 << LATENCY_RX) | (1 << LATENCY_DECODE))
+
+static const char *span_name[LATENCY_SPANS] = {
+    "bus", "decode", "publish", "wait", "send", "total"
+};
+
+static latency_hist_t hist[LATENCY_SPANS];
+static portMUX_TYPE hist_mux = portMUX_INITIALIZER_UNLOCKED;
+
+//poller side, only touched by the poller task
+static int64_t poll_time[LATENCY_PUBLISH + 1];
+static uint8_t poll_seen;
+
+//last published sample, handed to the sender under hist_mux
+static int64_t published_poll;
+static int64_t published_time;
+
+//sender side
+static int64_t send_poll;
+static int64_t send_published;
+static int64_t send_time;
+
+static void hist_add(latency_hist_t *h, int64_t us)
+{
+    uint32_t v = us < 0 ? 0 : us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+
+    h->count++;
+    h->total_us += v;
+    if(v > h->max_us)
+        h->max_us = v;
+    h->bucket[latency_bucket(v)]++;
+}
+
+void latency_stamp(latency_stamp_t stamp)
+{
+    int64_t now = esp_timer_get_time();
+
+    switch(stamp)
+    {
+        case LATENCY_POLL:
+            poll_seen = 0;
+            //fall through
+        case LATENCY_RX:
+        case LATENCY_DECODE:
+            poll_time[stamp] = now;
+            poll_seen |= 1 << stamp;
+            break;
+        case LATENCY_PUBLISH:
+            //a publish without its own poll (e.g. the neutral input after
+            //the controller was lost) is not a sample
+            if(poll_seen != POLLER_STAMPS)
+                break;
+            poll_seen = 0;
+            portENTER_CRITICAL(&hist_mux);
+            hist_add(&hist[LATENCY_SPAN_BUS], poll_time[LATENCY_RX] - poll_time[LATENCY_POLL]);
+            hist_add(&hist[LATENCY_SPAN_DECODE], poll_time[LATENCY_DECODE] - poll_time[LATENCY_RX]);
+            hist_add(&hist[LATENCY_SPAN_PUBLISH], now - poll_time[LATENCY_DECODE]);
+            published_poll = poll_time[LATENCY_POLL];
+            published_time = now;
+            portEXIT_CRITICAL(&hist_mux);
+            break;
+        case LATENCY_SEND:
+            portENTER_CRITICAL(&hist_mux);
+            send_poll = published_poll;
+            send_published = published_time;
+            portEXIT_CRITICAL(&hist_mux);
+            send_time = now;
+            break;
+        case LATENCY_SENT:
+            if(send_time == 0)
+                break;
+            portENTER_CRITICAL(&hist_mux);
+            if(send_published != 0)
+            {
+                hist_add(&hist[LATENCY_SPAN_WAIT], send_time - send_published);
+                hist_add(&hist[LATENCY_SPAN_TOTAL], now - send_poll);
+            }
+            hist_add(&hist[LATENCY_SPAN_SEND], now - send_time);
+            portEXIT_CRITICAL(&hist_mux);
+            send_time = 0;
+            break;
+        default:
+            break;
+    }
+}
+
+void latency_get(latency_span_t span, latency_hist_t *out, bool reset)
+{
+    portENTER_CRITICAL(&hist_mux);
+    *out = hist[span];
+    if(reset)
+        memset(&hist[span], 0, sizeof(hist[span]));
+    portEXIT_CRITICAL(&hist_mux);
+}
+
+//Upper end of the bucket that holds the given fraction (per mille) of the samples
+static uint32_t hist_percentile(const latency_hist_t *h, uint32_t per_mille)
+{
+    uint64_t want = ((uint64_t)h->count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+
+    for(int i = 0; i < LATENCY_BUCKETS - 1; i++)
+    {
+        seen += h->bucket[i];
+        if(seen >= want)
+            return latency_bucket_floor(i + 1);
+    }
+    return h->max_us;
+}
+
+void latency_dump(bool reset)
+{
+    latency_hist_t h;
+
+    for(int span = 0; span < LATENCY_SPANS; span++)
+    {
+        latency_get(span, &h, reset);
+        if(h.count == 0)
+        {
+            printf("latency %s: no samples\n", span_name[span]);
+            continue;
+        }
+        printf("latency %s: n %u avg %uus max %uus p50 <%uus p90 <%uus p99 <%uus\n",
+            span_name[span], (unsigned)h.count, (unsigned)(h.total_us / h.count), (unsigned)h.max_us,
+            (unsigned)hist_percentile(&h, 500), (unsigned)hist_percentile(&h, 900),
+            (unsigned)hist_percentile(&h, 990));
+        for(int i = 0; i < LATENCY_BUCKETS; i++)
+        {
+            if(h.bucket[i] != 0)
+                printf("  %6uus %u\n", (unsigned)latency_bucket_floor(i), (unsigned)h.bucket[i]);
+        }
+    }
+}
+
+static void console_task(void *arg)
+{
+    while(1)
+    {
+        int c = getchar();
+        if(c == EOF)
+        {
+            //nothing typed, the UART console does not block
+            clearerr(stdin);
+            vTaskDelay(100 / portTICK_PERIOD_MS);
+        }
+        else if(c == 'l' || c == 'L')
+        {
+            latency_dump(c == 'L');
+        }
+    }
+}
+
+void latency_console_start(void)
+{
+    xTaskCreate(console_task, "latency_con", 3072, NULL, 0, NULL);
+}
+
+#endif
@@ -0,0 +1,262 @@
+//
+//  Learned controller calibration
+//
+
+#include <string.h>
+
+#include "pad_cal.h"
+
+#define TRIGGER_MIN_SPAN    128 // full press has to be this far above rest to be learned
+
+static void data_begin(pad_cal_t *cal)
+{
+    __atomic_store_n(&cal->seq, cal->seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void data_end(pad_cal_t *cal)
+{
+    cal->generation++;
+    __atomic_store_n(&cal->seq, cal->seq + 1, __ATOMIC_RELEASE);
+}
+
+//min/max from the extremes seen so far, the default range where a side
+//has not been pushed far enough yet
+static bool axis_limits(pad_cal_t *cal, int a)
+{
+    stick_axis_cal_t *axis = &cal->data.axis[a];
+    int range = cal->default_range[a];
+    int enough = range * 3 / 4;
+    int center = axis->center;
+    int min = center - cal->seen_min[a] >= enough ? cal->seen_min[a] : center - range;
+    int max = cal->seen_max[a] - center >= enough ? cal->seen_max[a] : center + range;
+
+    if(min < 0) min = 0;
+    if(max > 255) max = 255;
+    if(min == axis->min && max == axis->max)
+        return false;
+    axis->min = min;
+    axis->max = max;
+    return true;
+}
+
+void pad_cal_init(pad_cal_t *cal, const uint8_t default_range[PAD_CAL_STICK_AXES])
+{
+    memset(cal, 0, sizeof(*cal));
+    memcpy(cal->default_range, default_range, sizeof(cal->default_range));
+    cal->data.version = PAD_CAL_VERSION;
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        stick_axis_cal_default(&cal->data.axis[a], 128, default_range[a]);
+        cal->center_q16[a] = 128 << 16;
+        cal->seen_min[a] = 128;
+        cal->seen_max[a] = 128;
+    }
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+    {
+        cal->data.trigger_min[t] = 0;
+        cal->data.trigger_max[t] = 255;
+    }
+}
+
+bool pad_cal_load(pad_cal_t *cal, const pad_cal_data_t *stored)
+{
+    if(stored->version != PAD_CAL_VERSION)
+        return false;
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        const stick_axis_cal_t *axis = &stored->axis[a];
+        if(axis->min >= axis->center || axis->max <= axis->center)
+            return false;
+    }
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+    {
+        if(stored->trigger_min[t] >= stored->trigger_max[t])
+            return false;
+    }
+
+    data_begin(cal);
+    cal->data = *stored;
+    data_end(cal);
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        cal->center_q16[a] = stored->axis[a].center << 16;
+        cal->seen_min[a] = stored->axis[a].min;
+        cal->seen_max[a] = stored->axis[a].max;
+    }
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+        cal->seen_trigger[t] = stored->trigger_max[t];
+    cal->seeded = true;
+    return true;
+}
+
+//full press from the highest value seen, 255 until the trigger went far enough
+static bool trigger_limits(pad_cal_t *cal, int t)
+{
+    int min = cal->data.trigger_min[t];
+    int max = cal->seen_trigger[t] - min >= TRIGGER_MIN_SPAN ? cal->seen_trigger[t] : 255;
+
+    if(max == cal->data.trigger_max[t])
+        return false;
+    cal->data.trigger_max[t] = max;
+    return true;
+}
+
+static void seed(pad_cal_t *cal, const uint8_t axis[PAD_CAL_STICK_AXES], const uint8_t trigger[PAD_CAL_TRIGGERS])
+{
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        int center = axis[a];
+        if(center < 128 - PAD_CAL_SEED_WINDOW || center > 128 + PAD_CAL_SEED_WINDOW)
+            center = 128;
+        cal->data.axis[a].center = center;
+        cal->center_q16[a] = center << 16;
+        cal->seen_min[a] = center;
+        cal->seen_max[a] = center;
+        axis_limits(cal, a);
+    }
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+    {
+        cal->data.trigger_min[t] = trigger[t];
+        cal->seen_trigger[t] = trigger[t];
+        trigger_limits(cal, t);
+    }
+    memcpy(cal->prev_axis, axis, sizeof(cal->prev_axis));
+    memcpy(cal->prev_trigger, trigger, sizeof(cal->prev_trigger));
+    cal->seeded = true;
+}
+
+void pad_cal_set_origin(pad_cal_t *cal, const uint8_t axis[PAD_CAL_STICK_AXES], const uint8_t trigger[PAD_CAL_TRIGGERS])
+{
+    data_begin(cal);
+    if(!cal->seeded)
+    {
+        seed(cal, axis, trigger);
+        data_end(cal);
+        return;
+    }
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        int center = axis[a];
+        if(center < 128 - PAD_CAL_SEED_WINDOW || center > 128 + PAD_CAL_SEED_WINDOW)
+            continue;
+        cal->data.axis[a].center = center;
+        cal->center_q16[a] = center << 16;
+        if(cal->seen_min[a] > center)
+            cal->seen_min[a] = center;
+        if(cal->seen_max[a] < center)
+            cal->seen_max[a] = center;
+        axis_limits(cal, a);
+    }
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+    {
+        cal->data.trigger_min[t] = trigger[t];
+        if(cal->seen_trigger[t] < trigger[t])
+            cal->seen_trigger[t] = trigger[t];
+        trigger_limits(cal, t);
+    }
+    data_end(cal);
+}
+
+bool pad_cal_update(pad_cal_t *cal, const uint8_t axis[PAD_CAL_STICK_AXES], const uint8_t trigger[PAD_CAL_TRIGGERS])
+{
+    bool changed = false;
+    bool trigger_changed = false;
+
+    if(!cal->seeded)
+    {
+        data_begin(cal);
+        seed(cal, axis, trigger);
+        data_end(cal);
+        return true;
+    }
+
+    data_begin(cal);
+    for(int a = 0; a < PAD_CAL_STICK_AXES; a++)
+    {
+        stick_axis_cal_t *cur = &cal->data.axis[a];
+        //both axes of a stick have to rest
+        int other = a ^ 1;
+        int d = axis[a] - cur->center;
+        int d_other = axis[other] - cal->data.axis[other].center;
+        if(d >= -PAD_CAL_CENTER_WINDOW && d <= PAD_CAL_CENTER_WINDOW &&
+           d_other >= -PAD_CAL_CENTER_WINDOW && d_other <= PAD_CAL_CENTER_WINDOW)
+        {
+            int32_t q16 = cal->center_q16[a];
+            q16 += ((axis[a] << 16) - q16) >> PAD_CAL_CENTER_SHIFT;
+            cal->center_q16[a] = q16;
+            //move the stored center only once the average is 3/4 of a step away
+            int32_t diff = q16 - (cur->center << 16);
+            if(diff >= 3 << 14 || diff <= -(3 << 14))
+            {
+                cur->center = (q16 + (1 << 15)) >> 16;
+                axis_limits(cal, a);
+                changed = true;
+            }
+        }
+
+        //extremes count when two polls in a row agree
+        uint8_t lo = axis[a] > cal->prev_axis[a] ? axis[a] : cal->prev_axis[a];
+        uint8_t hi = axis[a] < cal->prev_axis[a] ? axis[a] : cal->prev_axis[a];
+        if(lo < cal->seen_min[a])
+            cal->seen_min[a] = lo;
+        if(hi > cal->seen_max[a])
+            cal->seen_max[a] = hi;
+        if(axis_limits(cal, a))
+            changed = true;
+        cal->prev_axis[a] = axis[a];
+    }
+
+    for(int t = 0; t < PAD_CAL_TRIGGERS; t++)
+    {
+        uint8_t lo = trigger[t] > cal->prev_trigger[t] ? trigger[t] : cal->prev_trigger[t];
+        uint8_t hi = trigger[t] < cal->prev_trigger[t] ? trigger[t] : cal->prev_trigger[t];
+        if(lo < cal->data.trigger_min[t])
+        {
+            cal->data.trigger_min[t] = lo;
+            trigger_changed = true;
+        }
+        if(hi > cal->seen_trigger[t])
+            cal->seen_trigger[t] = hi;
+        if(trigger_limits(cal, t))
+            trigger_changed = true;
+        cal->prev_trigger[t] = trigger[t];
+    }
+
+    if(changed || trigger_changed)
+    {
+        data_end(cal);
+    }
+    else
+    {
+        //nothing changed, leave the generation alone
+        __atomic_store_n(&cal->seq, cal->seq + 1, __ATOMIC_RELEASE);
+    }
+    return changed;
+}
+
+uint8_t pad_cal_trigger(const pad_cal_t *cal, int trigger, uint8_t raw)
+{
+    int min = cal->data.trigger_min[trigger];
+    int max = cal->data.trigger_max[trigger];
+
+    if(raw <= min)
+        return 0;
+    if(raw >= max)
+        return 255;
+    return (raw - min) * 255 / (max - min);
+}
+
+uint32_t pad_cal_snapshot(const pad_cal_t *cal, pad_cal_data_t *out)
+{
+    uint32_t before, after, generation;
+
+    do {
+        before = __atomic_load_n(&cal->seq, __ATOMIC_ACQUIRE);
+        memcpy(out, &cal->data, sizeof(*out));
+        generation = cal->generation;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&cal->seq, __ATOMIC_RELAXED);
+    } while(before != after || (before & 1));
+    return generation;
+}
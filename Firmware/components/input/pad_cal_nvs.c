@@ -0,0 +1,94 @@
+//
+//  Learned controller calibration in NVS
+//
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "pad_cal_nvs.h"
+
+static const char *TAG = "pad_cal";
+static const pad_cal_t *save_cal;
+static uint32_t save_interval_ms;
+
+static esp_err_t cal_open(nvs_open_mode mode, nvs_handle *handle)
+{
+    esp_err_t err = nvs_open(PAD_CAL_NVS_NAMESPACE, mode, handle);
+    if(err == ESP_ERR_NVS_NOT_INITIALIZED)
+    {
+        err = nvs_flash_init();
+        if(err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND)
+        {
+            nvs_flash_erase();
+            err = nvs_flash_init();
+        }
+        if(err == ESP_OK)
+            err = nvs_open(PAD_CAL_NVS_NAMESPACE, mode, handle);
+    }
+    return err;
+}
+
+bool pad_cal_nvs_load(pad_cal_data_t *data)
+{
+    nvs_handle handle;
+    size_t len = sizeof(*data);
+
+    if(cal_open(NVS_READONLY, &handle) != ESP_OK)
+        return false;
+    esp_err_t err = nvs_get_blob(handle, PAD_CAL_NVS_KEY, data, &len);
+    nvs_close(handle);
+    return err == ESP_OK && len == sizeof(*data) && data->version == PAD_CAL_VERSION;
+}
+
+bool pad_cal_nvs_save(const pad_cal_data_t *data)
+{
+    nvs_handle handle;
+    esp_err_t err = cal_open(NVS_READWRITE, &handle);
+
+    if(err != ESP_OK)
+        return false;
+    err = nvs_set_blob(handle, PAD_CAL_NVS_KEY, data, sizeof(*data));
+    if(err == ESP_OK)
+        err = nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+static void save_task(void *arg)
+{
+    pad_cal_data_t data;
+    uint32_t saved = pad_cal_snapshot(save_cal, &data);
+
+    while(1)
+    {
+        vTaskDelay(save_interval_ms / portTICK_PERIOD_MS);
+        uint32_t generation = pad_cal_snapshot(save_cal, &data);
+        if(generation == saved)
+            continue;
+        if(pad_cal_nvs_save(&data))
+        {
+            saved = generation;
+            ESP_LOGI(TAG, "saved, main %d/%d/%d %d/%d/%d c %d/%d/%d %d/%d/%d triggers %d-%d %d-%d",
+                     data.axis[PAD_CAL_LX].min, data.axis[PAD_CAL_LX].center, data.axis[PAD_CAL_LX].max,
+                     data.axis[PAD_CAL_LY].min, data.axis[PAD_CAL_LY].center, data.axis[PAD_CAL_LY].max,
+                     data.axis[PAD_CAL_CX].min, data.axis[PAD_CAL_CX].center, data.axis[PAD_CAL_CX].max,
+                     data.axis[PAD_CAL_CY].min, data.axis[PAD_CAL_CY].center, data.axis[PAD_CAL_CY].max,
+                     data.trigger_min[PAD_CAL_L], data.trigger_max[PAD_CAL_L],
+                     data.trigger_min[PAD_CAL_R], data.trigger_max[PAD_CAL_R]);
+        }
+        else
+        {
+            ESP_LOGW(TAG, "saving calibration failed");
+        }
+    }
+}
+
+void pad_cal_nvs_start(const pad_cal_t *cal, uint32_t interval_ms)
+{
+    save_cal = cal;
+    save_interval_ms = interval_ms;
+    xTaskCreate(save_task, "pad_cal", 3072, NULL, 0, NULL);
+}
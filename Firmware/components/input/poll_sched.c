@@ -0,0 +1,81 @@
+//
+//  Poll-then-send scheduling
+//
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "poll_sched.h"
+
+static SemaphoreHandle_t request_sem;
+static SemaphoreHandle_t ready_sem;
+static volatile int64_t sample_time = 0;
+static poll_sched_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+void poll_sched_init(void)
+{
+    request_sem = xSemaphoreCreateBinary();
+    ready_sem = xSemaphoreCreateBinary();
+}
+
+bool poll_sched_request(void)
+{
+#if POLL_SCHED_ALIGN
+    //a sample published before this request is stale
+    xSemaphoreTake(ready_sem, 0);
+    xSemaphoreGive(request_sem);
+    //round up, a one tick timeout can end at the very next tick interrupt
+    TickType_t guard = POLL_SCHED_GUARD_US / 1000 / portTICK_PERIOD_MS + 1;
+    if(xSemaphoreTake(ready_sem, guard) != pdTRUE)
+    {
+        portENTER_CRITICAL(&stats_mux);
+        stats.late++;
+        portEXIT_CRITICAL(&stats_mux);
+        return false;
+    }
+#endif
+    return true;
+}
+
+void poll_sched_sent(void)
+{
+    uint32_t age = esp_timer_get_time() - sample_time;
+
+    portENTER_CRITICAL(&stats_mux);
+    stats.reports++;
+    stats.last_age_us = age;
+    stats.total_age_us += age;
+    if(age > stats.max_age_us)
+        stats.max_age_us = age;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void poll_sched_wait(uint32_t max_wait_ms)
+{
+#if POLL_SCHED_ALIGN
+    xSemaphoreTake(request_sem, max_wait_ms / portTICK_PERIOD_MS);
+#else
+    vTaskDelay(max_wait_ms / portTICK_PERIOD_MS);
+#endif
+}
+
+void poll_sched_published(bool fresh)
+{
+    if(fresh)
+        sample_time = esp_timer_get_time();
+    xSemaphoreGive(ready_sem);
+}
+
+void poll_sched_get_stats(poll_sched_stats_t *out, bool reset)
+{
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    if(reset)
+        memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&stats_mux);
+}
@@ -0,0 +1,68 @@
+//
+//  Send-on-change report gating
+//
+
+#include <string.h>
+
+#include "report_gate.h"
+
+void report_gate_init(report_gate_t *gate, bool on_change, uint32_t keepalive_us)
+{
+    memset(gate, 0, sizeof(*gate));
+    gate->on_change = on_change;
+    gate->keepalive_us = keepalive_us;
+}
+
+bool report_gate_check(report_gate_t *gate, const uint8_t *input, uint8_t len, int64_t now_us)
+{
+    if(len > REPORT_GATE_MAX_LEN)
+        len = REPORT_GATE_MAX_LEN;
+
+    bool changed = len != gate->len || memcmp(input, gate->last, len) != 0;
+    bool due = now_us - gate->last_sent_us >= gate->keepalive_us;
+
+    if(gate->on_change && !changed && !due)
+    {
+        gate->stats.skipped++;
+        return false;
+    }
+    gate->stats.sent++;
+    if(changed)
+        gate->stats.changed++;
+    else if(gate->on_change)
+        gate->stats.keepalive++;
+    else
+        gate->stats.unchanged++;
+    memcpy(gate->last, input, len);
+    gate->len = len;
+    gate->last_sent_us = now_us;
+    return true;
+}
+
+static uint32_t per_second(uint32_t count, int64_t elapsed_us)
+{
+    return (uint32_t)(((uint64_t)count * 1000000 + elapsed_us / 2) / elapsed_us);
+}
+
+bool report_gate_rates(report_gate_t *gate, int64_t now_us, uint32_t window_us, report_gate_stats_t *per_sec)
+{
+    int64_t elapsed = now_us - gate->window_start_us;
+
+    if(gate->window_start_us == 0)
+    {
+        //first call only opens the window
+        gate->window_start_us = now_us;
+        memset(&gate->stats, 0, sizeof(gate->stats));
+        return false;
+    }
+    if(elapsed < window_us || elapsed <= 0)
+        return false;
+    per_sec->sent = per_second(gate->stats.sent, elapsed);
+    per_sec->changed = per_second(gate->stats.changed, elapsed);
+    per_sec->keepalive = per_second(gate->stats.keepalive, elapsed);
+    per_sec->unchanged = per_second(gate->stats.unchanged, elapsed);
+    per_sec->skipped = per_second(gate->stats.skipped, elapsed);
+    memset(&gate->stats, 0, sizeof(gate->stats));
+    gate->window_start_us = now_us;
+    return true;
+}
@@ -0,0 +1,127 @@
+//
+//  Report pacing
+//
+
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+
+#include "report_pace.h"
+
+static esp_timer_handle_t pace_timer;
+static SemaphoreHandle_t deadline_sem;
+static uint32_t period_us;
+//deadline k is at start_us + k * period_us
+static volatile int64_t start_us;
+static volatile uint32_t fired = 0;
+static uint32_t served = 0;
+static int64_t last_sent_us = 0;
+static report_pace_stats_t stats;
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static void pace_timer_cb(void *arg)
+{
+    fired++;
+    xSemaphoreGive(deadline_sem);
+}
+
+static void pace_start(uint32_t period)
+{
+    period_us = period ? period : REPORT_PACE_PERIOD_US;
+    fired = 0;
+    served = 0;
+    start_us = esp_timer_get_time() + period_us;
+    esp_timer_start_periodic(pace_timer, period_us);
+}
+
+void report_pace_init(uint32_t period)
+{
+    const esp_timer_create_args_t args = {
+        .callback = pace_timer_cb,
+        .name = "report_pace",
+    };
+
+    deadline_sem = xSemaphoreCreateBinary();
+    esp_timer_create(&args, &pace_timer);
+    pace_start(period);
+}
+
+void report_pace_set_period(uint32_t period)
+{
+    esp_timer_stop(pace_timer);
+    xSemaphoreTake(deadline_sem, 0);
+    pace_start(period);
+}
+
+uint32_t report_pace_get_period(void)
+{
+    return period_us;
+}
+
+bool report_pace_wait(TickType_t timeout)
+{
+    return xSemaphoreTake(deadline_sem, timeout) == pdTRUE;
+}
+
+void report_pace_kick(void)
+{
+    xSemaphoreGive(deadline_sem);
+}
+
+bool report_pace_due(void)
+{
+    return fired != served;
+}
+
+void report_pace_sent(void)
+{
+    int64_t now = esp_timer_get_time();
+    uint32_t deadline = fired;
+
+    if(deadline == 0)
+        return;
+    if(deadline == served)
+    {
+        //kicked between deadlines, there is no deadline to measure against
+        portENTER_CRITICAL(&stats_mux);
+        stats.early++;
+        if(last_sent_us != 0)
+            stats.last_interval_us = now - last_sent_us;
+        portEXIT_CRITICAL(&stats_mux);
+        last_sent_us = now;
+        return;
+    }
+    //the semaphore only holds one deadline, any others were skipped
+    uint32_t missed = deadline - served > 1 ? deadline - served - 1 : 0;
+    served = deadline;
+    int32_t jitter = now - (start_us + (int64_t)(deadline - 1) * period_us);
+
+    portENTER_CRITICAL(&stats_mux);
+    if(stats.reports == 0 || jitter < stats.min_jitter_us)
+        stats.min_jitter_us = jitter;
+    if(stats.reports == 0 || jitter > stats.max_jitter_us)
+        stats.max_jitter_us = jitter;
+    stats.reports++;
+    stats.missed += missed;
+    stats.total_jitter_us += jitter > 0 ? jitter : -jitter;
+    if(last_sent_us != 0)
+        stats.last_interval_us = now - last_sent_us;
+    portEXIT_CRITICAL(&stats_mux);
+    last_sent_us = now;
+}
+
+void report_pace_skip(void)
+{
+    served = fired;
+}
+
+void report_pace_get_stats(report_pace_stats_t *out, bool reset)
+{
+    portENTER_CRITICAL(&stats_mux);
+    *out = stats;
+    if(reset)
+        memset(&stats, 0, sizeof(stats));
+    portEXIT_CRITICAL(&stats_mux);
+}
@@ -0,0 +1,163 @@
+//
+//  Stick shaping
+//
+
+#include "stick_shape.h"
+
+//cos(atan(i / 128) - pi / 8) / cos(pi / 8), Q14: how far the circle lies
+//outside an octagon whose corners are on the axes and diagonals
+const uint16_t stick_octagon_gain[STICK_OCT_STEPS + 1] = {
+    16384, 16437, 16488, 16539, 16588, 16636, 16684, 16730, 16775, 16820, 16863,
+    16905, 16946, 16986, 17025, 17063, 17099, 17135, 17169, 17203, 17235, 17267,
+    17297, 17326, 17354, 17381, 17407, 17432, 17456, 17479, 17500, 17521, 17541,
+    17559, 17577, 17594, 17609, 17624, 17638, 17651, 17662, 17673, 17683, 17692,
+    17700, 17707, 17714, 17719, 17724, 17727, 17730, 17732, 17734, 17734, 17734,
+    17732, 17730, 17728, 17724, 17720, 17715, 17710, 17704, 17697, 17689, 17681,
+    17672, 17663, 17653, 17642, 17631, 17619, 17607, 17594, 17581, 17567, 17553,
+    17538, 17522, 17507, 17490, 17474, 17457, 17439, 17421, 17403, 17384, 17365,
+    17346, 17326, 17306, 17286, 17265, 17244, 17223, 17201, 17179, 17157, 17135,
+    17112, 17089, 17066, 17043, 17019, 16995, 16971, 16947, 16923, 16899, 16874,
+    16849, 16824, 16799, 16774, 16749, 16723, 16698, 16672, 16646, 16620, 16594,
+    16568, 16542, 16516, 16490, 16463, 16437, 16410, 16384,
+};
+
+void stick_axis_cal_default(stick_axis_cal_t *cal, uint8_t center, uint8_t range)
+{
+    cal->center = center;
+    cal->min = center > range ? center - range : 0;
+    cal->max = center + range < 255 ? center + range : 255;
+}
+
+static void axis_lut_init(int16_t lut[256], const stick_axis_cal_t *cal)
+{
+    int32_t neg = cal->center - cal->min;
+    int32_t pos = cal->max - cal->center;
+
+    for(int raw = 0; raw < 256; raw++)
+    {
+        int32_t d = raw - cal->center;
+        int32_t v = 0;
+        if(d > 0 && pos > 0)
+            v = (d * STICK_NORM + pos / 2) / pos;
+        else if(d < 0 && neg > 0)
+            v = -((-d * STICK_NORM + neg / 2) / neg);
+        if(v > STICK_NORM_MAX) v = STICK_NORM_MAX;
+        if(v < -STICK_NORM_MAX) v = -STICK_NORM_MAX;
+        lut[raw] = v;
+    }
+}
+
+static uint32_t isqrt(uint32_t v)
+{
+    uint32_t root = 0;
+    uint32_t bit = 1u << 30;
+
+    while(bit > v)
+        bit >>= 2;
+    while(bit != 0)
+    {
+        if(v >= root + bit)
+        {
+            v -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+static void radial_lut_init(uint16_t *lut, uint32_t len, int shift, const stick_shape_config_t *config)
+{
+    int32_t dz = config->deadzone;
+    int32_t span = config->outer > config->deadzone ? config->outer - config->deadzone : 1;
+    int32_t k = config->curve;
+
+    for(uint32_t i = 0; i < len; i++)
+    {
+        //middle of the r^2 bucket
+        uint32_t r = isqrt((i << shift) + (1u << (shift - 1)));
+        if((int32_t)r <= dz)
+        {
+            lut[i] = 0;
+            continue;
+        }
+        //u = (r - deadzone) / (outer - deadzone), Q15, saturates at 1
+        int64_t u = ((int64_t)(r - dz) << 15) / span;
+        if(u > 1 << 15)
+            u = 1 << 15;
+        //curve: u * ((1 - k) + k * u), k = curve / 256
+        int64_t c = (u * (((int64_t)(256 - k) << 15) + k * u)) >> (15 + 8);
+        //output radius in Switch units, gain = out / r
+        int64_t out = (c * STICK_OUT_RANGE + (1 << 14)) >> 15;
+        int64_t gain = ((out << STICK_GAIN_SHIFT) + r / 2) / r;
+        lut[i] = gain > 0xFFFF ? 0xFFFF : gain;
+    }
+}
+
+void stick_shape_init(stick_shape_t *shape, const stick_shape_config_t *config)
+{
+    axis_lut_init(shape->x_lut, &config->x);
+    axis_lut_init(shape->y_lut, &config->y);
+    radial_lut_init(shape->radial_fine, STICK_RADIAL_FINE_LEN, STICK_RADIAL_FINE_SHIFT, config);
+    radial_lut_init(shape->radial, STICK_RADIAL_LEN, STICK_RADIAL_SHIFT, config);
+    shape->octagon = config->octagon;
+}
+
+void stick_shape_set_axes(stick_shape_t *shape, const stick_axis_cal_t *x, const stick_axis_cal_t *y)
+{
+    axis_lut_init(shape->x_lut, x);
+    axis_lut_init(shape->y_lut, y);
+}
+
+//v * gain >> shift, rounded symmetrically around 0
+static inline int32_t scale(int32_t v, uint32_t gain, int shift)
+{
+    int32_t half = 1 << (shift - 1);
+    return v >= 0 ? (int32_t)((v * gain + half) >> shift) : -(int32_t)((-v * gain + half) >> shift);
+}
+
+static inline uint16_t out_value(int32_t v)
+{
+    v += STICK_OUT_CENTER;
+    if(v < 0) return 0;
+    if(v > STICK_OUT_MAX) return STICK_OUT_MAX;
+    return v;
+}
+
+void stick_shape_apply(const stick_shape_t *shape, uint8_t raw_x, uint8_t raw_y, uint16_t *out_x, uint16_t *out_y)
+{
+    int32_t x = shape->x_lut[raw_x];
+    int32_t y = shape->y_lut[raw_y];
+
+    if(shape->octagon)
+    {
+        int32_t ax = x < 0 ? -x : x;
+        int32_t ay = y < 0 ? -y : y;
+        int32_t major = ax > ay ? ax : ay;
+        int32_t minor = ax > ay ? ay : ax;
+        if(major > 0)
+        {
+            uint32_t g = stick_octagon_gain[(minor * STICK_OCT_STEPS + major / 2) / major];
+            x = scale(x, g, STICK_OCT_SHIFT);
+            y = scale(y, g, STICK_OCT_SHIFT);
+        }
+    }
+
+    uint32_t r2 = x * x + y * y;
+    uint32_t g;
+    if(r2 < (STICK_RADIAL_FINE_LEN << STICK_RADIAL_FINE_SHIFT))
+    {
+        g = shape->radial_fine[r2 >> STICK_RADIAL_FINE_SHIFT];
+    }
+    else
+    {
+        uint32_t idx = r2 >> STICK_RADIAL_SHIFT;
+        g = shape->radial[idx < STICK_RADIAL_LEN ? idx : STICK_RADIAL_LEN - 1];
+    }
+    *out_x = out_value(scale(x, g, STICK_GAIN_SHIFT));
+    *out_y = out_value(scale(y, g, STICK_GAIN_SHIFT));
+}
@@ -0,0 +1,8 @@
+#
+# "joybus" component makefile.
+#
+# Shared GameCube/N64 (Joybus) helpers used by the BlueCubeMod firmwares.
+# Everything in here except the RMT glue is plain C and is also built by
+# Firmware/host for the Linux tools.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,23 @@
+//
+//  GameCube controller response frame decoding
+//
+
+#include "gc_frame.h"
+
+bool gc_frame_decode(const uint32_t *items, uint8_t status[GC_STATUS_LEN])
+{
+    if(!gc_frame_header_ok(items))
+        return false;
+
+    //Single pass over the 64 response items, MSB first
+    const uint32_t *item = items + GC_RESPONSE_FIRST;
+    for(int i = 0; i < GC_STATUS_LEN; i++)
+    {
+        uint32_t byte = 0;
+        for(int bit = 0; bit < 8; bit++)
+            byte = (byte << 1) | (GC_ITEM_DURATION0(item[bit]) == 1);
+        status[i] = byte;
+        item += 8;
+    }
+    return true;
+}
@@ -0,0 +1,67 @@
+//
+//  GameCube controller response frame decoding
+//
+//  The RMT receiver sees the whole line: the 24 bit console command plus its
+//  stop bit (items 0..24) followed by the controller's 64 bit response
+//  starting at item 25. Each item is one bit cell, a '1' is 1us low / 3us
+//  high and a '0' is 3us low / 1us high (RMT tick = 1us).
+//
+//  GameCube Controller Protocol: http://www.int03.co.uk/crema/hardware/gamecube/gc-control.html
+//
+
+#ifndef GC_FRAME_H
+#define GC_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GC_CMD_ITEMS        25  // 0x40 0x03 0x02 + stop bit
+#define GC_RESPONSE_FIRST   GC_CMD_ITEMS
+#define GC_STATUS_LEN       8
+#define GC_FRAME_ITEMS      (GC_RESPONSE_FIRST + GC_STATUS_LEN * 8)
+
+//Status word layout, one byte each, MSB first on the wire
+enum {
+    GC_BYTE_BUTTONS0 = 0,   // 0 0 1 S Y X B A
+    GC_BYTE_BUTTONS1,       // 1 L R Z U D R L
+    GC_BYTE_LX,
+    GC_BYTE_LY,
+    GC_BYTE_CX,
+    GC_BYTE_CY,
+    GC_BYTE_L_ANALOG,
+    GC_BYTE_R_ANALOG,
+};
+
+//GC_BYTE_BUTTONS0
+#define GC_BTN_A        0x01
+#define GC_BTN_B        0x02
+#define GC_BTN_X        0x04
+#define GC_BTN_Y        0x08
+#define GC_BTN_START    0x10
+//GC_BYTE_BUTTONS1
+#define GC_BTN_DLEFT    0x01
+#define GC_BTN_DRIGHT   0x02
+#define GC_BTN_DDOWN    0x04
+#define GC_BTN_DUP      0x08
+#define GC_BTN_Z        0x10
+#define GC_BTN_R        0x20
+#define GC_BTN_L        0x40
+
+//Raw 32 bit RMT item words (rmt_item32_t.val): duration0 is the low time
+#define GC_ITEM_DURATION0(v)    ((v) & 0x7FFF)
+
+//Fast reject: first three bits 0 0 1 and the fixed 1 that opens the second byte
+static inline bool gc_frame_header_ok(const uint32_t *items)
+{
+    const uint32_t *rsp = items + GC_RESPONSE_FIRST;
+    return GC_ITEM_DURATION0(rsp[0]) == 3 && GC_ITEM_DURATION0(rsp[1]) == 3 &&
+           GC_ITEM_DURATION0(rsp[2]) == 1 && GC_ITEM_DURATION0(rsp[8]) == 1;
+}
+
+//Decodes the response in items[] (as read from RMT RX memory) into status[].
+//Returns false and leaves status[] untouched if the frame header is invalid.
+//The frame must be longer than GC_FRAME_ITEMS (joybus_frame_len()), the
+//items are not checked against the end marker.
+bool gc_frame_decode(const uint32_t *items, uint8_t status[GC_STATUS_LEN]);
+
+#endif
@@ -0,0 +1,70 @@
+//
+//  Joybus RX capture format
+//
+//  Raw RMT RX frames (rmt_item32_t words, as found in RMT_CHANNEL_MEM) can be
+//  recorded on the device and replayed later by Firmware/host/gc_replay.
+//
+//  File layout, all integers little endian:
+//
+//    header   'J' 'B' 'C' 'P'  u8 version  u8 reserved  u16 tick_ns
+//    record   u32 timestamp_us  u16 item_count  item...
+//
+//  Each item is stored in one byte when it looks like a normal bit cell
+//  (level0 = 0, level1 = 1, both durations 1..15 ticks): high nibble is
+//  duration0, low nibble is duration1. Anything else (stop bit followed by a
+//  long idle, end marker) is stored as 0x00 followed by the raw 32 bit word.
+//  A typical GameCube poll frame of ~90 items takes ~100 bytes.
+//
+//  On the device, captures are dumped to the console as text lines
+//  "JBCP:<hex>" which gc_replay -l turns back into records.
+//
+
+#ifndef JOYBUS_CAPTURE_H
+#define JOYBUS_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define JOYBUS_CAPTURE_MAGIC        "JBCP"
+#define JOYBUS_CAPTURE_VERSION      1
+#define JOYBUS_CAPTURE_HEADER_LEN   8
+#define JOYBUS_CAPTURE_RECORD_LEN   6
+#define JOYBUS_CAPTURE_ESCAPE       0x00
+#define JOYBUS_CAPTURE_LOG_PREFIX   "JBCP:"
+
+//RMT RX channel memory when using mem_block_num = 4
+#define JOYBUS_RX_MAX_ITEMS         256
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    uint32_t frames;
+} joybus_capture_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint16_t tick_ns;
+} joybus_capture_reader_t;
+
+//Number of valid items in an RX frame, including the end marker item
+//(first item with a zero duration).
+uint16_t joybus_frame_len(const uint32_t *items, uint16_t max_items);
+
+//Writer: buf receives the file header immediately.
+void joybus_capture_init(joybus_capture_t *cap, uint8_t *buf, size_t size);
+//Appends one frame. Returns false (and stores nothing) if it does not fit.
+bool joybus_capture_add(joybus_capture_t *cap, uint32_t timestamp_us, const uint32_t *items, uint16_t item_count);
+//Prints the capture as JOYBUS_CAPTURE_LOG_PREFIX hex lines and empties it.
+void joybus_capture_dump(joybus_capture_t *cap);
+
+//Reader: returns false if buf does not start with a valid header.
+bool joybus_capture_open(joybus_capture_reader_t *rd, const uint8_t *buf, size_t len);
+//Decodes the next record into items[] (at most max_items). Returns the item
+//count, 0 at end of capture or -1 on a malformed record.
+int joybus_capture_next(joybus_capture_reader_t *rd, uint32_t *timestamp_us, uint32_t *items, uint16_t max_items);
+
+#endif
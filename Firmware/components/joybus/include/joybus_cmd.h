@@ -0,0 +1,102 @@
+//
+//  Joybus commands
+//
+//  Encodes console->controller commands into RMT TX items and decodes the
+//  controller's answer from the RX frame. The RX frame starts with the echo
+//  of the command (8 items per byte plus the stop bit), the response follows
+//  directly:
+//
+//    command      bytes  response  bytes
+//    identify     0x00   1         device type (2) + status (1)
+//    reset        0xFF   1         like identify, an N64 pad also re-zeroes its stick
+//    poll         0x40   3         status word (8), layout set by the analog mode
+//    origin       0x41   1         status word with the neutral sticks/triggers (10)
+//    recalibrate  0x42   3         like origin, the controller takes the current
+//                                  position as the new neutral one first
+//    N64 poll     0x01   1         N64 status (4), see n64_frame.h
+//
+//  Everything in here is plain C, items are raw rmt_item32_t words.
+//
+
+#ifndef JOYBUS_CMD_H
+#define JOYBUS_CMD_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define JOYBUS_CMD_MAX_LEN      3
+#define JOYBUS_RESPONSE_MAX_LEN 10
+//command bits + stop bit + end marker
+#define JOYBUS_CMD_MAX_ITEMS    (JOYBUS_CMD_MAX_LEN * 8 + 2)
+
+//Raw 32 bit RMT items, 1us ticks: '0' is 3us low / 1us high, '1' the reverse
+#define JOYBUS_ITEM(d0, d1)     ((uint32_t)(d0) | ((uint32_t)(d1) << 16) | 0x80000000)
+#define JOYBUS_ITEM_ZERO        JOYBUS_ITEM(3, 1)
+#define JOYBUS_ITEM_ONE         JOYBUS_ITEM(1, 3)
+#define JOYBUS_ITEM_STOP        JOYBUS_ITEM_ONE
+
+//Identify response, device type and status byte
+#define JOYBUS_TYPE_N64         0x0500
+#define JOYBUS_TYPE_GC          0x0900
+#define JOYBUS_TYPE_GC_WAVEBIRD 0xA800
+#define JOYBUS_TYPE_MASK        0xFF00  // low byte holds feature bits
+#define JOYBUS_TYPE_GC_BIT      0x0800  // set for every GameCube device
+#define JOYBUS_N64_PAK_PRESENT  0x01    // N64 status byte: something in the accessory slot
+#define JOYBUS_N64_PAK_ABSENT   0x02
+
+//GameCube poll analog modes, see gc_status_normalize()
+#define GC_ANALOG_MODE_DEFAULT  3
+#define GC_ANALOG_MODES         5
+#define GC_RUMBLE_OFF           0x00
+#define GC_RUMBLE_ON            0x01
+#define GC_RUMBLE_BRAKE         0x02
+
+typedef enum {
+    JOYBUS_IDENTIFY,
+    JOYBUS_ORIGIN,
+    JOYBUS_RECALIBRATE,
+    JOYBUS_POLL,
+    JOYBUS_RESET,
+    JOYBUS_N64_POLL,
+    JOYBUS_COMMANDS,
+} joybus_cmd_id_t;
+
+typedef struct {
+    uint8_t len;
+    uint8_t bytes[JOYBUS_CMD_MAX_LEN];
+    uint8_t response_len;
+} joybus_cmd_t;
+
+//An encoded command, ready for joybus_rmt_transfer(items, count, ...)
+typedef struct {
+    uint32_t items[JOYBUS_CMD_MAX_ITEMS];
+    uint16_t count;             // including the end marker
+    uint16_t response_first;    // first response item in the RX frame
+    uint8_t response_len;
+} joybus_frame_t;
+
+extern const joybus_cmd_t joybus_cmds[JOYBUS_COMMANDS];
+
+//Encodes joybus_cmds[id], for JOYBUS_POLL with the default analog mode
+void joybus_cmd_encode(joybus_cmd_id_t id, joybus_frame_t *frame);
+//Poll with the given analog mode (0..4) and rumble byte
+void joybus_cmd_encode_poll(uint8_t mode, uint8_t rumble, joybus_frame_t *frame);
+void joybus_cmd_encode_raw(const joybus_cmd_t *cmd, joybus_frame_t *frame);
+
+//Decodes frame->response_len bytes from the RX items. False if the frame
+//ends before the response does or a bit cell is not a valid 0 or 1.
+bool joybus_response_decode(const joybus_frame_t *frame, const uint32_t *rx, uint16_t rx_items, uint8_t *response);
+
+//Device type from an identify response
+static inline uint16_t joybus_identify_type(const uint8_t *response)
+{
+    return (response[0] << 8 | response[1]) & JOYBUS_TYPE_MASK;
+}
+
+//Rewrites a status word polled in analog mode 0..4 into the mode 3 layout
+//(full resolution sticks and L/R). 4 bit values are shifted into the high
+//nibble, so the C stick centre 8 stays 0x80 and full scale is 0xF0. Values
+//a mode does not report are 0.
+void gc_status_normalize(uint8_t mode, uint8_t *status);
+
+#endif
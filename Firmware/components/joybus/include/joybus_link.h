@@ -0,0 +1,76 @@
+//
+//  Joybus controller link state machine
+//
+//    PROBE   identify every poll until a GameCube (or, with
+//            joybus_link_init_n64(), an N64) device answers
+//    ORIGIN  read the origin (neutral sticks/triggers), back to PROBE if it
+//            keeps failing. N64 pads have no origin and skip this.
+//    POLL    poll; JOYBUS_LINK_MISS_MAX failed polls in a row mean the pad
+//            was unplugged and the link goes back to PROBE
+//
+//  A pad plugged back in is running again after two transfers (identify +
+//  origin, just identify for N64). The state machine does no I/O: the caller sends
+//  joybus_link_next() and hands the RX frame (or NULL on timeout) to
+//  joybus_link_result(). Plain C, also built by Firmware/host.
+//
+
+#ifndef JOYBUS_LINK_H
+#define JOYBUS_LINK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "joybus_cmd.h"
+
+#ifndef JOYBUS_LINK_MISS_MAX
+#define JOYBUS_LINK_MISS_MAX    3   // failed polls in a row that count as unplugged
+#endif
+#define JOYBUS_LINK_ORIGIN_TRIES 3
+
+typedef enum {
+    JOYBUS_LINK_PROBE,
+    JOYBUS_LINK_ORIGIN,
+    JOYBUS_LINK_POLL,
+} joybus_link_state_t;
+
+typedef enum {
+    JOYBUS_LINK_IDLE,       // nothing new (probing, or identify answered)
+    JOYBUS_LINK_CONNECTED,  // response holds the origin status word (identify for N64)
+    JOYBUS_LINK_STATUS,     // response holds a status word (mode 3 layout or N64 status)
+    JOYBUS_LINK_MISSED,     // poll failed, the last status is still current
+    JOYBUS_LINK_LOST,       // pad gone, report neutral input
+} joybus_link_event_t;
+
+typedef struct {
+    joybus_link_state_t state;
+    bool n64;
+    uint8_t analog_mode;
+    uint8_t misses;
+    uint16_t type;          // from the last identify
+    uint32_t connects;
+    uint32_t losses;
+    joybus_frame_t identify;
+    joybus_frame_t origin;
+    joybus_frame_t poll;
+} joybus_link_t;
+
+void joybus_link_init(joybus_link_t *link, uint8_t analog_mode, uint8_t rumble);
+void joybus_link_init_n64(joybus_link_t *link);
+
+//Frame to send next
+static inline const joybus_frame_t *joybus_link_next(const joybus_link_t *link)
+{
+    switch(link->state)
+    {
+        case JOYBUS_LINK_POLL:   return &link->poll;
+        case JOYBUS_LINK_ORIGIN: return &link->origin;
+        default:                 return &link->identify;
+    }
+}
+
+//rx: RX frame of the transfer (up to JOYBUS_RX_MAX_ITEMS, ending with a
+//zero duration item) or NULL on timeout. response needs
+//JOYBUS_RESPONSE_MAX_LEN bytes.
+joybus_link_event_t joybus_link_result(joybus_link_t *link, const uint32_t *rx, uint8_t *response);
+
+#endif
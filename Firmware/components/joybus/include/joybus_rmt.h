@@ -0,0 +1,52 @@
+//
+//  Interrupt driven Joybus transfers on the ESP32 RMT peripheral
+//
+//  The TX channel sends a command, the RX channel (wired to the same data
+//  line) records the command echo plus the controller's answer. Instead of
+//  sleeping a fixed time and then reading RX memory, the polling task blocks
+//  on a task notification given by the RX end (idle threshold) interrupt, so
+//  the response can be decoded as soon as the line goes quiet.
+//
+//  Both channels must be configured with rmt_config() but without
+//  rmt_driver_install(): this module owns the shared RMT interrupt.
+//  joybus_rmt_setup() does both for the usual wiring.
+//
+
+#ifndef JOYBUS_RMT_H
+#define JOYBUS_RMT_H
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "driver/rmt.h"
+
+#include "joybus_cmd.h"
+
+//RX idle threshold: longest quiet time inside a frame is the ~4us gap
+//between command and response, anything longer ends the frame.
+#define JOYBUS_RX_IDLE_US   100
+#define JOYBUS_RMT_CLK_DIV  80      // 1us ticks from the APB clock, as the command items count
+
+esp_err_t joybus_rmt_init(rmt_channel_t tx_channel, rmt_channel_t rx_channel);
+
+//TX and RX channel on their own pins, both wired to the data line: TX
+//idles high, RX ends a frame after JOYBUS_RX_IDLE_US. Calls joybus_rmt_init().
+esp_err_t joybus_rmt_setup(gpio_num_t tx_gpio, gpio_num_t rx_gpio, rmt_channel_t tx_channel, rmt_channel_t rx_channel);
+
+//Sends cmd_items (which must end with a zero duration end marker) and waits
+//up to timeout ticks for the receiver to go idle. Returns the RX channel
+//memory holding the frame, or NULL on timeout. The memory stays valid until
+//the next transfer.
+const uint32_t *joybus_rmt_transfer(const rmt_item32_t *cmd, uint16_t cmd_items, TickType_t timeout);
+
+//Sends a command encoded by joybus_cmd_encode*()
+static inline const uint32_t *joybus_rmt_send(const joybus_frame_t *frame, TickType_t timeout)
+{
+    return joybus_rmt_transfer((const rmt_item32_t*) frame->items, frame->count, timeout);
+}
+
+//Sends frame and decodes the answer into response (frame->response_len
+//bytes). False on timeout or a damaged answer.
+bool joybus_rmt_command(const joybus_frame_t *frame, uint8_t *response, TickType_t timeout);
+
+#endif
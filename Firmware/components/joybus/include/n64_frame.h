@@ -0,0 +1,63 @@
+//
+//  N64 controller response frame decoding
+//
+//  Same line coding as the GameCube pad (see gc_frame.h). The poll command
+//  is the single byte 0x01, so the RMT receiver sees 8 command items plus
+//  the stop bit (items 0..8) and then the 32 bit status from item 9.
+//
+//  The stick is relative: the controller takes its position at power up
+//  (or on L+R+Start, which also sets N64_BTN_RESET) as zero. There is no
+//  origin to read.
+//
+//  N64 Controller Protocol: http://www.mixdown.ca/n64dev/
+//
+
+#ifndef N64_FRAME_H
+#define N64_FRAME_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define N64_CMD_ITEMS       9   // 0x01 + stop bit
+#define N64_RESPONSE_FIRST  N64_CMD_ITEMS
+#define N64_STATUS_LEN      4
+#define N64_FRAME_ITEMS     (N64_RESPONSE_FIRST + N64_STATUS_LEN * 8)
+
+enum {
+    N64_BYTE_BUTTONS0 = 0,  // A B Z S U D L R
+    N64_BYTE_BUTTONS1,      // Rst 0 L R CU CD CL CR
+    N64_BYTE_X,             // signed, right is positive
+    N64_BYTE_Y,             // signed, up is positive
+};
+
+//N64_BYTE_BUTTONS0
+#define N64_BTN_DRIGHT  0x01
+#define N64_BTN_DLEFT   0x02
+#define N64_BTN_DDOWN   0x04
+#define N64_BTN_DUP     0x08
+#define N64_BTN_START   0x10
+#define N64_BTN_Z       0x20
+#define N64_BTN_B       0x40
+#define N64_BTN_A       0x80
+//N64_BYTE_BUTTONS1
+#define N64_BTN_CRIGHT  0x01
+#define N64_BTN_CLEFT   0x02
+#define N64_BTN_CDOWN   0x04
+#define N64_BTN_CUP     0x08
+#define N64_BTN_R       0x10
+#define N64_BTN_L       0x20
+#define N64_BTN_ZERO    0x40    // always 0
+#define N64_BTN_RESET   0x80
+
+//Stick as an unsigned raw value centered on 128, like the GameCube sticks
+static inline uint8_t n64_stick_raw(uint8_t axis)
+{
+    return axis ^ 0x80;
+}
+
+//Decodes the status in items[] (as read from RMT RX memory) into status[].
+//Returns false and leaves status[] untouched if a bit cell is malformed.
+//The frame must be longer than N64_FRAME_ITEMS (joybus_frame_len()).
+bool n64_frame_decode(const uint32_t *items, uint8_t status[N64_STATUS_LEN]);
+
+#endif
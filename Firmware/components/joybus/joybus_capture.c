@@ -0,0 +1,167 @@
+//
+//  Joybus RX capture format
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "joybus_capture.h"
+
+#define ITEM_D0(v)      ((v) & 0x7FFF)
+#define ITEM_L0(v)      (((v) >> 15) & 1)
+#define ITEM_D1(v)      (((v) >> 16) & 0x7FFF)
+#define ITEM_L1(v)      (((v) >> 31) & 1)
+
+#define DUMP_LINE_BYTES 32
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+//One byte form for ordinary bit cells, 0 if the item needs the escape
+static uint8_t item_pack(uint32_t v)
+{
+    uint32_t d0 = ITEM_D0(v);
+    uint32_t d1 = ITEM_D1(v);
+    if(ITEM_L0(v) != 0 || ITEM_L1(v) != 1) return 0;
+    if(d0 < 1 || d0 > 15 || d1 < 1 || d1 > 15) return 0;
+    return (d0 << 4) | d1;
+}
+
+uint16_t joybus_frame_len(const uint32_t *items, uint16_t max_items)
+{
+    for(uint16_t i = 0; i < max_items; i++)
+    {
+        if(ITEM_D0(items[i]) == 0 || ITEM_D1(items[i]) == 0)
+            return i + 1;
+    }
+    return max_items;
+}
+
+void joybus_capture_init(joybus_capture_t *cap, uint8_t *buf, size_t size)
+{
+    cap->buf = buf;
+    cap->size = size;
+    cap->len = 0;
+    cap->frames = 0;
+    if(size < JOYBUS_CAPTURE_HEADER_LEN)
+        return;
+    memcpy(buf, JOYBUS_CAPTURE_MAGIC, 4);
+    buf[4] = JOYBUS_CAPTURE_VERSION;
+    buf[5] = 0;
+    put_u16(buf + 6, 1000);
+    cap->len = JOYBUS_CAPTURE_HEADER_LEN;
+}
+
+bool joybus_capture_add(joybus_capture_t *cap, uint32_t timestamp_us, const uint32_t *items, uint16_t item_count)
+{
+    size_t need = JOYBUS_CAPTURE_RECORD_LEN;
+    for(uint16_t i = 0; i < item_count; i++)
+        need += item_pack(items[i]) ? 1 : 5;
+    if(item_count == 0 || cap->len == 0 || cap->len + need > cap->size)
+        return false;
+
+    uint8_t *p = cap->buf + cap->len;
+    put_u32(p, timestamp_us);
+    put_u16(p + 4, item_count);
+    p += JOYBUS_CAPTURE_RECORD_LEN;
+    for(uint16_t i = 0; i < item_count; i++)
+    {
+        uint8_t packed = item_pack(items[i]);
+        if(packed)
+        {
+            *p++ = packed;
+        }
+        else
+        {
+            *p++ = JOYBUS_CAPTURE_ESCAPE;
+            put_u32(p, items[i]);
+            p += 4;
+        }
+    }
+    cap->len += need;
+    cap->frames++;
+    return true;
+}
+
+void joybus_capture_dump(joybus_capture_t *cap)
+{
+    for(size_t i = 0; i < cap->len; i += DUMP_LINE_BYTES)
+    {
+        printf(JOYBUS_CAPTURE_LOG_PREFIX);
+        for(size_t j = i; j < cap->len && j < i + DUMP_LINE_BYTES; j++)
+            printf("%02x", cap->buf[j]);
+        printf("\n");
+    }
+    //an empty line terminates the dump
+    printf(JOYBUS_CAPTURE_LOG_PREFIX "\n");
+    cap->len = JOYBUS_CAPTURE_HEADER_LEN;
+    cap->frames = 0;
+}
+
+bool joybus_capture_open(joybus_capture_reader_t *rd, const uint8_t *buf, size_t len)
+{
+    if(len < JOYBUS_CAPTURE_HEADER_LEN || memcmp(buf, JOYBUS_CAPTURE_MAGIC, 4) != 0)
+        return false;
+    if(buf[4] != JOYBUS_CAPTURE_VERSION)
+        return false;
+    rd->buf = buf;
+    rd->len = len;
+    rd->pos = JOYBUS_CAPTURE_HEADER_LEN;
+    rd->tick_ns = get_u16(buf + 6);
+    return true;
+}
+
+int joybus_capture_next(joybus_capture_reader_t *rd, uint32_t *timestamp_us, uint32_t *items, uint16_t max_items)
+{
+    if(rd->pos == rd->len)
+        return 0;
+    if(rd->len - rd->pos < JOYBUS_CAPTURE_RECORD_LEN)
+        return -1;
+
+    const uint8_t *p = rd->buf + rd->pos;
+    const uint8_t *end = rd->buf + rd->len;
+    uint16_t count = get_u16(p + 4);
+    if(count > max_items)
+        return -1;
+    *timestamp_us = get_u32(p);
+    p += JOYBUS_CAPTURE_RECORD_LEN;
+
+    for(uint16_t i = 0; i < count; i++)
+    {
+        if(p >= end)
+            return -1;
+        uint8_t b = *p++;
+        if(b != JOYBUS_CAPTURE_ESCAPE)
+        {
+            items[i] = (b >> 4) | ((uint32_t)(b & 0x0F) << 16) | 0x80000000;
+        }
+        else
+        {
+            if(end - p < 4)
+                return -1;
+            items[i] = get_u32(p);
+            p += 4;
+        }
+    }
+    rd->pos = p - rd->buf;
+    return count;
+}
@@ -0,0 +1,106 @@
+//
+//  Joybus commands
+//
+
+#include <string.h>
+
+#include "joybus_cmd.h"
+
+#define ITEM_D0(v)      ((v) & 0x7FFF)
+#define ITEM_D1(v)      (((v) >> 16) & 0x7FFF)
+
+const joybus_cmd_t joybus_cmds[JOYBUS_COMMANDS] = {
+    [JOYBUS_IDENTIFY]    = { 1, { 0x00 }, 3 },
+    [JOYBUS_ORIGIN]      = { 1, { 0x41 }, 10 },
+    [JOYBUS_RECALIBRATE] = { 3, { 0x42, 0x00, 0x00 }, 10 },
+    [JOYBUS_POLL]        = { 3, { 0x40, GC_ANALOG_MODE_DEFAULT, GC_RUMBLE_BRAKE }, 8 },
+    [JOYBUS_RESET]       = { 1, { 0xFF }, 3 },
+    [JOYBUS_N64_POLL]    = { 1, { 0x01 }, 4 },
+};
+
+void joybus_cmd_encode_raw(const joybus_cmd_t *cmd, joybus_frame_t *frame)
+{
+    uint32_t *p = frame->items;
+
+    for(int i = 0; i < cmd->len; i++)
+    {
+        for(int bit = 7; bit >= 0; bit--)
+            *p++ = (cmd->bytes[i] >> bit) & 1 ? JOYBUS_ITEM_ONE : JOYBUS_ITEM_ZERO;
+    }
+    *p++ = JOYBUS_ITEM_STOP;
+    *p++ = 0;   // end marker
+    frame->count = p - frame->items;
+    frame->response_first = cmd->len * 8 + 1;
+    frame->response_len = cmd->response_len;
+}
+
+void joybus_cmd_encode(joybus_cmd_id_t id, joybus_frame_t *frame)
+{
+    joybus_cmd_encode_raw(&joybus_cmds[id], frame);
+}
+
+void joybus_cmd_encode_poll(uint8_t mode, uint8_t rumble, joybus_frame_t *frame)
+{
+    joybus_cmd_t cmd = joybus_cmds[JOYBUS_POLL];
+
+    cmd.bytes[1] = mode < GC_ANALOG_MODES ? mode : GC_ANALOG_MODE_DEFAULT;
+    cmd.bytes[2] = rumble;
+    joybus_cmd_encode_raw(&cmd, frame);
+}
+
+bool joybus_response_decode(const joybus_frame_t *frame, const uint32_t *rx, uint16_t rx_items, uint8_t *response)
+{
+    //response bits plus the controller's stop bit
+    if(frame->response_first + frame->response_len * 8 + 1 > rx_items)
+        return false;
+
+    const uint32_t *item = rx + frame->response_first;
+    for(int i = 0; i < frame->response_len; i++)
+    {
+        uint32_t byte = 0;
+        for(int bit = 0; bit < 8; bit++)
+        {
+            uint32_t low = ITEM_D0(item[bit]);
+            uint32_t high = ITEM_D1(item[bit]);
+            //a cell is 4us, whichever half is longer wins
+            if(low == 0 || high == 0 || low + high < 3 || low + high > 6 || low == high)
+                return false;
+            byte = (byte << 1) | (low < high);
+        }
+        response[i] = byte;
+        item += 8;
+    }
+    return true;
+}
+
+void gc_status_normalize(uint8_t mode, uint8_t *status)
+{
+    uint8_t b4 = status[4], b5 = status[5], b6 = status[6];
+
+    //bytes 0..3 (buttons, main stick) are the same in every mode
+    switch(mode)
+    {
+        case 0:     // CX CY L/R(4+4) A/B(4+4)
+            status[6] = b6 & 0xF0;
+            status[7] = b6 << 4;
+            break;
+        case 1:     // CX/CY(4+4) L R A/B(4+4)
+            status[4] = b4 & 0xF0;
+            status[5] = b4 << 4;
+            status[6] = b5;
+            status[7] = b6;
+            break;
+        case 2:     // CX/CY(4+4) L/R(4+4) A B
+            status[4] = b4 & 0xF0;
+            status[5] = b4 << 4;
+            status[6] = b5 & 0xF0;
+            status[7] = b5 << 4;
+            break;
+        case 4:     // CX CY A B, no L/R
+            status[6] = 0;
+            status[7] = 0;
+            break;
+        default:    // 3: CX CY L R
+            break;
+    }
+}
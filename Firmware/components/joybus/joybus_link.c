@@ -0,0 +1,107 @@
+//
+//  Joybus controller link state machine
+//
+
+#include "gc_frame.h"
+#include "joybus_capture.h"
+#include "joybus_link.h"
+#include "n64_frame.h"
+
+static bool decode(const joybus_frame_t *frame, const uint32_t *rx, uint8_t *response)
+{
+    return rx != NULL && joybus_response_decode(frame, rx, joybus_frame_len(rx, JOYBUS_RX_MAX_ITEMS), response);
+}
+
+static void link_reset(joybus_link_t *link, bool n64)
+{
+    link->state = JOYBUS_LINK_PROBE;
+    link->n64 = n64;
+    link->misses = 0;
+    link->type = 0;
+    link->connects = 0;
+    link->losses = 0;
+    joybus_cmd_encode(JOYBUS_IDENTIFY, &link->identify);
+    joybus_cmd_encode(JOYBUS_ORIGIN, &link->origin);
+}
+
+void joybus_link_init(joybus_link_t *link, uint8_t analog_mode, uint8_t rumble)
+{
+    link_reset(link, false);
+    link->analog_mode = analog_mode;
+    joybus_cmd_encode_poll(analog_mode, rumble, &link->poll);
+}
+
+void joybus_link_init_n64(joybus_link_t *link)
+{
+    link_reset(link, true);
+    link->analog_mode = 0;
+    joybus_cmd_encode(JOYBUS_N64_POLL, &link->poll);
+}
+
+joybus_link_event_t joybus_link_result(joybus_link_t *link, const uint32_t *rx, uint8_t *response)
+{
+    switch(link->state)
+    {
+        case JOYBUS_LINK_PROBE:
+            if(decode(&link->identify, rx, response))
+            {
+                link->type = joybus_identify_type(response);
+                if(link->n64 && link->type == JOYBUS_TYPE_N64)
+                {
+                    //no origin, the stick zeroes itself at power up
+                    link->state = JOYBUS_LINK_POLL;
+                    link->misses = 0;
+                    link->connects++;
+                    return JOYBUS_LINK_CONNECTED;
+                }
+                if(!link->n64 && (link->type & JOYBUS_TYPE_GC_BIT))
+                {
+                    link->state = JOYBUS_LINK_ORIGIN;
+                    link->misses = 0;
+                }
+            }
+            return JOYBUS_LINK_IDLE;
+
+        case JOYBUS_LINK_ORIGIN:
+            if(decode(&link->origin, rx, response))
+            {
+                link->state = JOYBUS_LINK_POLL;
+                link->misses = 0;
+                link->connects++;
+                return JOYBUS_LINK_CONNECTED;
+            }
+            if(++link->misses >= JOYBUS_LINK_ORIGIN_TRIES)
+                link->state = JOYBUS_LINK_PROBE;
+            return JOYBUS_LINK_IDLE;
+
+        case JOYBUS_LINK_POLL:
+        {
+            //the decoders below read the status items blindly, so a frame
+            //cut short must not reach them: the rest of RX memory still
+            //holds the previous frame
+            uint16_t rx_items = rx != NULL ? joybus_frame_len(rx, JOYBUS_RX_MAX_ITEMS) : 0;
+            if(link->n64)
+            {
+                if(rx_items > N64_FRAME_ITEMS && n64_frame_decode(rx, response))
+                {
+                    link->misses = 0;
+                    return JOYBUS_LINK_STATUS;
+                }
+            }
+            //the hot path keeps the unrolled mode 3 decoder
+            else if(rx_items > GC_FRAME_ITEMS && gc_frame_decode(rx, response))
+            {
+                gc_status_normalize(link->analog_mode, response);
+                link->misses = 0;
+                return JOYBUS_LINK_STATUS;
+            }
+            if(++link->misses < JOYBUS_LINK_MISS_MAX)
+                return JOYBUS_LINK_MISSED;
+            link->state = JOYBUS_LINK_PROBE;
+            link->misses = 0;
+            link->losses++;
+            return JOYBUS_LINK_LOST;
+        }
+    }
+    return JOYBUS_LINK_IDLE;
+}
@@ -0,0 +1,104 @@
+//
+//  Interrupt driven Joybus transfers on the ESP32 RMT peripheral
+//
+
+#include "esp_intr_alloc.h"
+#include "freertos/task.h"
+#include "soc/rmt_reg.h"
+#include "soc/rmt_struct.h"
+
+#include "joybus_capture.h"
+#include "joybus_rmt.h"
+
+//RMT.int_st holds tx_end, rx_end, err for each channel in turn
+#define RMT_INT_RX_END(ch)  (1 << ((ch) * 3 + 1))
+
+static rmt_channel_t jb_tx_channel;
+static rmt_channel_t jb_rx_channel;
+static rmt_isr_handle_t jb_isr_handle;
+static volatile TaskHandle_t jb_waiting_task = NULL;
+
+static void IRAM_ATTR joybus_rmt_isr(void* arg)
+{
+    uint32_t status = RMT.int_st.val;
+    BaseType_t woken = pdFALSE;
+
+    if(status & RMT_INT_RX_END(jb_rx_channel))
+    {
+        //stop receiving so the frame in RX memory stays intact
+        RMT.conf_ch[jb_rx_channel].conf1.rx_en = 0;
+        if(jb_waiting_task != NULL)
+            vTaskNotifyGiveFromISR(jb_waiting_task, &woken);
+    }
+    RMT.int_clr.val = status;
+    if(woken == pdTRUE)
+        portYIELD_FROM_ISR();
+}
+
+esp_err_t joybus_rmt_init(rmt_channel_t tx_channel, rmt_channel_t rx_channel)
+{
+    jb_tx_channel = tx_channel;
+    jb_rx_channel = rx_channel;
+    rmt_set_rx_intr_en(rx_channel, true);
+    return rmt_isr_register(joybus_rmt_isr, NULL, 0, &jb_isr_handle);
+}
+
+esp_err_t joybus_rmt_setup(gpio_num_t tx_gpio, gpio_num_t rx_gpio, rmt_channel_t tx_channel, rmt_channel_t rx_channel)
+{
+    rmt_config_t tx = {
+        .rmt_mode = RMT_MODE_TX,
+        .channel = tx_channel,
+        .gpio_num = tx_gpio,
+        .clk_div = JOYBUS_RMT_CLK_DIV,
+        .mem_block_num = 1,
+        .tx_config = {
+            .carrier_freq_hz = 24000000,
+            .carrier_level = RMT_CARRIER_LEVEL_HIGH,
+            .idle_level = RMT_IDLE_LEVEL_HIGH,
+            .idle_output_en = true,
+        },
+    };
+    rmt_config_t rx = {
+        .rmt_mode = RMT_MODE_RX,
+        .channel = rx_channel,
+        .gpio_num = rx_gpio,
+        .clk_div = JOYBUS_RMT_CLK_DIV,
+        .mem_block_num = 4,
+        .rx_config = {
+            .idle_threshold = JOYBUS_RX_IDLE_US,
+        },
+    };
+    esp_err_t err;
+
+    if((err = rmt_config(&tx)) != ESP_OK || (err = rmt_config(&rx)) != ESP_OK)
+        return err;
+    return joybus_rmt_init(tx_channel, rx_channel);
+}
+
+const uint32_t *joybus_rmt_transfer(const rmt_item32_t *cmd, uint16_t cmd_items, TickType_t timeout)
+{
+    //drop a notification left over from a transfer that timed out
+    ulTaskNotifyTake(pdTRUE, 0);
+    jb_waiting_task = xTaskGetCurrentTaskHandle();
+
+    rmt_fill_tx_items(jb_tx_channel, cmd, cmd_items, 0);
+    rmt_tx_start(jb_tx_channel, true);
+    rmt_rx_start(jb_rx_channel, true);
+
+    uint32_t done = ulTaskNotifyTake(pdTRUE, timeout);
+    jb_waiting_task = NULL;
+    if(!done)
+    {
+        rmt_rx_stop(jb_rx_channel);
+        return NULL;
+    }
+    return (const uint32_t*) RMT_CHANNEL_MEM(jb_rx_channel);
+}
+
+bool joybus_rmt_command(const joybus_frame_t *frame, uint8_t *response, TickType_t timeout)
+{
+    const uint32_t *rx = joybus_rmt_send(frame, timeout);
+    if(rx == NULL)
+        return false;
+    return joybus_response_decode(frame, rx, joybus_frame_len(rx, JOYBUS_RX_MAX_ITEMS), response);
+}
@@ -0,0 +1,33 @@
+//
+//  N64 controller response frame decoding
+//
+
+#include "n64_frame.h"
+
+#define ITEM_D0(v)      ((v) & 0x7FFF)
+#define ITEM_D1(v)      (((v) >> 16) & 0x7FFF)
+
+bool n64_frame_decode(const uint32_t *items, uint8_t status[N64_STATUS_LEN])
+{
+    //no fixed header bits to look at first, so every cell is checked: a
+    //valid one is 4us long with unequal halves
+    const uint32_t *item = items + N64_RESPONSE_FIRST;
+    uint32_t word = 0;
+    for(int bit = 0; bit < N64_STATUS_LEN * 8; bit++)
+    {
+        uint32_t low = ITEM_D0(item[bit]);
+        uint32_t high = ITEM_D1(item[bit]);
+        if(low == 0 || high == 0 || low + high < 3 || low + high > 6 || low == high)
+            return false;
+        word = (word << 1) | (low < high);
+    }
+    //stop bit must follow
+    if(ITEM_D0(item[N64_STATUS_LEN * 8]) == 0 || (word >> 16) & N64_BTN_ZERO)
+        return false;
+
+    status[0] = word >> 24;
+    status[1] = word >> 16;
+    status[2] = word >> 8;
+    status[3] = word;
+    return true;
+}
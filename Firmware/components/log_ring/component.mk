@@ -0,0 +1,8 @@
+#
+# "log_ring" component makefile.
+#
+# Deferred logging for the Bluetooth callbacks and the poll/send tasks.
+# The ring itself is plain C and is also built by Firmware/host, the drain
+# task is ESP32 only.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
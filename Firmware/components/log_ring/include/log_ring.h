@@ -0,0 +1,89 @@
+//
+//  Deferred logging
+//
+//  ESP_LOGx formats and prints in the caller, at 115200 baud a line holds
+//  up a Bluetooth callback or the poller for a millisecond or more. The
+//  LOG_RING_x macros only store the format string pointer (the string
+//  itself stays in flash), the tag, a timestamp and up to
+//  LOG_RING_MAX_ARGS 32 bit arguments in a slot of a lock free ring. A low
+//  priority task started by log_ring_start() formats and prints them later
+//  in the usual "I (ms) tag: text" form.
+//
+//  Arguments are stored as uint32_t: integers and chars only, no floats or
+//  64 bit values, and %s only for strings that stay valid (literals,
+//  esp_err_to_name()). Extra arguments are dropped. When the ring is full
+//  new lines are dropped and counted, the writer never waits.
+//
+//  The ring takes any number of writers (Vyukov style sequence per slot,
+//  one compare-and-swap to claim it) and one reader. A zeroed ring is
+//  ready to use, lines logged before log_ring_start() are kept.
+//
+//  Defining LOG_RING_DIRECT for the whole build (CFLAGS += -DLOG_RING_DIRECT)
+//  turns the macros back into ESP_LOGx, to compare the callback timing.
+//
+
+#ifndef LOG_RING_H
+#define LOG_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS      64      /*!< Lines the ring holds, a power of two */
+#endif
+#define LOG_RING_MAX_ARGS   6
+
+#define LOG_RING_ERROR      1       // same values as esp_log_level_t
+#define LOG_RING_WARN       2
+#define LOG_RING_INFO       3
+
+typedef struct {
+    uint32_t timestamp_ms;
+    const char *tag;
+    const char *fmt;
+    uint8_t level;
+    uint8_t nargs;
+    uint32_t args[LOG_RING_MAX_ARGS];
+} log_ring_entry_t;
+
+//Stores one line, false if the ring was full and the line was dropped
+bool log_ring_write(uint8_t level, uint32_t timestamp_ms, const char *tag, const char *fmt,
+                    const uint32_t *args, uint8_t nargs);
+//Takes the oldest line, false if the ring is empty. One reader only.
+bool log_ring_read(log_ring_entry_t *entry);
+//Lines dropped since boot
+uint32_t log_ring_dropped(void);
+
+#ifdef ESP_PLATFORM
+
+#include "esp_log.h"
+
+//Starts the task that prints the ring every drain_ms
+void log_ring_start(uint32_t drain_ms);
+
+#ifdef LOG_RING_DIRECT
+
+#define LOG_RING_E(tag, fmt, ...)   ESP_LOGE(tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_W(tag, fmt, ...)   ESP_LOGW(tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_I(tag, fmt, ...)   ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+
+#else
+
+#define LOG_RING_ARGS(...) \
+    ((const uint32_t[]){ 0, ##__VA_ARGS__ }) + 1, \
+    sizeof((const uint32_t[]){ 0, ##__VA_ARGS__ }) / sizeof(uint32_t) - 1
+
+#define LOG_RING_LEVEL(level, tag, fmt, ...) do { \
+        if(LOG_LOCAL_LEVEL >= (level)) \
+            log_ring_write(level, esp_log_timestamp(), tag, fmt, LOG_RING_ARGS(__VA_ARGS__)); \
+    } while(0)
+
+#define LOG_RING_E(tag, fmt, ...)   LOG_RING_LEVEL(LOG_RING_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_W(tag, fmt, ...)   LOG_RING_LEVEL(LOG_RING_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOG_RING_I(tag, fmt, ...)   LOG_RING_LEVEL(LOG_RING_INFO, tag, fmt, ##__VA_ARGS__)
+
+#endif
+
+#endif
+
+#endif
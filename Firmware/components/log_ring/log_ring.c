@@ -0,0 +1,84 @@
+//
+//  Deferred logging, lock free ring
+//
+
+#include <string.h>
+
+#include "log_ring.h"
+
+#if (LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) != 0
+#error "LOG_RING_SLOTS must be a power of two"
+#endif
+
+//turn counts how often the slot went round, relative to its index, so a
+//zeroed ring is empty: slot i is free for position p when turn == p - i
+//and holds the line of position p when turn == p + 1 - i
+typedef struct {
+    uint32_t turn;
+    log_ring_entry_t entry;
+} log_ring_slot_t;
+
+static log_ring_slot_t slots[LOG_RING_SLOTS];
+static uint32_t head;
+static uint32_t tail;
+static uint32_t dropped;
+
+bool log_ring_write(uint8_t level, uint32_t timestamp_ms, const char *tag, const char *fmt,
+                    const uint32_t *args, uint8_t nargs)
+{
+    uint32_t pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+    log_ring_slot_t *s;
+
+    while(1)
+    {
+        uint32_t index = pos & (LOG_RING_SLOTS - 1);
+        s = &slots[index];
+        int32_t diff = (int32_t)(__atomic_load_n(&s->turn, __ATOMIC_ACQUIRE) - (pos - index));
+        if(diff == 0)
+        {
+            //free, try to claim it (pos is reloaded on failure)
+            if(__atomic_compare_exchange_n(&head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if(diff < 0)
+        {
+            //the reader has not got to it yet, the ring is full
+            __atomic_fetch_add(&dropped, 1, __ATOMIC_RELAXED);
+            return false;
+        }
+        else
+        {
+            //another writer took it
+            pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        }
+    }
+
+    if(nargs > LOG_RING_MAX_ARGS)
+        nargs = LOG_RING_MAX_ARGS;
+    s->entry.timestamp_ms = timestamp_ms;
+    s->entry.tag = tag;
+    s->entry.fmt = fmt;
+    s->entry.level = level;
+    s->entry.nargs = nargs;
+    memcpy(s->entry.args, args, nargs * sizeof(uint32_t));
+    __atomic_store_n(&s->turn, pos + 1 - (pos & (LOG_RING_SLOTS - 1)), __ATOMIC_RELEASE);
+    return true;
+}
+
+bool log_ring_read(log_ring_entry_t *entry)
+{
+    uint32_t index = tail & (LOG_RING_SLOTS - 1);
+    log_ring_slot_t *s = &slots[index];
+
+    if(__atomic_load_n(&s->turn, __ATOMIC_ACQUIRE) != tail + 1 - index)
+        return false;
+    *entry = s->entry;
+    __atomic_store_n(&s->turn, tail + LOG_RING_SLOTS - index, __ATOMIC_RELEASE);
+    tail++;
+    return true;
+}
+
+uint32_t log_ring_dropped(void)
+{
+    return __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,64 @@
+//
+//  Deferred logging, drain task
+//
+
+#include <stdio.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+
+#include "log_ring.h"
+
+static uint32_t drain_interval_ms;
+
+static void print_entry(const log_ring_entry_t *e)
+{
+    const uint32_t *a = e->args;
+
+    switch(e->level)
+    {
+        case LOG_RING_ERROR:
+            printf(LOG_COLOR_E "E (%u) %s: ", (unsigned)e->timestamp_ms, e->tag);
+            break;
+        case LOG_RING_WARN:
+            printf(LOG_COLOR_W "W (%u) %s: ", (unsigned)e->timestamp_ms, e->tag);
+            break;
+        default:
+            printf(LOG_COLOR_I "I (%u) %s: ", (unsigned)e->timestamp_ms, e->tag);
+            break;
+    }
+    //the format only consumes the arguments it names, unused slots are zero
+    printf(e->fmt, a[0], a[1], a[2], a[3], a[4], a[5]);
+    printf(LOG_RESET_COLOR "\n");
+}
+
+static void drain_task(void *arg)
+{
+    log_ring_entry_t e;
+    uint32_t reported = 0;
+
+    while(1)
+    {
+        while(log_ring_read(&e))
+        {
+            for(int i = e.nargs; i < LOG_RING_MAX_ARGS; i++)
+                e.args[i] = 0;
+            print_entry(&e);
+        }
+        uint32_t dropped = log_ring_dropped();
+        if(dropped != reported)
+        {
+            printf(LOG_COLOR_W "W (%u) log_ring: %u lines dropped" LOG_RESET_COLOR "\n",
+                (unsigned)esp_log_timestamp(), (unsigned)(dropped - reported));
+            reported = dropped;
+        }
+        vTaskDelay(drain_interval_ms / portTICK_PERIOD_MS);
+    }
+}
+
+void log_ring_start(uint32_t drain_ms)
+{
+    drain_interval_ms = drain_ms > 0 ? drain_ms : 1;
+    xTaskCreate(drain_task, "log_ring", 3072, NULL, 0, NULL);
+}
@@ -0,0 +1,9 @@
+#
+# "pad" component makefile.
+#
+# Controller drivers behind one interface (include/pad.h): GameCube, N64
+# and NES/SNES, decoding to the state in include/pad_state.h. The driver
+# is picked with PAD_DRIVER for the whole build, only the one a firmware
+# calls gets linked.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
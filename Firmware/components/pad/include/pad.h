@@ -0,0 +1,132 @@
+//
+//  Controller driver interface
+//
+//  Every firmware talks to its controller through three calls:
+//
+//    pad_init(config)       pins, timing and calibration, once at startup
+//    pad_poll()             one transfer with the controller(s)
+//    pad_decode(slot, s)    the last sample as a pad_state_t (pad_state.h)
+//
+//  pad_slots() pads are read at once, slot 0 drives the reports.
+//
+//  The driver is picked when building, with PAD_DRIVER set for the whole
+//  build in the project Makefile (CFLAGS += -DPAD_DRIVER=PAD_DRIVER_GC).
+//  The calls below are inline wrappers around that driver's functions, so
+//  the poll loop calls it directly, without a function pointer, and the
+//  code shared by every firmware stays the same for each controller type.
+//
+//  pad_config_t is the selected driver's configuration. Only the poll task
+//  may call pad_poll() and pad_decode().
+//
+//  Adding a controller: a pad_<name>.c/.h pair in this component with its
+//  init, poll and decode, a PAD_DRIVER_ value and a branch below.
+//
+
+#ifndef PAD_H
+#define PAD_H
+
+#include <stdint.h>
+
+#include "pad_state.h"
+
+#define PAD_DRIVER_GC       1   // GameCube, pad_gc.h
+#define PAD_DRIVER_N64      2   // N64, pad_n64.h
+#define PAD_DRIVER_NES      3   // NES, pad_xnes.h
+#define PAD_DRIVER_SNES     4   // SNES, pad_xnes.h
+
+#ifndef PAD_DRIVER
+#error "PAD_DRIVER is not set, add CFLAGS += -DPAD_DRIVER=PAD_DRIVER_<type> to the project Makefile"
+#endif
+
+#if PAD_DRIVER == PAD_DRIVER_GC
+
+#include "pad_gc.h"
+
+#define PAD_NAME    "gc"
+typedef pad_gc_config_t pad_config_t;
+
+static inline void pad_init(const pad_config_t *config)
+{
+    pad_gc_init(config);
+}
+
+static inline uint8_t pad_slots(void)
+{
+    return 1;
+}
+
+static inline pad_event_t pad_poll(void)
+{
+    return pad_gc_poll();
+}
+
+static inline void pad_decode(uint8_t slot, pad_state_t *state)
+{
+    pad_gc_decode(state);
+}
+
+#elif PAD_DRIVER == PAD_DRIVER_N64
+
+#include "pad_n64.h"
+
+#define PAD_NAME    "n64"
+typedef pad_n64_config_t pad_config_t;
+
+static inline void pad_init(const pad_config_t *config)
+{
+    pad_n64_init(config);
+}
+
+static inline uint8_t pad_slots(void)
+{
+    return 1;
+}
+
+static inline pad_event_t pad_poll(void)
+{
+    return pad_n64_poll();
+}
+
+static inline void pad_decode(uint8_t slot, pad_state_t *state)
+{
+    pad_n64_decode(state);
+}
+
+#elif PAD_DRIVER == PAD_DRIVER_NES || PAD_DRIVER == PAD_DRIVER_SNES
+
+#include "pad_xnes.h"
+
+#if PAD_DRIVER == PAD_DRIVER_SNES
+#define PAD_NAME    "snes"
+#define PAD_XNES_LAYOUT SWITCH_XNES_SNES
+#else
+#define PAD_NAME    "nes"
+#define PAD_XNES_LAYOUT SWITCH_XNES_NES
+#endif
+typedef pad_xnes_config_t pad_config_t;
+
+static inline void pad_init(const pad_config_t *config)
+{
+    pad_xnes_init(config, PAD_XNES_LAYOUT);
+}
+
+static inline uint8_t pad_slots(void)
+{
+    return pad_xnes_pads();
+}
+
+static inline pad_event_t pad_poll(void)
+{
+    return pad_xnes_poll();
+}
+
+static inline void pad_decode(uint8_t slot, pad_state_t *state)
+{
+    pad_xnes_decode(slot, PAD_XNES_LAYOUT, state);
+}
+
+#else
+#error "unknown PAD_DRIVER"
+#endif
+
+#endif
@@ -0,0 +1,47 @@
+//
+//  GameCube controller driver
+//
+//  Identify, origin and poll over the RMT (components/joybus), the pad can
+//  come and go at any time. The stick tables start from the stored
+//  calibration and keep learning while playing (components/input,
+//  pad_cal.h), the mapping is switch_gc_map().
+//
+//  Defining GC_CAPTURE for the whole build records the raw RX frames and
+//  dumps them to the console (see Firmware/host/gc_replay). The dump stalls
+//  polling for a few seconds, so only use it for recording.
+//
+
+#ifndef PAD_GC_H
+#define PAD_GC_H
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "driver/rmt.h"
+
+#include "pad_state.h"
+
+#ifndef GC_CAPTURE_BUF_SIZE
+#define GC_CAPTURE_BUF_SIZE     16384
+#endif
+
+typedef struct {
+    gpio_num_t tx_gpio;         // both wired to the data line
+    gpio_num_t rx_gpio;
+    rmt_channel_t tx_channel;
+    rmt_channel_t rx_channel;   // takes 4 channels' memory
+    uint8_t analog_mode;        // 0..4, see components/joybus/include/joybus_cmd.h
+    uint8_t rx_timeout_ms;      // give up on a transfer after this long
+    uint8_t stick_range;        // raw main stick travel from center to the gate
+    uint8_t cstick_range;       // same for the C-stick
+    uint16_t deadzone;          // stick shaping, see stick_shape_config_t
+    uint16_t outer;
+    uint8_t curve;
+    uint32_t cal_save_ms;       // write a changed calibration to flash at most this often
+} pad_gc_config_t;
+
+void pad_gc_init(const pad_gc_config_t *config);
+pad_event_t pad_gc_poll(void);
+void pad_gc_decode(pad_state_t *state);
+
+#endif
@@ -0,0 +1,42 @@
+//
+//  N64 controller driver
+//
+//  Identify and poll over the RMT (components/joybus), the pad can come
+//  and go at any time. The Controller Pak is never touched, its status is
+//  only logged. The mapping is switch_n64_map().
+//
+//  Defining N64_CAPTURE for the whole build records the raw RX frames and
+//  dumps them to the console (see Firmware/host/n64_check). The dump stalls
+//  polling for a few seconds, so only use it for recording.
+//
+
+#ifndef PAD_N64_H
+#define PAD_N64_H
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+#include "driver/rmt.h"
+
+#include "pad_state.h"
+
+#ifndef N64_CAPTURE_BUF_SIZE
+#define N64_CAPTURE_BUF_SIZE    16384
+#endif
+
+typedef struct {
+    gpio_num_t tx_gpio;         // both wired to the data line
+    gpio_num_t rx_gpio;
+    rmt_channel_t tx_channel;
+    rmt_channel_t rx_channel;   // takes 4 channels' memory
+    uint8_t rx_timeout_ms;      // give up on a transfer after this long
+    uint16_t deadzone;          // stick shaping, see stick_shape_config_t and switch_n64.h
+    uint16_t outer;
+    uint8_t curve;
+} pad_n64_config_t;
+
+void pad_n64_init(const pad_n64_config_t *config);
+pad_event_t pad_n64_poll(void);
+void pad_n64_decode(pad_state_t *state);
+
+#endif
@@ -0,0 +1,63 @@
+//
+//  Controller state every pad driver decodes to, and what a poll found
+//
+//  Buttons follow the Switch Pro Controller: the three button bytes of its
+//  input report in one word (PAD_BTN_*), so the Switch firmwares store them
+//  as they are. Controllers without a button get a combination for it, see
+//  the mappings in components/switch_pro. Sticks are 12 bit centered on
+//  PAD_STICK_CENTER as the stick shaping puts them out, triggers run from
+//  0 (released) to 255. Pads without sticks or analog triggers report them
+//  centered and released.
+//
+//  Plain C, also built by Firmware/host.
+//
+
+#ifndef PAD_STATE_H
+#define PAD_STATE_H
+
+#include <stdint.h>
+
+#define PAD_STICK_CENTER    0x800
+
+#define PAD_BTN_Y           0x000001    // first report byte
+#define PAD_BTN_X           0x000002
+#define PAD_BTN_B           0x000004
+#define PAD_BTN_A           0x000008
+#define PAD_BTN_R           0x000040
+#define PAD_BTN_ZR          0x000080
+#define PAD_BTN_MINUS       0x000100    // second report byte
+#define PAD_BTN_PLUS        0x000200
+#define PAD_BTN_HOME        0x001000
+#define PAD_BTN_DOWN        0x010000    // third report byte
+#define PAD_BTN_UP          0x020000
+#define PAD_BTN_RIGHT       0x040000
+#define PAD_BTN_LEFT        0x080000
+#define PAD_BTN_L           0x400000
+#define PAD_BTN_ZL          0x800000
+#define PAD_BTN_BYTE(n)     (0xFFu << ((n) * 8))    // all buttons of one report byte
+
+typedef struct {
+    uint32_t buttons;           // PAD_BTN_*
+    uint16_t lx, ly;            // left stick, up is positive
+    uint16_t rx, ry;            // right stick (GameCube C-stick)
+    uint8_t lt, rt;             // analog triggers
+} pad_state_t;
+
+//Outcome of one pad_poll()
+typedef enum {
+    PAD_EVENT_NONE,             // nothing new: probing, or the poll failed
+    PAD_EVENT_CONNECTED,        // a pad answered, no sample yet
+    PAD_EVENT_SAMPLE,           // a new sample is ready for pad_decode()
+    PAD_EVENT_LOST,             // pad gone, report neutral input
+} pad_event_t;
+
+//Nothing pressed, sticks centered
+static inline void pad_state_neutral(pad_state_t *state)
+{
+    state->buttons = 0;
+    state->lx = state->ly = PAD_STICK_CENTER;
+    state->rx = state->ry = PAD_STICK_CENTER;
+    state->lt = state->rt = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+//
+//  NES/SNES controller driver
+//
+//  Up to XNES_MAX_PADS pads on a shared latch and clock (components/xnes),
+//  read all at once on every poll. The pads cannot be detected, every poll
+//  gives a sample. The mapping is switch_xnes_map().
+//
+//  Defining XNES_DEBUG for the whole build logs the raw bits of every read.
+//
+
+#ifndef PAD_XNES_H
+#define PAD_XNES_H
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+
+#include "pad_state.h"
+#include "switch_xnes.h"
+#include "xnes.h"
+
+typedef struct {
+    gpio_num_t latch;
+    gpio_num_t clock;
+    gpio_num_t data[XNES_MAX_PADS];
+    uint8_t pads;               // pads read in parallel, 1..XNES_MAX_PADS
+} pad_xnes_config_t;
+
+//layout also sets how many bits are shifted in
+void pad_xnes_init(const pad_xnes_config_t *config, switch_xnes_layout_t layout);
+uint8_t pad_xnes_pads(void);
+pad_event_t pad_xnes_poll(void);
+void pad_xnes_decode(uint8_t slot, switch_xnes_layout_t layout, pad_state_t *state);
+
+#endif
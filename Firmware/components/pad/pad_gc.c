@@ -0,0 +1,150 @@
+//
+//  GameCube controller driver
+//
+//  GameCube Controller Protocol: http://www.int03.co.uk/crema/hardware/gamecube/gc-control.html
+//
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "gc_frame.h"
+#include "joybus_capture.h"
+#include "joybus_link.h"
+#include "joybus_rmt.h"
+#include "latency_hist.h"
+#include "log_ring.h"
+#include "pad_cal.h"
+#include "pad_cal_nvs.h"
+#include "pad_gc.h"
+#include "stick_shape.h"
+#include "switch_gc.h"
+
+static joybus_link_t gc_link;    //probe/origin/poll state of the controller
+static uint8_t gc_rx_timeout_ms;
+static uint8_t status[JOYBUS_RESPONSE_MAX_LEN];
+
+//Calibration
+static stick_shape_t lstick;
+static stick_shape_t cstick;
+static pad_cal_t pad_cal;
+
+#ifdef GC_CAPTURE
+static uint8_t gc_capture_buf[GC_CAPTURE_BUF_SIZE];
+static joybus_capture_t gc_capture;
+
+//Appends the current RX frame, dumping the buffer over UART once it is full
+static void gc_capture_frame(const uint32_t* item)
+{
+    uint16_t len = joybus_frame_len(item, JOYBUS_RX_MAX_ITEMS);
+    if(gc_capture.buf == NULL)
+        joybus_capture_init(&gc_capture, gc_capture_buf, sizeof(gc_capture_buf));
+    if(!joybus_capture_add(&gc_capture, esp_timer_get_time(), item, len))
+    {
+        joybus_capture_dump(&gc_capture);
+        joybus_capture_add(&gc_capture, esp_timer_get_time(), item, len);
+    }
+}
+#endif
+
+//Builds the stick tables from the stored calibration, or the default
+//ranges until the first frame has been seen
+static void stick_calibrate(const pad_gc_config_t *config)
+{
+    const uint8_t range[PAD_CAL_STICK_AXES] = {
+        config->stick_range, config->stick_range, config->cstick_range, config->cstick_range
+    };
+    pad_cal_data_t stored;
+    stick_shape_config_t shape = {
+        .deadzone = config->deadzone,
+        .outer = config->outer,
+        .curve = config->curve,
+        .octagon = true,
+    };
+
+    pad_cal_init(&pad_cal, range);
+    if(pad_cal_nvs_load(&stored) && pad_cal_load(&pad_cal, &stored))
+        ESP_LOGI("calibration", "loaded stick calibration");
+    shape.x = pad_cal.data.axis[PAD_CAL_LX];
+    shape.y = pad_cal.data.axis[PAD_CAL_LY];
+    stick_shape_init(&lstick, &shape);
+    shape.x = pad_cal.data.axis[PAD_CAL_CX];
+    shape.y = pad_cal.data.axis[PAD_CAL_CY];
+    stick_shape_init(&cstick, &shape);
+    pad_cal_nvs_start(&pad_cal, config->cal_save_ms);
+}
+
+//Feeds a frame to the learned calibration, rebuilds the axis tables when it moved
+static void stick_learn(const uint8_t status[GC_STATUS_LEN])
+{
+    const uint8_t axis[PAD_CAL_STICK_AXES] = {
+        status[GC_BYTE_LX], status[GC_BYTE_LY], status[GC_BYTE_CX], status[GC_BYTE_CY]
+    };
+    const uint8_t trigger[PAD_CAL_TRIGGERS] = {
+        status[GC_BYTE_L_ANALOG], status[GC_BYTE_R_ANALOG]
+    };
+
+    if(pad_cal_update(&pad_cal, axis, trigger))
+    {
+        stick_shape_set_axes(&lstick, &pad_cal.data.axis[PAD_CAL_LX], &pad_cal.data.axis[PAD_CAL_LY]);
+        stick_shape_set_axes(&cstick, &pad_cal.data.axis[PAD_CAL_CX], &pad_cal.data.axis[PAD_CAL_CY]);
+    }
+}
+
+//Stick centers and trigger rest values from the controller's own origin
+static void gc_set_origin(const uint8_t origin[GC_STATUS_LEN])
+{
+    const uint8_t axis[PAD_CAL_STICK_AXES] = {
+        origin[GC_BYTE_LX], origin[GC_BYTE_LY], origin[GC_BYTE_CX], origin[GC_BYTE_CY]
+    };
+    const uint8_t trigger[PAD_CAL_TRIGGERS] = {
+        origin[GC_BYTE_L_ANALOG], origin[GC_BYTE_R_ANALOG]
+    };
+
+    pad_cal_set_origin(&pad_cal, axis, trigger);
+    stick_shape_set_axes(&lstick, &pad_cal.data.axis[PAD_CAL_LX], &pad_cal.data.axis[PAD_CAL_LY]);
+    stick_shape_set_axes(&cstick, &pad_cal.data.axis[PAD_CAL_CX], &pad_cal.data.axis[PAD_CAL_CY]);
+}
+
+void pad_gc_init(const pad_gc_config_t *config)
+{
+    gc_rx_timeout_ms = config->rx_timeout_ms;
+    joybus_rmt_setup(config->tx_gpio, config->rx_gpio, config->tx_channel, config->rx_channel);
+    stick_calibrate(config);
+    //identify and origin first
+    joybus_link_init(&gc_link, config->analog_mode, GC_RUMBLE_BRAKE);
+}
+
+pad_event_t pad_gc_poll(void)
+{
+    //Write the next command (identify, origin or poll) to the controller,
+    //wakes up on the RX idle interrupt
+    const uint32_t* item = joybus_rmt_send(joybus_link_next(&gc_link), gc_rx_timeout_ms / portTICK_PERIOD_MS);
+    LATENCY_STAMP(LATENCY_RX);
+
+#ifdef GC_CAPTURE
+    if(item != NULL && gc_link.state == JOYBUS_LINK_POLL)
+        gc_capture_frame(item);
+#endif
+
+    switch(joybus_link_result(&gc_link, item, status))
+    {
+        case JOYBUS_LINK_CONNECTED:
+            gc_set_origin(status);
+            LOG_RING_I("gc", "controller %04x connected", gc_link.type);
+            return PAD_EVENT_CONNECTED;
+        case JOYBUS_LINK_LOST:
+            LOG_RING_I("gc", "controller lost");
+            return PAD_EVENT_LOST;
+        case JOYBUS_LINK_STATUS:
+            stick_learn(status);
+            return PAD_EVENT_SAMPLE;
+        default:
+            return PAD_EVENT_NONE;
+    }
+}
+
+void pad_gc_decode(pad_state_t *state)
+{
+    switch_gc_map(status, &lstick, &cstick, &pad_cal, state);
+}
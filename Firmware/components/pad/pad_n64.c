@@ -0,0 +1,81 @@
+//
+//  N64 controller driver
+//
+//  N64 Controller Protocol: http://www.qwertymodo.com/hardware-projects/n64/n64-controller
+//
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include "joybus_capture.h"
+#include "joybus_link.h"
+#include "joybus_rmt.h"
+#include "latency_hist.h"
+#include "log_ring.h"
+#include "pad_n64.h"
+#include "stick_shape.h"
+#include "switch_n64.h"
+
+static joybus_link_t n64_link;   //probe/poll state of the controller
+static uint8_t n64_rx_timeout_ms;
+static uint8_t status[JOYBUS_RESPONSE_MAX_LEN];
+static stick_shape_t n64_stick;
+
+#ifdef N64_CAPTURE
+static uint8_t n64_capture_buf[N64_CAPTURE_BUF_SIZE];
+static joybus_capture_t n64_capture;
+
+//Appends the current RX frame, dumping the buffer over UART once it is full
+static void n64_capture_frame(const uint32_t* item)
+{
+    uint16_t len = joybus_frame_len(item, JOYBUS_RX_MAX_ITEMS);
+    if(n64_capture.buf == NULL)
+        joybus_capture_init(&n64_capture, n64_capture_buf, sizeof(n64_capture_buf));
+    if(!joybus_capture_add(&n64_capture, esp_timer_get_time(), item, len))
+    {
+        joybus_capture_dump(&n64_capture);
+        joybus_capture_add(&n64_capture, esp_timer_get_time(), item, len);
+    }
+}
+#endif
+
+void pad_n64_init(const pad_n64_config_t *config)
+{
+    n64_rx_timeout_ms = config->rx_timeout_ms;
+    joybus_rmt_setup(config->tx_gpio, config->rx_gpio, config->tx_channel, config->rx_channel);
+    switch_n64_stick_init(&n64_stick, config->deadzone, config->outer, config->curve);
+    //identify first
+    joybus_link_init_n64(&n64_link);
+}
+
+pad_event_t pad_n64_poll(void)
+{
+    //Write the next command (identify or poll) to the controller,
+    //wakes up on the RX idle interrupt
+    const uint32_t* item = joybus_rmt_send(joybus_link_next(&n64_link), n64_rx_timeout_ms / portTICK_PERIOD_MS);
+    LATENCY_STAMP(LATENCY_RX);
+
+#ifdef N64_CAPTURE
+    if(item != NULL && n64_link.state == JOYBUS_LINK_POLL)
+        n64_capture_frame(item);
+#endif
+
+    switch(joybus_link_result(&n64_link, item, status))
+    {
+        case JOYBUS_LINK_CONNECTED:
+            LOG_RING_I("n64", "controller %04x connected, pak status %02x", n64_link.type, status[2]);
+            return PAD_EVENT_CONNECTED;
+        case JOYBUS_LINK_LOST:
+            LOG_RING_I("n64", "controller lost");
+            return PAD_EVENT_LOST;
+        case JOYBUS_LINK_STATUS:
+            return PAD_EVENT_SAMPLE;
+        default:
+            return PAD_EVENT_NONE;
+    }
+}
+
+void pad_n64_decode(pad_state_t *state)
+{
+    switch_n64_map(status, &n64_stick, state);
+}
@@ -0,0 +1,50 @@
+//
+//  NES/SNES controller driver
+//
+
+#include <string.h>
+
+#include "latency_hist.h"
+#include "log_ring.h"
+#include "pad_xnes.h"
+
+static uint32_t pressed[XNES_MAX_PADS];
+static uint8_t xnes_pads;
+
+void pad_xnes_init(const pad_xnes_config_t *config, switch_xnes_layout_t layout)
+{
+    xnes_config_t xnes = {
+        .latch = config->latch,
+        .clock = config->clock,
+        .pads = config->pads,
+        .bits = layout == SWITCH_XNES_SNES ? XNES_BITS_SNES : XNES_BITS_NES,
+        .half_clock_us = XNES_HALF_CLOCK_US,
+    };
+
+    memcpy(xnes.data, config->data, sizeof(xnes.data));
+    xnes_pads = config->pads;
+    xnes_init(&xnes);
+}
+
+uint8_t pad_xnes_pads(void)
+{
+    return xnes_pads;
+}
+
+pad_event_t pad_xnes_poll(void)
+{
+    //latch and shift in the bits of every pad at once, takes ~0.2ms
+    xnes_read(pressed);
+    //the shift register hands over the bits as they are, nothing to decode
+    LATENCY_STAMP(LATENCY_RX);
+#ifdef XNES_DEBUG
+    for(int pad = 0; pad < xnes_pads; pad++)
+        LOG_RING_I("xnes", "pad %d: %x", pad, pressed[pad]);
+#endif
+    return PAD_EVENT_SAMPLE;
+}
+
+void pad_xnes_decode(uint8_t slot, switch_xnes_layout_t layout, pad_state_t *state)
+{
+    switch_xnes_map(pressed[slot], layout, state);
+}
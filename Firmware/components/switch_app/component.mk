@@ -0,0 +1,14 @@
+#
+# "switch_app" component makefile.
+#
+# The Switch Pro Controller firmware shared by BlueCubeModv2, BlueN64Mod and
+# BlueXNESMod, on top of the pad driver (components/pad). Needs Bluedroid,
+# so it builds to nothing for BlueCubeMod (btstack). Firmware/host/sim runs
+# it on the host.
+#
+ifdef CONFIG_BLUEDROID_ENABLED
+COMPONENT_ADD_INCLUDEDIRS := include
+else
+COMPONENT_ADD_INCLUDEDIRS :=
+COMPONENT_SRCDIRS :=
+endif
@@ -0,0 +1,52 @@
+//
+//  Switch Pro Controller firmware
+//
+//  Everything BlueCubeModv2, BlueN64Mod and BlueXNESMod have in common:
+//  NVS and Bluetooth bring-up, the HID callbacks, the subcommand replies of
+//  the pairing sequence, the paced report sender, the LED and the poll
+//  task. The poll task reads the controller through the driver picked with
+//  PAD_DRIVER (components/pad/include/pad.h), so a firmware's main.c is
+//  just its configuration and a call to switch_app_start().
+//
+//  Build options, defined for the whole build in the project Makefile:
+//
+//    HID_TRACE       record every HID report into a ring, dumped to the
+//                    console once pairing finished and on disconnect (see
+//                    components/switch_pro/include/hid_trace_task.h and
+//                    Firmware/host/hid_trace)
+//    LATENCY_TRACE   per-stage latency histograms, 'l' typed on the console
+//                    dumps them, see components/input/include/latency_hist.h
+//    BENCH           microbenchmarks printed at startup, see
+//                    components/bench/include/bench.h
+//
+
+#ifndef SWITCH_APP_H
+#define SWITCH_APP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "driver/gpio.h"
+
+#include "pad.h"
+
+typedef struct {
+    const char *name;               // HID application name and description
+    const char *description;
+    gpio_num_t led_gpio;            // blinks while discoverable, solid once connected
+    uint8_t poll_ms;                // time between controller polls when no report is due
+    uint32_t report_period_us;      // time between Switch input reports, e.g. 8000, 15000 or 16667
+    bool send_on_change;            // only send a report when the input changed, or every keepalive_ms
+    uint16_t keepalive_ms;
+    uint32_t min_gap_us;            // with send_on_change, a change goes out right away but
+                                    // no sooner than this after the previous report
+    uint32_t sched_stats_reports;   // log sample age and report jitter every this many reports
+    uint32_t rate_log_ms;           // log reports per second this often
+    uint32_t log_drain_ms;          // print deferred log lines this often, see components/log_ring
+    pad_config_t pad;               // the controller, see components/pad
+} switch_app_config_t;
+
+//Called from app_main(), returns once the device is discoverable
+void switch_app_start(const switch_app_config_t *config);
+
+#endif
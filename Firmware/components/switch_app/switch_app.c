@@ -0,0 +1,648 @@
+//
+//  Switch Pro Controller firmware
+//
+//  Created by Nathan Reeves 2019
+//
+
+#include "esp_log.h"
+#include "esp_hidd_api.h"
+#include "esp_bt_main.h"
+#include "esp_bt_device.h"
+#include "esp_bt.h"
+#include "esp_err.h"
+#include "esp_system.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "esp_gap_bt_api.h"
+#include <string.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "driver/gpio.h"
+
+#include "bench.h"
+#include "hid_trace_task.h"
+#include "latency_hist.h"
+#include "log_ring.h"
+#include "pad.h"
+#include "poll_sched.h"
+#include "report_gate.h"
+#include "report_pace.h"
+#include "switch_app.h"
+#include "switch_input.h"
+#include "switch_subcmd.h"
+#include "switch_spi.h"
+
+static switch_app_config_t app;
+
+SemaphoreHandle_t xSemaphore;
+bool connected = false;
+int paired = 0;
+TaskHandle_t SendingHandle = NULL;
+TaskHandle_t BlinkHandle = NULL;
+//In send-on-change mode, wakes the sender when pad 1 (the one in the
+//reports) changed instead of leaving the change to the next deadline
+static void input_changed(switch_input_t *last, const switch_input_t *input)
+{
+    if(!app.send_on_change || memcmp(last->data, input->data, SWITCH_INPUT_LEN) == 0)
+        return;
+    *last = *input;
+    report_pace_kick();
+}
+
+//Polls the controller and publishes what it decoded, as soon as the
+//sender asks for a sample
+static void poll_task(void *arg)
+{
+    LOG_RING_I("hi", "Hello world from core %d!\n", xPortGetCoreID() );
+    pad_state_t state;
+    switch_input_t input;
+    switch_input_t last = { 0 };    //pad 1 as last published
+    
+    while(1)
+    {
+        //sleeps until the sender wants a sample (or poll_ms passed)
+        poll_sched_wait(app.poll_ms);
+        
+        LATENCY_STAMP(LATENCY_POLL);
+        pad_event_t event = pad_poll();
+        LATENCY_STAMP(LATENCY_DECODE);
+        if(event == PAD_EVENT_SAMPLE)
+        {
+            //backwards, so input ends up holding pad 1
+            for(uint8_t slot = pad_slots(); slot-- > 0;)
+            {
+                pad_decode(slot, &state);
+                switch_input_encode_state(&input, &state);
+                switch_input_publish_slot(slot, &input);
+            }
+            LATENCY_STAMP(LATENCY_PUBLISH);
+            poll_sched_published(true);
+            input_changed(&last, &input);
+        }
+        else if(event == PAD_EVENT_LOST)
+        {
+            //unplugged, let go of everything until it is back
+            pad_state_neutral(&state);
+            switch_input_encode_state(&input, &state);
+            for(uint8_t slot = 0; slot < pad_slots(); slot++)
+                switch_input_publish_slot(slot, &input);
+            poll_sched_published(true);
+            input_changed(&last, &input);
+        }
+        else
+        {
+            poll_sched_published(false);
+        }
+    }
+}
+
+//Switch button report example //         batlvl       Buttons              Lstick           Rstick
+//static uint8_t report30[] = {0x30, 0x00, 0x90,   0x00, 0x00, 0x00,   0x00, 0x00, 0x00,   0x00, 0x00, 0x00};
+static uint8_t report30[] = {
+    0x30,
+    0x0,
+    0x80,
+    0,//but1
+    0,//but2
+    0,//but3
+    0,//Ls
+    0,//Ls
+    0,//Ls
+    0,//Rs
+    0,//Rs
+    0,//Rs
+    0x08
+};
+static uint8_t emptyReport[] = {
+    0x0,
+    0x0
+};
+
+
+static report_gate_t gate;
+static int64_t last_sent_us;
+
+void send_buttons()
+{
+    //wait for the next report deadline, then poll the controller so the
+    //sample is fresh when the report goes out. A kick from the poller
+    //(send-on-change) comes with a fresh sample already published.
+    if(paired)
+    {
+        report_pace_wait(portMAX_DELAY);
+        if(report_pace_due())
+        {
+            poll_sched_request();
+        }
+        else
+        {
+            int64_t gap_us = last_sent_us + app.min_gap_us - esp_timer_get_time();
+            if(gap_us > 0)
+                vTaskDelay((gap_us + 999) / 1000 / portTICK_PERIOD_MS);
+        }
+    }
+    
+    //buttons and sticks come pre-encoded from the poller
+    switch_input_t input;
+    switch_input_read(&input);
+    memcpy(&report30[SWITCH_INPUT_OFFSET], input.data, SWITCH_INPUT_LEN);
+    
+    if(!paired)
+    {
+        emptyReport[1] = switch_input_timer();
+#ifdef HID_TRACE
+        hid_trace_report(HID_TRACE_INPUT, emptyReport, sizeof(emptyReport));
+#endif
+        esp_hid_device_send_report(ESP_HIDD_REPORT_TYPE_INTRDATA, 0xa1, sizeof(emptyReport), emptyReport);
+        vTaskDelay(100);
+    }
+    else if(report_gate_check(&gate, input.data, SWITCH_INPUT_LEN, esp_timer_get_time()))
+    {
+        report30[1] = switch_input_timer();
+#ifdef HID_TRACE
+        hid_trace_report(HID_TRACE_INPUT, report30, sizeof(report30));
+#endif
+        LATENCY_STAMP(LATENCY_SEND);
+        esp_hid_device_send_report(ESP_HIDD_REPORT_TYPE_INTRDATA, 0xa1, sizeof(report30), report30);
+        LATENCY_STAMP(LATENCY_SENT);
+        last_sent_us = esp_timer_get_time();
+        report_pace_sent();
+        poll_sched_sent();
+    }
+    else
+    {
+        //nothing changed, leave the air to the next report
+        report_pace_skip();
+    }
+    
+    
+}
+const uint8_t hid_descriptor_gamecube[] = {
+    0x05, 0x01,        // Usage Page (Generic Desktop Ctrls)
+    0x09, 0x05,        // Usage (Game Pad)
+    0xA1, 0x01,        // Collection (Application)
+    //Padding
+    0x95, 0x03,          //     REPORT_COUNT = 3
+    0x75, 0x08,          //     REPORT_SIZE = 8
+    0x81, 0x03,          //     INPUT = Cnst,Var,Abs
+    //Sticks
+    0x09, 0x30,        //   Usage (X)
+    0x09, 0x31,        //   Usage (Y)
+    0x09, 0x32,        //   Usage (Z)
+    0x09, 0x35,        //   Usage (Rz)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x26, 0xFF, 0x00,  //   Logical Maximum (255)
+    0x75, 0x08,        //   Report Size (8)
+    0x95, 0x04,        //   Report Count (4)
+    0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    //DPAD
+    0x09, 0x39,        //   Usage (Hat switch)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x25, 0x07,        //   Logical Maximum (7)
+    0x35, 0x00,        //   Physical Minimum (0)
+    0x46, 0x3B, 0x01,  //   Physical Maximum (315)
+    0x65, 0x14,        //   Unit (System: English Rotation, Length: Centimeter)
+    0x75, 0x04,        //   Report Size (4)
+    0x95, 0x01,        //   Report Count (1)
+    0x81, 0x42,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,Null State)
+    //Buttons
+    0x65, 0x00,        //   Unit (None)
+    0x05, 0x09,        //   Usage Page (Button)
+    0x19, 0x01,        //   Usage Minimum (0x01)
+    0x29, 0x0E,        //   Usage Maximum (0x0E)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x25, 0x01,        //   Logical Maximum (1)
+    0x75, 0x01,        //   Report Size (1)
+    0x95, 0x0E,        //   Report Count (14)
+    0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    //Padding
+    0x06, 0x00, 0xFF,  //   Usage Page (Vendor Defined 0xFF00)
+    0x09, 0x20,        //   Usage (0x20)
+    0x75, 0x06,        //   Report Size (6)
+    0x95, 0x01,        //   Report Count (1)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x25, 0x7F,        //   Logical Maximum (127)
+    0x81, 0x02,        //   Input (Data,Var,Abs,No Wrap,Linear,Preferred State,No Null Position)
+    //Triggers
+    0x05, 0x01,        //   Usage Page (Generic Desktop Ctrls)
+    0x09, 0x33,        //   Usage (Rx)
+    0x09, 0x34,        //   Usage (Ry)
+    0x15, 0x00,        //   Logical Minimum (0)
+    0x26, 0xFF, 0x00,  //   Logical Maximum (255)
+    0x75, 0x08,        //   Report Size (8)
+    0x95, 0x02,        //   Report Count (2)
+    0x81, 0x02,
+    0xc0
+};
+int hid_descriptor_gc_len = sizeof(hid_descriptor_gamecube);
+///Switch Replies
+//Subcommand reply payloads, the report header and ack are added by switch_subcmd
+//Firmware 3.72, Pro Controller, MAC (filled in by set_bt_address), colors from SPI
+static uint8_t device_info[] = {0x03, 0x48, 0x03, 0x02, 0xD8, 0xA0, 0x1D, 0x40, 0x15, 0x66, 0x03, 0x00};
+//Trigger buttons elapsed time
+static const uint8_t trigger_time[] = {0x00, 0x6a, 0x01, 0xbb, 0x01, 0x93, 0x01, 0x95, 0x01};
+
+static void send_reply(const uint8_t *reply, uint16_t len)
+{
+#ifdef HID_TRACE
+    hid_trace_report(HID_TRACE_INPUT, reply, len);
+#endif
+    esp_hid_device_send_report(ESP_HIDD_REPORT_TYPE_INTRDATA, 0xa1, len, (uint8_t *)reply);
+}
+
+//MCU config is the last packet of the pairing sequence
+static void subcmd_paired(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len)
+{
+    switch_subcmd_reply(entry->ack, p_data, len, entry->data, entry->data_len);
+    paired = 1;
+#ifdef HID_TRACE
+    hid_trace_dump();
+#endif
+}
+
+#define DATA(d) d, sizeof(d)
+//Subcommands with a canned reply, anything else gets a generic ACK
+static const switch_subcmd_t subcmd_table[] = {
+    //subcmd key_len key    handler                  ack   payload
+    { 0x02, 0, 0,           NULL,                    0x82, DATA(device_info) },  // device info
+    { 0x03, 0, 0,           NULL,                    0x80, NULL, 0 },            // set input report mode
+    { 0x04, 0, 0,           NULL,                    0x83, DATA(trigger_time) }, // trigger buttons elapsed time
+    { 0x08, 0, 0,           NULL,                    0x80, NULL, 0 },            // shipment low power state
+    { 0x10, 0, 0,           switch_spi_read_subcmd,  0x90, NULL, 0 },            // SPI flash read
+    { 0x11, 0, 0,           switch_spi_write_subcmd, 0x80, NULL, 0 },            // SPI flash write
+    { 0x21, 1, 0x21,        subcmd_paired,           0x80, NULL, 0 },            // MCU config
+    { 0x30, 1, 0x01,        NULL,                    0x80, NULL, 0 },            // player lights
+    { 0x40, 1, 0x01,        NULL,                    0x80, NULL, 0 },            // enable IMU
+    { 0x40, 1, 0x02,        NULL,                    0x80, NULL, 0 },
+    { 0x48, 1, 0x01,        NULL,                    0x80, NULL, 0 },            // enable vibration
+};
+
+
+
+// sending bluetooth values every report_period_us
+void send_task(void* pvParameters) {
+    const char* TAG = "send_task";
+    LOG_RING_I(TAG, "Sending hid reports on core %d\n", xPortGetCoreID() );
+    poll_sched_stats_t stats;
+    report_pace_stats_t pace;
+    report_gate_stats_t rate;
+    while(1)
+    {
+        send_buttons();
+        if(report_gate_rates(&gate, esp_timer_get_time(), app.rate_log_ms * 1000, &rate))
+            LOG_RING_I(TAG, "%u reports/s (%u changed, %u keepalive, %u unchanged), %u/s skipped",
+                (unsigned)rate.sent, (unsigned)rate.changed, (unsigned)rate.keepalive,
+                (unsigned)rate.unchanged, (unsigned)rate.skipped);
+        //age of the input sample when its report was sent
+        poll_sched_get_stats(&stats, false);
+        if(stats.reports >= app.sched_stats_reports)
+        {
+            poll_sched_get_stats(&stats, true);
+            report_pace_get_stats(&pace, true);
+            LOG_RING_I(TAG, "sample age avg %uus max %uus, %u late",
+                (unsigned)(stats.total_age_us / stats.reports), (unsigned)stats.max_age_us, (unsigned)stats.late);
+            if(pace.reports > 0)
+                LOG_RING_I(TAG, "period %uus jitter avg %uus min %dus max %dus, %u missed, %u early",
+                    (unsigned)report_pace_get_period(), (unsigned)(pace.total_jitter_us / pace.reports),
+                    pace.min_jitter_us, pace.max_jitter_us, (unsigned)pace.missed, (unsigned)pace.early);
+        }
+    }
+}
+
+// callback for notifying when hidd application is registered or not registered
+void application_cb(esp_bd_addr_t bd_addr, esp_hidd_application_state_t state) {
+    const char* TAG = "application_cb";
+
+    switch(state) {
+        case ESP_HIDD_APP_STATE_NOT_REGISTERED:
+            LOG_RING_I(TAG, "app not registered");
+            break;
+        case ESP_HIDD_APP_STATE_REGISTERED:
+            LOG_RING_I(TAG, "app is now registered!");
+            if(bd_addr == NULL) {
+                LOG_RING_I(TAG, "bd_addr is null...");
+                break;
+            }
+            break;
+        default:
+            LOG_RING_W(TAG, "unknown app state %i", state);
+            break;
+    }
+}
+//LED blink
+void startBlink()
+{
+    while(1) {
+        gpio_set_level(app.led_gpio, 0);
+        vTaskDelay(150);
+        gpio_set_level(app.led_gpio, 1);
+        vTaskDelay(150);
+        gpio_set_level(app.led_gpio, 0);
+        vTaskDelay(150);
+        gpio_set_level(app.led_gpio, 1);
+        vTaskDelay(1000);
+    }
+    vTaskDelete(NULL);
+}
+// callback for hidd connection changes
+void connection_cb(esp_bd_addr_t bd_addr, esp_hidd_connection_state_t state) {
+    const char* TAG = "connection_cb";
+    
+    switch(state) {
+        case ESP_HIDD_CONN_STATE_CONNECTED:
+            LOG_RING_I(TAG, "connected to %02x:%02x:%02x:%02x:%02x:%02x",
+                bd_addr[0], bd_addr[1], bd_addr[2], bd_addr[3], bd_addr[4], bd_addr[5]);
+            LOG_RING_I(TAG, "setting bluetooth non connectable");
+            esp_bt_gap_set_scan_mode(ESP_BT_NON_CONNECTABLE, ESP_BT_NON_DISCOVERABLE);
+
+            //clear blinking LED - solid
+            vTaskDelete(BlinkHandle);
+            BlinkHandle = NULL;
+            gpio_set_level(app.led_gpio, 1);
+            //start solid
+            xSemaphoreTake(xSemaphore, portMAX_DELAY);
+            connected = true;
+            xSemaphoreGive(xSemaphore);
+            //restart send_task
+            if(SendingHandle != NULL)
+            {
+                vTaskDelete(SendingHandle);
+                SendingHandle = NULL;
+            }
+            xTaskCreatePinnedToCore(send_task, "send_task", 2048, NULL, 2, &SendingHandle, 0);
+            break;
+        case ESP_HIDD_CONN_STATE_CONNECTING:
+            LOG_RING_I(TAG, "connecting");
+            break;
+        case ESP_HIDD_CONN_STATE_DISCONNECTED:
+            xTaskCreate(startBlink, "blink_task", 1024, NULL, 1, &BlinkHandle);
+            //start blink
+            LOG_RING_I(TAG, "disconnected from %02x:%02x:%02x:%02x:%02x:%02x",
+                bd_addr[0], bd_addr[1], bd_addr[2], bd_addr[3], bd_addr[4], bd_addr[5]);
+            LOG_RING_I(TAG, "making self discoverable");
+            paired = 0;
+#ifdef HID_TRACE
+            hid_trace_dump();
+#endif
+            esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+            xSemaphoreTake(xSemaphore, portMAX_DELAY);
+            connected = false;
+            xSemaphoreGive(xSemaphore);
+            break;
+        case ESP_HIDD_CONN_STATE_DISCONNECTING:
+            LOG_RING_I(TAG, "disconnecting");
+            break;
+        default:
+            LOG_RING_I(TAG, "unknown connection status");
+            break;
+    }
+}
+
+//callback for discovering
+void get_device_cb()
+{
+    LOG_RING_I("hi", "found a device");
+}
+
+// callback for when hid host requests a report
+void get_report_cb(uint8_t type, uint8_t id, uint16_t buffer_size) {
+    const char* TAG = "get_report_cb";
+    LOG_RING_I(TAG, "got a get_report request from host");
+}
+
+// callback for when hid host sends a report
+void set_report_cb(uint8_t type, uint8_t id, uint16_t len, uint8_t* p_data) {
+    const char* TAG = "set_report_cb";
+    LOG_RING_I(TAG, "got a report from host");
+}
+
+// callback for when hid host requests a protocol change
+void set_protocol_cb(uint8_t protocol) {
+    const char* TAG = "set_protocol_cb";
+    LOG_RING_I(TAG, "got a set_protocol request from host");
+}
+
+// callback for when hid host sends interrupt data
+void intr_data_cb(uint8_t report_id, uint16_t len, uint8_t* p_data) {
+#ifdef HID_TRACE
+    hid_trace_report(HID_TRACE_OUTPUT, p_data, len);
+#endif
+    //switch pairing sequence
+    if(len == 49)
+    {
+        switch_subcmd_dispatch(p_data, len);
+    }
+}
+
+// callback for when hid host does a virtual cable unplug
+void vc_unplug_cb(void) {
+    const char* TAG = "vc_unplug_cb";
+    LOG_RING_I(TAG, "host did a virtual cable unplug");
+}
+
+void set_bt_address()
+{
+    //store a random mac address in flash
+    nvs_handle my_handle;
+    esp_err_t err;
+    uint8_t bt_addr[8];
+    
+    err = nvs_open("storage", NVS_READWRITE, &my_handle);
+    if (err != ESP_OK) return;
+    
+    size_t addr_size = 0;
+    err = nvs_get_blob(my_handle, "mac_addr", NULL, &addr_size);
+    if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+        nvs_close(my_handle);
+        return;
+    }
+    
+    if (addr_size > 0) {
+        err = nvs_get_blob(my_handle, "mac_addr", bt_addr, &addr_size);
+    }
+    else
+    {
+        for(int i=0; i<8; i++)
+            bt_addr[i] = esp_random()%255;
+        size_t addr_size = sizeof(bt_addr);
+        err = nvs_set_blob(my_handle, "mac_addr", bt_addr, addr_size);
+    }
+    
+    err = nvs_commit(my_handle);
+    nvs_close(my_handle);
+    esp_base_mac_addr_set(bt_addr);
+    
+    //put mac addr in switch pairing packet
+    for(int z=0; z<6; z++)
+        device_info[z+4] = bt_addr[z];
+}
+void print_bt_address() {
+    const char* TAG = "bt_address";
+    const uint8_t* bd_addr;
+
+    bd_addr = esp_bt_dev_get_address();
+    ESP_LOGI(TAG, "my bluetooth address is %02X:%02X:%02X:%02X:%02X:%02X",
+        bd_addr[0], bd_addr[1], bd_addr[2], bd_addr[3], bd_addr[4], bd_addr[5]);
+}
+
+#define SPP_TAG "tag"
+static void esp_bt_gap_cb(esp_bt_gap_cb_event_t event, esp_bt_gap_cb_param_t *param)
+{
+    switch(event){
+        case ESP_BT_GAP_DISC_RES_EVT:
+            LOG_RING_I(SPP_TAG, "ESP_BT_GAP_DISC_RES_EVT");
+            esp_log_buffer_hex(SPP_TAG, param->disc_res.bda, ESP_BD_ADDR_LEN);
+            break;
+        case ESP_BT_GAP_DISC_STATE_CHANGED_EVT:
+            LOG_RING_I(SPP_TAG, "ESP_BT_GAP_DISC_STATE_CHANGED_EVT");
+            break;
+        case ESP_BT_GAP_RMT_SRVCS_EVT:
+            LOG_RING_I(SPP_TAG, "ESP_BT_GAP_RMT_SRVCS_EVT");
+            LOG_RING_I(SPP_TAG, "%d", param->rmt_srvcs.num_uuids);
+            break;
+        case ESP_BT_GAP_RMT_SRVC_REC_EVT:
+            LOG_RING_I(SPP_TAG, "ESP_BT_GAP_RMT_SRVC_REC_EVT");
+            break;
+        case ESP_BT_GAP_AUTH_CMPL_EVT:{
+            if (param->auth_cmpl.stat == ESP_BT_STATUS_SUCCESS) {
+                //device_name only lives as long as param, print it right away
+                ESP_LOGI(SPP_TAG, "authentication success: %s", param->auth_cmpl.device_name);
+                esp_log_buffer_hex(SPP_TAG, param->auth_cmpl.bda, ESP_BD_ADDR_LEN);
+            } else {
+                LOG_RING_E(SPP_TAG, "authentication failed, status:%d", param->auth_cmpl.stat);
+            }
+            break;
+        }
+        
+        default:
+            break;
+    }
+}
+void switch_app_start(const switch_app_config_t *config) {
+    app = *config;
+#ifdef BENCH
+    //before the tasks start, and before switch_subcmd_init() replaces the
+    //table the subcommand cases install
+    bench_run_all();
+#endif
+    const char* TAG = "app_main";
+	esp_err_t ret;
+    
+    //callbacks and tasks log through the ring, see components/log_ring
+    log_ring_start(app.log_drain_ms);
+    
+    //NVS first, the stick calibration and the Bluetooth address are stored there
+	ret = nvs_flash_init();
+    if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        ESP_ERROR_CHECK(nvs_flash_erase());
+        ret = nvs_flash_init();
+    }
+    ESP_ERROR_CHECK( ret );
+    
+    //Controller reading init, see components/pad
+    pad_init(&app.pad);
+    poll_sched_init();
+#ifdef LATENCY_TRACE
+    latency_console_start();
+#endif
+#ifdef HID_TRACE
+    hid_trace_start();
+#endif
+    report_pace_init(app.report_period_us);
+    report_gate_init(&gate, app.send_on_change, app.send_on_change ? app.keepalive_ms * 1000 : 0);
+    xTaskCreatePinnedToCore(poll_task, "gbuttons", 2048, NULL, 1, NULL, 1);
+    //flash LED
+    vTaskDelay(100);
+    gpio_set_level(app.led_gpio, 0);
+    vTaskDelay(100);
+    gpio_set_level(app.led_gpio, 1);
+    vTaskDelay(100);
+    gpio_set_level(app.led_gpio, 0);
+    vTaskDelay(100);
+    gpio_set_level(app.led_gpio, 1);
+    vTaskDelay(100);
+    gpio_set_level(app.led_gpio, 0);
+    static esp_hidd_callbacks_t callbacks;
+    static esp_hidd_app_param_t app_param;
+    static esp_hidd_qos_param_t both_qos;
+
+    xSemaphore = xSemaphoreCreateMutex();
+    
+    gpio_config_t io_conf;
+    //disable interrupt
+    io_conf.intr_type = GPIO_PIN_INTR_DISABLE;
+    //set as output mode
+    io_conf.mode = GPIO_MODE_OUTPUT;
+    //bit mask of the pins that you want to set,e.g.GPIO18/19
+    io_conf.pin_bit_mask = 1ULL << app.led_gpio;
+    //disable pull-down mode
+    io_conf.pull_down_en = 0;
+    //disable pull-up mode
+    io_conf.pull_up_en = 0;
+    //configure GPIO with the given settings
+    gpio_config(&io_conf);
+
+    app_param.name = app.name;
+    app_param.description = app.description;
+    app_param.provider = "ESP32";
+    app_param.subclass = 0x8;
+    app_param.desc_list = hid_descriptor_gamecube;
+    app_param.desc_list_len = hid_descriptor_gc_len;
+    memset(&both_qos, 0, sizeof(esp_hidd_qos_param_t));
+
+    callbacks.application_state_cb = application_cb;
+    callbacks.connection_state_cb = connection_cb;
+    callbacks.get_report_cb = get_report_cb;
+    callbacks.set_report_cb = set_report_cb;
+    callbacks.set_protocol_cb = set_protocol_cb;
+    callbacks.intr_data_cb = intr_data_cb;
+    callbacks.vc_unplug_cb = vc_unplug_cb;
+    switch_subcmd_init(subcmd_table, sizeof(subcmd_table) / sizeof(subcmd_table[0]), send_reply);
+    
+    set_bt_address();
+    
+	ESP_ERROR_CHECK(esp_bt_controller_mem_release(ESP_BT_MODE_BLE));
+
+	esp_bt_controller_config_t bt_cfg = BT_CONTROLLER_INIT_CONFIG_DEFAULT();
+    esp_bt_mem_release(ESP_BT_MODE_BLE);
+    if ((ret = esp_bt_controller_init(&bt_cfg)) != ESP_OK) {
+        ESP_LOGE(TAG, "initialize controller failed: %s\n",  esp_err_to_name(ret));
+        return;
+    }
+
+    if ((ret = esp_bt_controller_enable(ESP_BT_MODE_CLASSIC_BT)) != ESP_OK) {
+        ESP_LOGE(TAG, "enable controller failed: %s\n",  esp_err_to_name(ret));
+        return;
+    }
+
+    if ((ret = esp_bluedroid_init()) != ESP_OK) {
+        ESP_LOGE(TAG, "initialize bluedroid failed: %s\n",  esp_err_to_name(ret));
+        return;
+    }
+
+    if ((ret = esp_bluedroid_enable()) != ESP_OK) {
+        ESP_LOGE(TAG, "enable bluedroid failed: %s\n",  esp_err_to_name(ret));
+        return;
+    }
+    esp_bt_gap_register_callback(esp_bt_gap_cb);
+    ESP_LOGI(TAG, "setting hid parameters");
+    esp_hid_device_register_app(&app_param, &both_qos, &both_qos);
+
+	ESP_LOGI(TAG, "starting hid device");
+	esp_hid_device_init(&callbacks);
+
+    ESP_LOGI(TAG, "setting device name");
+    esp_bt_dev_set_device_name("Pro Controller");
+
+    ESP_LOGI(TAG, "setting to connectable, discoverable");
+    esp_bt_gap_set_scan_mode(ESP_BT_CONNECTABLE, ESP_BT_GENERAL_DISCOVERABLE);
+    //start blinking
+    xTaskCreate(startBlink, "blink_task", 1024, NULL, 1, &BlinkHandle);
+
+    
+}
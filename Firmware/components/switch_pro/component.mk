@@ -0,0 +1,10 @@
+#
+# "switch_pro" component makefile.
+#
+# Nintendo Switch Pro Controller protocol pieces shared by the Switch
+# firmwares (BlueCubeModv2, BlueXNESMod, BlueN64Mod). Plain C, also built by
+# Firmware/host. The controller mappings (switch_gc/n64/xnes) also back the
+# drivers in components/pad. hid_trace_task.c is the FreeRTOS side of the
+# HID trace, only linked in with HID_TRACE.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
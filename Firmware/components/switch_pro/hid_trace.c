@@ -0,0 +1,293 @@
+//
+//  Binary HID traffic trace
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "hid_trace.h"
+
+#define DUMP_LINE_BYTES 32
+
+static void put_u16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+}
+
+static void put_u32(uint8_t *p, uint32_t v)
+{
+    put_u16(p, v & 0xFFFF);
+    put_u16(p + 2, v >> 16);
+}
+
+static uint16_t get_u16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return get_u16(p) | ((uint32_t)get_u16(p + 2) << 16);
+}
+
+static uint8_t ring_get(const hid_trace_t *t, size_t pos)
+{
+    return t->buf[pos % t->size];
+}
+
+static void ring_put(hid_trace_t *t, uint8_t v)
+{
+    t->buf[t->head] = v;
+    if(++t->head == t->size)
+        t->head = 0;
+}
+
+//Bytes the record at pos takes, also works on records that wrap
+static size_t ring_record_len(const hid_trace_t *t, size_t pos)
+{
+    uint8_t flags = ring_get(t, pos);
+    uint8_t len = ring_get(t, pos + 6);
+    size_t size = HID_TRACE_RECORD_LEN;
+
+    if(flags & HID_TRACE_KEY)
+        return size + len;
+    size += (len + 7) / 8;
+    for(size_t i = 0; i < (size_t)(len + 7) / 8; i++)
+        size += __builtin_popcount(ring_get(t, pos + HID_TRACE_RECORD_LEN + i));
+    return size;
+}
+
+static hid_trace_stream_t *stream_find(hid_trace_t *t, uint16_t id)
+{
+    for(int i = 0; i < HID_TRACE_STREAMS; i++)
+    {
+        if(t->streams[i].id == id)
+            return &t->streams[i];
+    }
+    //take over the next slot, its stream starts with a key again
+    hid_trace_stream_t *s = &t->streams[t->next_stream];
+    t->next_stream = (t->next_stream + 1) % HID_TRACE_STREAMS;
+    s->id = id;
+    s->len = 0;
+    s->since_key = HID_TRACE_KEY_INTERVAL;
+    return s;
+}
+
+void hid_trace_init(hid_trace_t *t, uint8_t *buf, size_t size)
+{
+    t->buf = buf;
+    t->size = size;
+    hid_trace_clear(t);
+}
+
+void hid_trace_clear(hid_trace_t *t)
+{
+    t->head = 0;
+    t->tail = 0;
+    t->used = 0;
+    t->records = 0;
+    t->dropped = 0;
+    t->next_stream = 0;
+    for(int i = 0; i < HID_TRACE_STREAMS; i++)
+        t->streams[i].id = 0xFFFF;
+}
+
+void hid_trace_add(hid_trace_t *t, uint32_t timestamp_us, uint8_t dir, const uint8_t *data, uint16_t len)
+{
+    uint8_t bitmap[(HID_TRACE_MAX_PAYLOAD + 7) / 8] = { 0 };
+    uint8_t flags = dir & HID_TRACE_DIR_MASK;
+    uint8_t report_id = len > 0 ? data[0] : 0;
+    size_t need = HID_TRACE_RECORD_LEN;
+
+    if(len > HID_TRACE_MAX_PAYLOAD)
+        len = HID_TRACE_MAX_PAYLOAD;
+
+    hid_trace_stream_t *s = stream_find(t, (flags << 8) | report_id);
+    if(s->len != len || s->since_key >= HID_TRACE_KEY_INTERVAL)
+    {
+        flags |= HID_TRACE_KEY;
+        need += len;
+    }
+    else
+    {
+        need += (len + 7) / 8;
+        for(int i = 0; i < len; i++)
+        {
+            if(data[i] != s->data[i])
+            {
+                bitmap[i / 8] |= 1 << (i % 8);
+                need++;
+            }
+        }
+    }
+    if(need > t->size)
+        return;
+
+    //make room, oldest records first
+    while(t->size - t->used < need)
+    {
+        size_t old = ring_record_len(t, t->tail);
+        t->tail = (t->tail + old) % t->size;
+        t->used -= old;
+        t->records--;
+        t->dropped++;
+    }
+
+    ring_put(t, flags);
+    ring_put(t, report_id);
+    for(int i = 0; i < 4; i++)
+        ring_put(t, timestamp_us >> (8 * i));
+    ring_put(t, len);
+    if(flags & HID_TRACE_KEY)
+    {
+        for(int i = 0; i < len; i++)
+            ring_put(t, data[i]);
+        s->since_key = 0;
+    }
+    else
+    {
+        for(int i = 0; i < (len + 7) / 8; i++)
+            ring_put(t, bitmap[i]);
+        for(int i = 0; i < len; i++)
+        {
+            if(bitmap[i / 8] & (1 << (i % 8)))
+                ring_put(t, data[i]);
+        }
+        s->since_key++;
+    }
+    memcpy(s->data, data, len);
+    s->len = len;
+    t->used += need;
+    t->records++;
+}
+
+static void export_header(const hid_trace_t *t, uint8_t *out)
+{
+    memcpy(out, HID_TRACE_MAGIC, 4);
+    out[4] = HID_TRACE_VERSION;
+    out[5] = 0;
+    put_u16(out + 6, 0);
+    put_u32(out + 8, t->records);
+    put_u32(out + 12, t->dropped);
+}
+
+size_t hid_trace_export(const hid_trace_t *t, uint8_t *out, size_t size)
+{
+    if(size < HID_TRACE_HEADER_LEN + t->used)
+        return 0;
+    export_header(t, out);
+    //oldest record first, in at most two pieces
+    size_t first = t->size - t->tail;
+    if(first > t->used)
+        first = t->used;
+    memcpy(out + HID_TRACE_HEADER_LEN, t->buf + t->tail, first);
+    memcpy(out + HID_TRACE_HEADER_LEN + first, t->buf, t->used - first);
+    return HID_TRACE_HEADER_LEN + t->used;
+}
+
+void hid_trace_print_ring(const hid_trace_t *t)
+{
+    uint8_t header[HID_TRACE_HEADER_LEN];
+    size_t len = HID_TRACE_HEADER_LEN + t->used;
+
+    export_header(t, header);
+    //same lines as hid_trace_print() of the export, without the copy
+    for(size_t i = 0; i < len; i += DUMP_LINE_BYTES)
+    {
+        printf(HID_TRACE_LOG_PREFIX);
+        for(size_t j = i; j < len && j < i + DUMP_LINE_BYTES; j++)
+            printf("%02x", j < HID_TRACE_HEADER_LEN ? header[j] : ring_get(t, t->tail + j - HID_TRACE_HEADER_LEN));
+        printf("\n");
+    }
+    printf(HID_TRACE_LOG_PREFIX "\n");
+}
+
+void hid_trace_print(const uint8_t *dump, size_t len)
+{
+    for(size_t i = 0; i < len; i += DUMP_LINE_BYTES)
+    {
+        printf(HID_TRACE_LOG_PREFIX);
+        for(size_t j = i; j < len && j < i + DUMP_LINE_BYTES; j++)
+            printf("%02x", dump[j]);
+        printf("\n");
+    }
+    //an empty line terminates the dump
+    printf(HID_TRACE_LOG_PREFIX "\n");
+}
+
+bool hid_trace_open(hid_trace_reader_t *rd, const uint8_t *buf, size_t len)
+{
+    if(len < HID_TRACE_HEADER_LEN || memcmp(buf, HID_TRACE_MAGIC, 4) != 0)
+        return false;
+    if(buf[4] != HID_TRACE_VERSION)
+        return false;
+    rd->buf = buf;
+    rd->len = len;
+    rd->pos = HID_TRACE_HEADER_LEN;
+    rd->records = get_u32(buf + 8);
+    rd->dropped = get_u32(buf + 12);
+    rd->skipped = 0;
+    memset(rd->have, 0, sizeof(rd->have));
+    return true;
+}
+
+int hid_trace_next(hid_trace_reader_t *rd, hid_trace_record_t *rec)
+{
+    while(rd->pos < rd->len)
+    {
+        const uint8_t *p = rd->buf + rd->pos;
+        const uint8_t *end = rd->buf + rd->len;
+        if(end - p < HID_TRACE_RECORD_LEN)
+            return -1;
+
+        uint8_t flags = p[0];
+        uint8_t dir = flags & HID_TRACE_DIR_MASK;
+        uint8_t id = p[1];
+        uint8_t len = p[6];
+        if(len > HID_TRACE_MAX_PAYLOAD)
+            return -1;
+        rec->dir = dir;
+        rec->report_id = id;
+        rec->timestamp_us = get_u32(p + 2);
+        rec->len = len;
+        p += HID_TRACE_RECORD_LEN;
+
+        uint8_t *last = rd->last[dir][id];
+        bool based = rd->have[dir][id] == len + 1;
+        if(flags & HID_TRACE_KEY)
+        {
+            if(end - p < len)
+                return -1;
+            memcpy(rec->data, p, len);
+            p += len;
+        }
+        else
+        {
+            const uint8_t *bitmap = p;
+            if(end - p < (len + 7) / 8)
+                return -1;
+            p += (len + 7) / 8;
+            memcpy(rec->data, last, len);
+            for(int i = 0; i < len; i++)
+            {
+                if(!(bitmap[i / 8] & (1 << (i % 8))))
+                    continue;
+                if(p >= end)
+                    return -1;
+                rec->data[i] = *p++;
+            }
+        }
+        rd->pos = p - rd->buf;
+
+        if(!(flags & HID_TRACE_KEY) && !based)
+        {
+            rd->skipped++;
+            continue;
+        }
+        memcpy(last, rec->data, len);
+        rd->have[dir][id] = len + 1;
+        return 1;
+    }
+    return 0;
+}
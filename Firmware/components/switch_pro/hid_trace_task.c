@@ -0,0 +1,52 @@
+//
+//  HID traffic trace on the device
+//
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+#include "hid_trace_task.h"
+
+static uint8_t rings[2][HID_TRACE_BUF_SIZE];
+static hid_trace_t traces[2];
+static hid_trace_t *active = &traces[0];   //the one being recorded into
+static portMUX_TYPE trace_mux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t dump_handle = NULL;
+
+void hid_trace_report(uint8_t dir, const uint8_t *data, uint16_t len)
+{
+    portENTER_CRITICAL(&trace_mux);
+    hid_trace_add(active, esp_timer_get_time(), dir, data, len);
+    portEXIT_CRITICAL(&trace_mux);
+}
+
+//Prints the trace whenever asked to, at low priority so the dump does
+//not hold up the Bluetooth callbacks
+static void dump_task(void *arg)
+{
+    while(1)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        portENTER_CRITICAL(&trace_mux);
+        hid_trace_t *full = active;
+        active = full == &traces[0] ? &traces[1] : &traces[0];
+        hid_trace_clear(active);
+        portEXIT_CRITICAL(&trace_mux);
+        //nobody writes to full until the next dump swaps it back in
+        hid_trace_print_ring(full);
+    }
+}
+
+void hid_trace_dump(void)
+{
+    if(dump_handle != NULL)
+        xTaskNotifyGive(dump_handle);
+}
+
+void hid_trace_start(void)
+{
+    hid_trace_init(&traces[0], rings[0], sizeof(rings[0]));
+    hid_trace_init(&traces[1], rings[1], sizeof(rings[1]));
+    xTaskCreate(dump_task, "hid_trace", 2048, NULL, 0, &dump_handle);
+}
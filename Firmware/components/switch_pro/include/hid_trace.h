@@ -0,0 +1,121 @@
+//
+//  Binary HID traffic trace
+//
+//  Records every output report the console sends and every input report
+//  (0x21 reply, 0x30 input, pairing filler) going back into a byte ring,
+//  so pairing can be debugged without printing from the Bluetooth
+//  callbacks. Old records are overwritten once the ring is full.
+//
+//  Record layout, all integers little endian:
+//
+//    u8 flags  u8 report_id  u32 timestamp_us  u8 len  payload
+//
+//  flags bit 0 is the direction (HID_TRACE_OUTPUT/INPUT), bit 7 marks a
+//  key record. A key record stores the len payload bytes as they are. Any
+//  other record is a delta against the previous record with the same
+//  direction and report id: a bitmap of (len + 7) / 8 bytes, bit n set
+//  when payload byte n changed, followed by the changed bytes. A 0x30
+//  report where only the timer moved takes 10 bytes instead of 20.
+//
+//  Every stream starts with a key and repeats one every
+//  HID_TRACE_KEY_INTERVAL records, so a trace whose oldest records were
+//  overwritten can be decoded from the next key of each stream on.
+//
+//  Dump layout (hid_trace_export):
+//
+//    header   'H' 'T' 'R' 'C'  u8 version  u8 reserved  u16 reserved
+//             u32 records  u32 dropped
+//    record...
+//
+//  On the device the dump is printed as "HIDT:<hex>" lines which
+//  Firmware/host/hid_trace turns back into a timeline. Plain C, the caller
+//  serialises writers; hid_trace_task.h does that on the device.
+//
+
+#ifndef HID_TRACE_H
+#define HID_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define HID_TRACE_MAGIC         "HTRC"
+#define HID_TRACE_VERSION       1
+#define HID_TRACE_HEADER_LEN    16
+#define HID_TRACE_RECORD_LEN    7
+#define HID_TRACE_LOG_PREFIX    "HIDT:"
+
+#define HID_TRACE_OUTPUT        0x00    // console -> controller
+#define HID_TRACE_INPUT         0x01    // controller -> console
+#define HID_TRACE_DIR_MASK      0x01
+#define HID_TRACE_KEY           0x80
+
+//Longer payloads are cut, Switch reports are 49 bytes at most
+#define HID_TRACE_MAX_PAYLOAD   64
+
+#ifndef HID_TRACE_KEY_INTERVAL
+#define HID_TRACE_KEY_INTERVAL  32
+#endif
+//Delta bases the writer keeps, a stream that lost its base starts with a key again
+#ifndef HID_TRACE_STREAMS
+#define HID_TRACE_STREAMS       8
+#endif
+
+typedef struct {
+    uint16_t id;                // dir << 8 | report id, 0xFFFF when unused
+    uint8_t len;
+    uint8_t since_key;
+    uint8_t data[HID_TRACE_MAX_PAYLOAD];
+} hid_trace_stream_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+    size_t head;                // next byte written
+    size_t tail;                // oldest record
+    size_t used;
+    uint32_t records;           // records in the ring
+    uint32_t dropped;           // records overwritten
+    uint8_t next_stream;
+    hid_trace_stream_t streams[HID_TRACE_STREAMS];
+} hid_trace_t;
+
+typedef struct {
+    uint8_t dir;
+    uint8_t report_id;
+    uint32_t timestamp_us;
+    uint8_t len;
+    uint8_t data[HID_TRACE_MAX_PAYLOAD];
+} hid_trace_record_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    size_t pos;
+    uint32_t records;
+    uint32_t dropped;
+    uint32_t skipped;           // deltas without their key, from before the oldest key
+    uint8_t have[2][256];       // payload length + 1 of the last record per stream, 0 if none
+    uint8_t last[2][256][HID_TRACE_MAX_PAYLOAD];
+} hid_trace_reader_t;
+
+void hid_trace_init(hid_trace_t *t, uint8_t *buf, size_t size);
+//Appends one report, overwriting the oldest records when the ring is full
+void hid_trace_add(hid_trace_t *t, uint32_t timestamp_us, uint8_t dir, const uint8_t *data, uint16_t len);
+//Empties the ring, the next record of every stream is a key
+void hid_trace_clear(hid_trace_t *t);
+
+//Writes the dump layout to out, returns its length or 0 if it does not fit
+size_t hid_trace_export(const hid_trace_t *t, uint8_t *out, size_t size);
+//Prints a dump as HID_TRACE_LOG_PREFIX hex lines
+void hid_trace_print(const uint8_t *dump, size_t len);
+//Prints the ring in the same form as its export, straight from the ring
+void hid_trace_print_ring(const hid_trace_t *t);
+
+//Reader: returns false if buf does not start with a valid header
+bool hid_trace_open(hid_trace_reader_t *rd, const uint8_t *buf, size_t len);
+//Decodes the next record. Returns 1, 0 at the end of the dump or -1 on a
+//malformed record. Deltas whose key was overwritten are skipped.
+int hid_trace_next(hid_trace_reader_t *rd, hid_trace_record_t *rec);
+
+#endif
@@ -0,0 +1,30 @@
+//
+//  HID traffic trace on the device
+//
+//  Owns the trace rings and a low priority task that prints them, so the
+//  sender and the Bluetooth callbacks only pay for hid_trace_add(). Two
+//  rings of HID_TRACE_BUF_SIZE bytes take turns: a dump switches recording
+//  to the empty one under the lock and prints the full one afterwards, so
+//  the lock is never held for a copy of the ring. Each dump holds the
+//  records since the previous one.
+//
+
+#ifndef HID_TRACE_TASK_H
+#define HID_TRACE_TASK_H
+
+#include <stdint.h>
+
+#include "hid_trace.h"
+
+#ifndef HID_TRACE_BUF_SIZE
+#define HID_TRACE_BUF_SIZE  8192
+#endif
+
+//Clears the rings and starts the dump task
+void hid_trace_start(void);
+//Records a report, from any task or Bluetooth callback
+void hid_trace_report(uint8_t dir, const uint8_t *data, uint16_t len);
+//Asks the dump task to print what was recorded since the last dump
+void hid_trace_dump(void);
+
+#endif
@@ -0,0 +1,28 @@
+//
+//  GameCube controller to Switch Pro Controller mapping
+//
+//    A, B, X, Y, Start, D-pad   A, B, X, Y, Plus, D-pad
+//    Z                          R
+//    L, R (digital)             ZL, ZR
+//    Z + Start                  Minus
+//    Z + D-pad up alone         Home
+//    main stick, C-stick        left, right stick
+//    analog L, R                triggers
+//
+//  Both sticks go through the stick shaping, the triggers through the
+//  learned calibration (components/input, pad_cal.h). The Switch report
+//  has no analog triggers, they are only carried in pad_state_t.
+//
+
+#ifndef SWITCH_GC_H
+#define SWITCH_GC_H
+
+#include "gc_frame.h"
+#include "pad_cal.h"
+#include "pad_state.h"
+#include "stick_shape.h"
+
+void switch_gc_map(const uint8_t status[GC_STATUS_LEN], const stick_shape_t *lstick, const stick_shape_t *cstick,
+                   const pad_cal_t *cal, pad_state_t *state);
+
+#endif
@@ -0,0 +1,97 @@
+//
+//  Switch Pro Controller input state
+//
+//  The poller encodes each sample straight into the 9 bytes that reports
+//  0x30 and 0x21 carry at offset 3 (3 button bytes, then left and right
+//  stick as 2 x 12 bit each) and publishes it into a single slot guarded by
+//  a sequence counter (seqlock). The sender copies it out without taking a
+//  lock; a copy that raced with a publish is simply retried.
+//
+//  There is one slot per physical pad (SWITCH_INPUT_SLOTS), slot 0 is the
+//  one the Switch reports are built from. Each slot has one writer (the
+//  poller task) and any number of readers.
+//
+
+#ifndef SWITCH_INPUT_H
+#define SWITCH_INPUT_H
+
+#include <stdint.h>
+
+#include "pad_state.h"
+
+#define SWITCH_INPUT_LEN        9
+#define SWITCH_INPUT_OFFSET     3   // position in reports 0x30 and 0x21
+
+#define SWITCH_STICK_CENTER     0x800
+
+//Button bytes of the Switch report (switch_input_t data[0..2])
+#define SWITCH_BTN_Y        0x01    // data[0]
+#define SWITCH_BTN_X        0x02
+#define SWITCH_BTN_B        0x04
+#define SWITCH_BTN_A        0x08
+#define SWITCH_BTN_R        0x40
+#define SWITCH_BTN_ZR       0x80
+#define SWITCH_BTN_MINUS    0x01    // data[1]
+#define SWITCH_BTN_PLUS     0x02
+#define SWITCH_BTN_HOME     0x10
+#define SWITCH_BTN_DOWN     0x01    // data[2]
+#define SWITCH_BTN_UP       0x02
+#define SWITCH_BTN_RIGHT    0x04
+#define SWITCH_BTN_LEFT     0x08
+#define SWITCH_BTN_L        0x40
+#define SWITCH_BTN_ZL       0x80
+
+#ifndef SWITCH_INPUT_SLOTS
+#define SWITCH_INPUT_SLOTS      4
+#endif
+
+typedef struct {
+    uint8_t data[SWITCH_INPUT_LEN];
+} switch_input_t;
+
+//Packs a 12 bit per axis stick position
+static inline void switch_pack_stick(uint8_t out[3], uint16_t x, uint16_t y)
+{
+    out[0] = x & 0xFF;
+    out[1] = ((x >> 8) & 0x0F) | ((y & 0x0F) << 4);
+    out[2] = y >> 4;
+}
+
+//Encodes buttons and 12 bit sticks (centered on SWITCH_STICK_CENTER)
+static inline void switch_input_encode12(switch_input_t *in, uint8_t but1, uint8_t but2, uint8_t but3,
+                                         uint16_t lx, uint16_t ly, uint16_t cx, uint16_t cy)
+{
+    in->data[0] = but1;
+    in->data[1] = but2;
+    in->data[2] = but3;
+    switch_pack_stick(&in->data[3], lx, ly);
+    switch_pack_stick(&in->data[6], cx, cy);
+}
+
+//Encodes buttons and 8 bit sticks (centered on 0x80)
+static inline void switch_input_encode(switch_input_t *in, uint8_t but1, uint8_t but2, uint8_t but3,
+                                       uint8_t lx, uint8_t ly, uint8_t cx, uint8_t cy)
+{
+    switch_input_encode12(in, but1, but2, but3, lx << 4, ly << 4, cx << 4, cy << 4);
+}
+
+//Encodes a decoded pad, its button word already has the report layout
+static inline void switch_input_encode_state(switch_input_t *in, const pad_state_t *state)
+{
+    switch_input_encode12(in, state->buttons, state->buttons >> 8, state->buttons >> 16,
+                          state->lx, state->ly, state->rx, state->ry);
+}
+
+//Poller side
+void switch_input_publish_slot(uint8_t slot, const switch_input_t *in);
+//Sender side: consistent copy of the last input published to slot
+void switch_input_read_slot(uint8_t slot, switch_input_t *out);
+
+//Same on slot 0
+void switch_input_publish(const switch_input_t *in);
+void switch_input_read(switch_input_t *out);
+
+//Timer byte of the next input report (0x21 or 0x30), shared by all senders
+uint8_t switch_input_timer(void);
+
+#endif
@@ -0,0 +1,32 @@
+//
+//  N64 controller to Switch Pro Controller mapping
+//
+//    A, B, L, R, Start, D-pad   A, B, L, R, Plus, D-pad
+//    Z                          ZL
+//    C buttons                  right stick, full deflection
+//    Z + Start                  Minus
+//    Z + D-pad up               Home
+//
+//  This is the layout the Switch N64 emulator uses for its own controller.
+//  The main stick goes through the stick shaping (octagonal gate, like the
+//  N64 one) centered on 0 since the pad zeroes its stick itself.
+//
+
+#ifndef SWITCH_N64_H
+#define SWITCH_N64_H
+
+#include "n64_frame.h"
+#include "pad_state.h"
+#include "stick_shape.h"
+
+//Raw travel from center to the gate of an original controller
+#ifndef N64_STICK_RANGE
+#define N64_STICK_RANGE     80
+#endif
+
+//Stick tables for an N64 pad, deadzone/outer/curve as in stick_shape_config_t
+void switch_n64_stick_init(stick_shape_t *stick, uint16_t deadzone, uint16_t outer, uint8_t curve);
+
+void switch_n64_map(const uint8_t status[N64_STATUS_LEN], const stick_shape_t *stick, pad_state_t *state);
+
+#endif
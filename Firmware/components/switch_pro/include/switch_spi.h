@@ -0,0 +1,37 @@
+//
+//  Switch Pro Controller SPI flash image
+//
+//  The host reads the controller's configuration out of its SPI flash with
+//  subcommand 0x10 (u32 address, u8 length) and writes user calibration
+//  with 0x11 (u32 address, u8 length, data). Only the factory configuration
+//  (0x6000) and user calibration (0x8000) blocks are backed by data, kept
+//  as one const image; every other address reads as erased flash (0xFF).
+//  The user calibration block is copied to RAM on first write, so 0x11
+//  updates are returned by later reads (until reset).
+//
+
+#ifndef SWITCH_SPI_H
+#define SWITCH_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "switch_subcmd.h"
+
+#define SWITCH_SPI_FACTORY_ADDR     0x6000
+#define SWITCH_SPI_FACTORY_LEN      0xB0
+#define SWITCH_SPI_USER_ADDR        0x8000
+#define SWITCH_SPI_USER_LEN         0x40
+
+#define SWITCH_SPI_READ_MAX         0x1D    // largest read that fits one reply
+
+//Copies len bytes at addr into out
+void switch_spi_read(uint32_t addr, uint8_t *out, uint8_t len);
+//Only the user calibration block is writable, false for anything else
+bool switch_spi_write(uint32_t addr, const uint8_t *data, uint8_t len);
+
+//Subcommand handlers for 0x10 and 0x11
+void switch_spi_read_subcmd(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len);
+void switch_spi_write_subcmd(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len);
+
+#endif
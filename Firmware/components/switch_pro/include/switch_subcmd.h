@@ -0,0 +1,88 @@
+//
+//  Switch subcommand dispatch
+//
+//  Output report 0x01 carries a subcommand at byte 10 and its arguments
+//  from byte 11 on (for 0x10 SPI flash read: 32 bit address, then length).
+//  Every subcommand has to be answered with an input report 0x21, a host
+//  that gets no reply retries until it times out, which stalls pairing.
+//  Other output reports (0x10 rumble only) get no reply.
+//
+//  Handlers are kept in a table keyed on the subcommand and, for entries
+//  with key_len > 0, on the first one or two argument bytes (SPI address).
+//  switch_subcmd_init() sorts the table and indexes it by subcommand, a
+//  packet is then matched with one index lookup and a binary search over
+//  the few entries of its subcommand. Packets no entry matches get a
+//  generic acknowledgement from switch_subcmd_ack().
+//
+//  Replies are built in place in one scratch buffer: the 13 byte report
+//  header (live timer and input from switch_input), the ack byte, the
+//  echoed subcommand and the entry's payload. Only the payload is stored
+//  per subcommand, as const data.
+//
+
+#ifndef SWITCH_SUBCMD_H
+#define SWITCH_SUBCMD_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define SWITCH_OUTPUT_SUBCMD    0x01    // output report with rumble and subcommand
+#define SWITCH_SUBCMD_OFFSET    10  // subcommand id in output report 0x01
+#define SWITCH_SUBCMD_ARG       11
+#define SWITCH_REPLY_LEN        49  // input report 0x21 without the 0xa1 header
+
+//Reply layout (input report 0x21)
+#define SWITCH_REPLY_ACK        13
+#define SWITCH_REPLY_SUBCMD     14
+#define SWITCH_REPLY_DATA       15
+#define SWITCH_REPLY_DATA_MAX   (SWITCH_REPLY_LEN - SWITCH_REPLY_DATA)
+
+#define SWITCH_ACK              0x80
+
+#define SWITCH_SUBCMD_SPI_READ  0x10
+#define SWITCH_SUBCMD_SPI_WRITE 0x11
+
+#ifndef SWITCH_SUBCMD_MAX_ENTRIES
+#define SWITCH_SUBCMD_MAX_ENTRIES   32
+#endif
+
+typedef struct switch_subcmd switch_subcmd_t;
+
+//Handlers get the whole output report (len bytes)
+typedef void (*switch_subcmd_fn)(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len);
+//Sends one input report 0x21
+typedef void (*switch_reply_fn)(const uint8_t *reply, uint16_t len);
+
+struct switch_subcmd {
+    uint8_t subcmd;
+    uint8_t key_len;            // argument bytes matched, 0..2, same for all entries of a subcommand
+    uint16_t key;               // p_data[11] | p_data[12] << 8
+    switch_subcmd_fn fn;        // NULL replies with ack and data
+    uint8_t ack;
+    const uint8_t *data;        // payload after the echoed subcommand
+    uint8_t data_len;
+};
+
+//Indexes table (not copied, must stay valid). Returns -1 if the table is
+//too big or mixes key lengths within a subcommand.
+int switch_subcmd_init(const switch_subcmd_t *table, size_t count, switch_reply_fn send);
+
+//Finds the entry for an output report, NULL if there is none
+const switch_subcmd_t *switch_subcmd_find(const uint8_t *p_data, uint16_t len);
+
+//Runs the handler for an output report, or acknowledges it if there is none
+void switch_subcmd_dispatch(const uint8_t *p_data, uint16_t len);
+
+//Starts a reply to the output report p_data in the scratch buffer and
+//returns its zeroed payload area (SWITCH_REPLY_DATA_MAX bytes) for the
+//caller to fill in, switch_subcmd_reply_send() then sends it
+uint8_t *switch_subcmd_reply_begin(uint8_t ack, const uint8_t *p_data, uint16_t len);
+void switch_subcmd_reply_send(void);
+
+//Same in one step with data_len bytes of data (cut to SWITCH_REPLY_DATA_MAX)
+void switch_subcmd_reply(uint8_t ack, const uint8_t *p_data, uint16_t len, const uint8_t *data, uint8_t data_len);
+
+//Generic reply: plain ACK echoing the subcommand
+void switch_subcmd_ack(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len);
+
+#endif
@@ -0,0 +1,47 @@
+//
+//  NES/SNES controller to Switch Pro Controller mapping
+//
+//    A, B, X, Y, Start, Select   A, B, X, Y, Plus, Minus
+//    D-pad                       D-pad
+//    SNES L, R                   ZL, ZR
+//    NES Start + Select          ZL + ZR, opens the emulator menu
+//    Start + Select + Right      Home
+//    Start + Select + Down       Minus
+//
+//  The pads have no sticks, both are reported centered.
+//
+
+#ifndef SWITCH_XNES_H
+#define SWITCH_XNES_H
+
+#include <stdint.h>
+
+#include "pad_state.h"
+
+//Shift register bits as xnes_read() returns them, 1 = pressed
+//
+//  NES:  | A B Select Start Up Down Left Right |
+//  SNES: | B Y Select Start Up Down Left Right A X L R |
+#define XNES_BTN_SELECT     0x004
+#define XNES_BTN_START      0x008
+#define XNES_BTN_UP         0x010
+#define XNES_BTN_DOWN       0x020
+#define XNES_BTN_LEFT       0x040
+#define XNES_BTN_RIGHT      0x080
+#define XNES_NES_A          0x001
+#define XNES_NES_B          0x002
+#define XNES_SNES_B         0x001
+#define XNES_SNES_Y         0x002
+#define XNES_SNES_A         0x100
+#define XNES_SNES_X         0x200
+#define XNES_SNES_L         0x400
+#define XNES_SNES_R         0x800
+
+typedef enum {
+    SWITCH_XNES_NES,
+    SWITCH_XNES_SNES,
+} switch_xnes_layout_t;
+
+void switch_xnes_map(uint32_t pressed, switch_xnes_layout_t layout, pad_state_t *state);
+
+#endif
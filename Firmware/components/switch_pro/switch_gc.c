@@ -0,0 +1,40 @@
+//
+//  GameCube controller to Switch Pro Controller mapping
+//
+
+#include "switch_gc.h"
+
+void switch_gc_map(const uint8_t status[GC_STATUS_LEN], const stick_shape_t *lstick, const stick_shape_t *cstick,
+                   const pad_cal_t *cal, pad_state_t *state)
+{
+    uint8_t b0 = status[GC_BYTE_BUTTONS0];
+    uint8_t b1 = status[GC_BYTE_BUTTONS1];
+    uint32_t buttons = 0;
+
+    if(b0 & GC_BTN_A) buttons |= PAD_BTN_A;
+    if(b0 & GC_BTN_B) buttons |= PAD_BTN_B;
+    if(b0 & GC_BTN_X) buttons |= PAD_BTN_X;
+    if(b0 & GC_BTN_Y) buttons |= PAD_BTN_Y;
+    if(b0 & GC_BTN_START) buttons |= PAD_BTN_PLUS;
+
+    //DPAD
+    if(b1 & GC_BTN_DLEFT) buttons |= PAD_BTN_LEFT;
+    if(b1 & GC_BTN_DRIGHT) buttons |= PAD_BTN_RIGHT;
+    if(b1 & GC_BTN_DDOWN) buttons |= PAD_BTN_DOWN;
+    if(b1 & GC_BTN_DUP) buttons |= PAD_BTN_UP;
+
+    if(b1 & GC_BTN_R) buttons |= PAD_BTN_ZR;
+    if(b1 & GC_BTN_L) buttons |= PAD_BTN_ZL;
+    if(b1 & GC_BTN_Z)
+    {
+        buttons |= PAD_BTN_R;
+        if(b0 & GC_BTN_START) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_MINUS;                  // Minus = Z + Start
+        if((buttons & PAD_BTN_BYTE(2)) == PAD_BTN_UP) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_HOME;  // Home = Z + Up
+    }
+    state->buttons = buttons;
+
+    stick_shape_apply(lstick, status[GC_BYTE_LX], status[GC_BYTE_LY], &state->lx, &state->ly);
+    stick_shape_apply(cstick, status[GC_BYTE_CX], status[GC_BYTE_CY], &state->rx, &state->ry);
+    state->lt = pad_cal_trigger(cal, PAD_CAL_L, status[GC_BYTE_L_ANALOG]);
+    state->rt = pad_cal_trigger(cal, PAD_CAL_R, status[GC_BYTE_R_ANALOG]);
+}
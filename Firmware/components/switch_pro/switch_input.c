@@ -0,0 +1,61 @@
+//
+//  Switch Pro Controller input state
+//
+
+#include <stdbool.h>
+
+#include "switch_input.h"
+
+typedef struct {
+    uint32_t seq;           // odd while a publish is in progress
+    switch_input_t input;
+} input_slot_t;
+
+//no buttons, both sticks centered
+#define NEUTRAL_SLOT    { 0, { { 0x00, 0x00, 0x00, 0x00, 0x08, 0x80, 0x00, 0x08, 0x80 } } }
+
+static uint8_t report_timer = 0;
+static input_slot_t input_slots[SWITCH_INPUT_SLOTS] = {
+    [0 ... SWITCH_INPUT_SLOTS - 1] = NEUTRAL_SLOT
+};
+
+void switch_input_publish_slot(uint8_t slot, const switch_input_t *in)
+{
+    input_slot_t *s = &input_slots[slot];
+    uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for(int i = 0; i < SWITCH_INPUT_LEN; i++)
+        __atomic_store_n(&s->input.data[i], in->data[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+void switch_input_read_slot(uint8_t slot, switch_input_t *out)
+{
+    input_slot_t *s = &input_slots[slot];
+    uint32_t before, after;
+
+    do {
+        before = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+        for(int i = 0; i < SWITCH_INPUT_LEN; i++)
+            out->data[i] = __atomic_load_n(&s->input.data[i], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+    } while(before != after || (before & 1));
+}
+
+void switch_input_publish(const switch_input_t *in)
+{
+    switch_input_publish_slot(0, in);
+}
+
+void switch_input_read(switch_input_t *out)
+{
+    switch_input_read_slot(0, out);
+}
+
+uint8_t switch_input_timer(void)
+{
+    return __atomic_fetch_add(&report_timer, 1, __ATOMIC_RELAXED);
+}
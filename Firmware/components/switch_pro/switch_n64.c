@@ -0,0 +1,57 @@
+//
+//  N64 controller to Switch Pro Controller mapping
+//
+
+#include "switch_n64.h"
+
+void switch_n64_stick_init(stick_shape_t *stick, uint16_t deadzone, uint16_t outer, uint8_t curve)
+{
+    stick_shape_config_t config = {
+        .deadzone = deadzone,
+        .outer = outer,
+        .curve = curve,
+        .octagon = true,
+    };
+
+    stick_axis_cal_default(&config.x, 128, N64_STICK_RANGE);
+    stick_axis_cal_default(&config.y, 128, N64_STICK_RANGE);
+    stick_shape_init(stick, &config);
+}
+
+void switch_n64_map(const uint8_t status[N64_STATUS_LEN], const stick_shape_t *stick, pad_state_t *state)
+{
+    uint8_t b0 = status[N64_BYTE_BUTTONS0];
+    uint8_t b1 = status[N64_BYTE_BUTTONS1];
+    uint32_t buttons = 0;
+
+    if(b0 & N64_BTN_A) buttons |= PAD_BTN_A;
+    if(b0 & N64_BTN_B) buttons |= PAD_BTN_B;
+    if(b1 & N64_BTN_R) buttons |= PAD_BTN_R;
+    if(b1 & N64_BTN_L) buttons |= PAD_BTN_L;
+    if(b0 & N64_BTN_Z) buttons |= PAD_BTN_ZL;
+    if(b0 & N64_BTN_START) buttons |= PAD_BTN_PLUS;
+
+    //DPAD
+    if(b0 & N64_BTN_DLEFT) buttons |= PAD_BTN_LEFT;
+    if(b0 & N64_BTN_DRIGHT) buttons |= PAD_BTN_RIGHT;
+    if(b0 & N64_BTN_DDOWN) buttons |= PAD_BTN_DOWN;
+    if(b0 & N64_BTN_DUP) buttons |= PAD_BTN_UP;
+
+    if(b0 & N64_BTN_Z)
+    {
+        if(b0 & N64_BTN_START) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_MINUS;  // Minus = Z + Start
+        if(b0 & N64_BTN_DUP) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_HOME;      // Home = Z + Up
+    }
+    state->buttons = buttons;
+
+    //C buttons are digital, push the right stick all the way
+    state->rx = PAD_STICK_CENTER;
+    state->ry = PAD_STICK_CENTER;
+    if(b1 & N64_BTN_CLEFT) state->rx -= STICK_OUT_RANGE;
+    if(b1 & N64_BTN_CRIGHT) state->rx += STICK_OUT_RANGE;
+    if(b1 & N64_BTN_CDOWN) state->ry -= STICK_OUT_RANGE;
+    if(b1 & N64_BTN_CUP) state->ry += STICK_OUT_RANGE;
+
+    stick_shape_apply(stick, n64_stick_raw(status[N64_BYTE_X]), n64_stick_raw(status[N64_BYTE_Y]), &state->lx, &state->ly);
+    state->lt = state->rt = 0;
+}
@@ -0,0 +1,114 @@
+//
+//  Switch Pro Controller SPI flash image
+//
+
+#include <string.h>
+
+#include "switch_spi.h"
+
+#define ACK_SPI_READ    0x90
+#define ACK_SPI_WRITE   0x80
+#define SPI_ARG_LEN     5   // u32 address, u8 length
+
+//0x6000 factory configuration
+static const uint8_t factory_image[SWITCH_SPI_FACTORY_LEN] = {
+    //0x6000 serial number, none
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    [0x10 ... 0x1F] = 0xFF,
+    //0x6020 6-axis factory calibration
+    [0x20 ... 0x37] = 0x00,
+    [0x38 ... 0x3C] = 0xFF,
+    //0x603D left and right stick factory calibration
+    [0x3D] = 0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F,
+    0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F,
+    0xFF,
+    //0x6050 body and button colors
+    [0x50 ... 0x67] = 0x00,
+    [0x68 ... 0x7F] = 0xFF,
+    //0x6080 6-axis horizontal offsets
+    [0x80] = 0x5E, 0x01, 0x00, 0x00, 0xF1, 0x0F,
+    //0x6086 left stick parameters
+    0x19, 0xD0, 0x4C, 0xAE, 0x40, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    //0x6098 right stick parameters
+    0x19, 0xD0, 0x4C, 0xAE, 0x40, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    [0xAA ... 0xAF] = 0xFF,
+};
+
+//0x8000 user calibration, no magic (0xB2 0xA1) so the factory values apply
+static const uint8_t user_image[SWITCH_SPI_USER_LEN] = {
+    [0x00 ... 0x0F] = 0xFF,
+    [0x10 ... 0x27] = 0x00,
+    [0x28 ... 0x3F] = 0xFF,
+};
+static uint8_t user_ram[SWITCH_SPI_USER_LEN];
+static bool user_written = false;
+
+static void read_block(uint32_t addr, uint8_t *out, uint8_t len,
+                       uint32_t base, const uint8_t *block, uint32_t block_len)
+{
+    for(uint32_t i = 0; i < len; i++)
+    {
+        uint32_t a = addr + i;
+        if(a >= base && a < base + block_len)
+            out[i] = block[a - base];
+    }
+}
+
+void switch_spi_read(uint32_t addr, uint8_t *out, uint8_t len)
+{
+    memset(out, 0xFF, len);
+    read_block(addr, out, len, SWITCH_SPI_FACTORY_ADDR, factory_image, sizeof(factory_image));
+    read_block(addr, out, len, SWITCH_SPI_USER_ADDR, user_written ? user_ram : user_image, sizeof(user_image));
+}
+
+bool switch_spi_write(uint32_t addr, const uint8_t *data, uint8_t len)
+{
+    //offset + len cannot wrap, addr + len can
+    uint32_t offset = addr - SWITCH_SPI_USER_ADDR;
+    if(addr < SWITCH_SPI_USER_ADDR || offset + len > SWITCH_SPI_USER_LEN)
+        return false;
+    if(!user_written)
+    {
+        memcpy(user_ram, user_image, sizeof(user_ram));
+        user_written = true;
+    }
+    memcpy(&user_ram[offset], data, len);
+    return true;
+}
+
+static uint32_t spi_addr(const uint8_t *arg)
+{
+    return arg[0] | (arg[1] << 8) | (arg[2] << 16) | ((uint32_t)arg[3] << 24);
+}
+
+void switch_spi_read_subcmd(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len)
+{
+    if(len < SWITCH_SUBCMD_ARG + SPI_ARG_LEN)
+    {
+        switch_subcmd_ack(entry, p_data, len);
+        return;
+    }
+    //address and length are echoed in front of the data
+    uint8_t *data = switch_subcmd_reply_begin(ACK_SPI_READ, p_data, len);
+    memcpy(data, &p_data[SWITCH_SUBCMD_ARG], SPI_ARG_LEN);
+    if(data[4] > SWITCH_SPI_READ_MAX)
+        data[4] = SWITCH_SPI_READ_MAX;
+    switch_spi_read(spi_addr(data), &data[SPI_ARG_LEN], data[4]);
+    switch_subcmd_reply_send();
+}
+
+void switch_spi_write_subcmd(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len)
+{
+    const uint8_t *arg = &p_data[SWITCH_SUBCMD_ARG];
+    //0x00 written, 0x01 write protected
+    uint8_t status = 0x01;
+
+    if(len >= SWITCH_SUBCMD_ARG + SPI_ARG_LEN && SWITCH_SUBCMD_ARG + SPI_ARG_LEN + arg[4] <= len)
+    {
+        if(switch_spi_write(spi_addr(arg), &arg[SPI_ARG_LEN], arg[4]))
+            status = 0x00;
+    }
+    switch_subcmd_reply(ACK_SPI_WRITE, p_data, len, &status, 1);
+}
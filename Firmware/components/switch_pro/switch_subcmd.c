@@ -0,0 +1,145 @@
+//
+//  Switch subcommand dispatch
+//
+
+#include <string.h>
+
+#include "switch_subcmd.h"
+#include "switch_input.h"
+
+#define REPLY_REPORT_ID     0x21
+#define REPLY_CONN_INFO     0x8E    // battery full, Pro Controller, powered
+#define REPLY_VIBRATOR      0x80
+
+typedef struct {
+    uint8_t first;
+    uint8_t count;
+} subcmd_index_t;
+
+static const switch_subcmd_t *sorted[SWITCH_SUBCMD_MAX_ENTRIES];
+static subcmd_index_t subcmd_index[256];
+static switch_reply_fn reply_send;
+//replies are only built from the HID callback, one at a time
+static uint8_t reply_buf[SWITCH_REPLY_LEN];
+
+static int entry_cmp(const switch_subcmd_t *a, const switch_subcmd_t *b)
+{
+    if(a->subcmd != b->subcmd)
+        return a->subcmd < b->subcmd ? -1 : 1;
+    if(a->key != b->key)
+        return a->key < b->key ? -1 : 1;
+    return 0;
+}
+
+static uint16_t packet_key(const uint8_t *p_data, uint16_t len, uint8_t key_len)
+{
+    uint16_t key = 0;
+    for(int i = 0; i < key_len && SWITCH_SUBCMD_ARG + i < len; i++)
+        key |= p_data[SWITCH_SUBCMD_ARG + i] << (8 * i);
+    return key;
+}
+
+int switch_subcmd_init(const switch_subcmd_t *table, size_t count, switch_reply_fn send)
+{
+    if(count > SWITCH_SUBCMD_MAX_ENTRIES)
+        return -1;
+
+    //insertion sort, the table is small and built once
+    for(size_t i = 0; i < count; i++)
+    {
+        size_t j = i;
+        for(; j > 0 && entry_cmp(&table[i], sorted[j - 1]) < 0; j--)
+            sorted[j] = sorted[j - 1];
+        sorted[j] = &table[i];
+    }
+
+    memset(subcmd_index, 0, sizeof(subcmd_index));
+    for(size_t i = 0; i < count; i++)
+    {
+        subcmd_index_t *idx = &subcmd_index[sorted[i]->subcmd];
+        if(idx->count == 0)
+            idx->first = i;
+        else if(sorted[idx->first]->key_len != sorted[i]->key_len)
+            return -1;
+        idx->count++;
+    }
+    reply_send = send;
+    return 0;
+}
+
+const switch_subcmd_t *switch_subcmd_find(const uint8_t *p_data, uint16_t len)
+{
+    if(len <= SWITCH_SUBCMD_OFFSET)
+        return NULL;
+    const subcmd_index_t *idx = &subcmd_index[p_data[SWITCH_SUBCMD_OFFSET]];
+    if(idx->count == 0)
+        return NULL;
+
+    const switch_subcmd_t *const *entries = &sorted[idx->first];
+    uint16_t key = packet_key(p_data, len, entries[0]->key_len);
+    int lo = 0;
+    int hi = idx->count - 1;
+    while(lo <= hi)
+    {
+        int mid = (lo + hi) / 2;
+        if(entries[mid]->key == key)
+            return entries[mid];
+        if(entries[mid]->key < key)
+            lo = mid + 1;
+        else
+            hi = mid - 1;
+    }
+    return NULL;
+}
+
+void switch_subcmd_dispatch(const uint8_t *p_data, uint16_t len)
+{
+    //rumble only reports are not answered
+    if(len == 0 || p_data[0] != SWITCH_OUTPUT_SUBCMD)
+        return;
+    const switch_subcmd_t *entry = switch_subcmd_find(p_data, len);
+
+    if(entry == NULL)
+        switch_subcmd_ack(NULL, p_data, len);
+    else if(entry->fn != NULL)
+        entry->fn(entry, p_data, len);
+    else
+        switch_subcmd_reply(entry->ack, p_data, len, entry->data, entry->data_len);
+}
+
+uint8_t *switch_subcmd_reply_begin(uint8_t ack, const uint8_t *p_data, uint16_t len)
+{
+    switch_input_t input;
+
+    switch_input_read(&input);
+    reply_buf[0] = REPLY_REPORT_ID;
+    reply_buf[1] = switch_input_timer();
+    reply_buf[2] = REPLY_CONN_INFO;
+    memcpy(&reply_buf[SWITCH_INPUT_OFFSET], input.data, SWITCH_INPUT_LEN);
+    reply_buf[SWITCH_INPUT_OFFSET + SWITCH_INPUT_LEN] = REPLY_VIBRATOR;
+    reply_buf[SWITCH_REPLY_ACK] = ack;
+    reply_buf[SWITCH_REPLY_SUBCMD] = len > SWITCH_SUBCMD_OFFSET ? p_data[SWITCH_SUBCMD_OFFSET] : 0;
+    memset(&reply_buf[SWITCH_REPLY_DATA], 0, SWITCH_REPLY_DATA_MAX);
+    return &reply_buf[SWITCH_REPLY_DATA];
+}
+
+void switch_subcmd_reply_send(void)
+{
+    reply_send(reply_buf, sizeof(reply_buf));
+}
+
+void switch_subcmd_reply(uint8_t ack, const uint8_t *p_data, uint16_t len, const uint8_t *data, uint8_t data_len)
+{
+    uint8_t *payload = switch_subcmd_reply_begin(ack, p_data, len);
+
+    if(data_len > SWITCH_REPLY_DATA_MAX)
+        data_len = SWITCH_REPLY_DATA_MAX;
+    if(data_len > 0)
+        memcpy(payload, data, data_len);
+    switch_subcmd_reply_send();
+}
+
+void switch_subcmd_ack(const switch_subcmd_t *entry, const uint8_t *p_data, uint16_t len)
+{
+    switch_subcmd_reply(SWITCH_ACK, p_data, len, NULL, 0);
+}
@@ -0,0 +1,48 @@
+//
+//  NES/SNES controller to Switch Pro Controller mapping
+//
+
+#include <stdbool.h>
+
+#include "switch_xnes.h"
+
+//Sticks sit in the middle, so no glitches occur
+#define STICK_MIDDLE    (127 << 4)
+
+void switch_xnes_map(uint32_t pressed, switch_xnes_layout_t layout, pad_state_t *state)
+{
+    bool snes = layout == SWITCH_XNES_SNES;
+    uint32_t buttons = 0;
+
+    if(pressed & (snes ? XNES_SNES_A : XNES_NES_A)) buttons |= PAD_BTN_A;
+    if(pressed & (snes ? XNES_SNES_B : XNES_NES_B)) buttons |= PAD_BTN_B;
+    if(snes)
+    {
+        if(pressed & XNES_SNES_X) buttons |= PAD_BTN_X;
+        if(pressed & XNES_SNES_Y) buttons |= PAD_BTN_Y;
+        if(pressed & XNES_SNES_R) buttons |= PAD_BTN_ZR;
+        if(pressed & XNES_SNES_L) buttons |= PAD_BTN_ZL;
+    }
+    if(pressed & XNES_BTN_START) buttons |= PAD_BTN_PLUS;
+    if(pressed & XNES_BTN_SELECT) buttons |= PAD_BTN_MINUS;
+
+    //DPAD
+    if(pressed & XNES_BTN_LEFT) buttons |= PAD_BTN_LEFT;
+    if(pressed & XNES_BTN_RIGHT) buttons |= PAD_BTN_RIGHT;
+    if(pressed & XNES_BTN_DOWN) buttons |= PAD_BTN_DOWN;
+    if(pressed & XNES_BTN_UP) buttons |= PAD_BTN_UP;
+
+    if((pressed & XNES_BTN_START) && (pressed & XNES_BTN_SELECT))
+    {
+        //the NES pad has no shoulder buttons, ZL + ZR enter the emulator menu
+        if(!snes)
+            buttons |= PAD_BTN_ZR | PAD_BTN_ZL;
+        if(pressed & XNES_BTN_RIGHT) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_HOME;
+        if(pressed & XNES_BTN_DOWN) buttons = (buttons & ~PAD_BTN_BYTE(1)) | PAD_BTN_MINUS;
+    }
+
+    state->buttons = buttons;
+    state->lx = state->ly = STICK_MIDDLE;
+    state->rx = state->ry = STICK_MIDDLE;
+    state->lt = state->rt = 0;
+}
@@ -0,0 +1,6 @@
+#
+# "xnes" component makefile.
+#
+# NES/SNES shift register controller reader used by BlueXNESMod.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
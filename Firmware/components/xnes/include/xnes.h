@@ -0,0 +1,50 @@
+//
+//  NES/SNES controller reader
+//
+//  The pad is a parallel-in/serial-out shift register: a pulse on latch
+//  loads the button states, the first bit is then on data and every clock
+//  pulse shifts in the next one. Buttons are active low.
+//
+//  Up to XNES_MAX_PADS pads can share the latch and clock lines, each with
+//  its own data line. All data lines are sampled together with one read of
+//  the GPIO input register per clock, so reading four pads takes as long as
+//  reading one.
+//
+//  The whole read runs with microsecond delays inside a critical section,
+//  so timing does not depend on the FreeRTOS tick: a 16 bit SNES read with
+//  the default 6us half period takes about 210us.
+//
+
+#ifndef XNES_H
+#define XNES_H
+
+#include <stdint.h>
+
+#include "driver/gpio.h"
+
+#define XNES_BITS_NES       8
+#define XNES_BITS_SNES      16
+
+#ifndef XNES_MAX_PADS
+#define XNES_MAX_PADS       4
+#endif
+
+#define XNES_LATCH_US       12  // latch pulse width
+#define XNES_HALF_CLOCK_US  6   // 12us clock period, as on the consoles
+
+typedef struct {
+    gpio_num_t latch;
+    gpio_num_t clock;
+    gpio_num_t data[XNES_MAX_PADS];
+    uint8_t pads;               // data lines in use, 1..XNES_MAX_PADS
+    uint8_t bits;               // XNES_BITS_NES or XNES_BITS_SNES, at most 32
+    uint8_t half_clock_us;      // 0 selects XNES_HALF_CLOCK_US
+} xnes_config_t;
+
+void xnes_init(const xnes_config_t *config);
+
+//Reads all pads. Bit i of pressed[pad] is set when the i-th shifted button
+//of that pad is pressed.
+void xnes_read(uint32_t pressed[XNES_MAX_PADS]);
+
+#endif
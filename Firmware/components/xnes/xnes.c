@@ -0,0 +1,81 @@
+//
+//  NES/SNES controller reader
+//
+
+#include <stdbool.h>
+
+#include "freertos/FreeRTOS.h"
+#include "rom/ets_sys.h"
+#include "soc/gpio_struct.h"
+
+#include "xnes.h"
+
+static xnes_config_t xnes_cfg;
+static portMUX_TYPE xnes_mux = portMUX_INITIALIZER_UNLOCKED;
+//data line masks in GPIO.in (GPIO0..31) and GPIO.in1 (GPIO32..39)
+static uint32_t xnes_in_mask[XNES_MAX_PADS];
+static uint32_t xnes_in1_mask[XNES_MAX_PADS];
+static bool xnes_use_in1;
+
+void xnes_init(const xnes_config_t *config)
+{
+    xnes_cfg = *config;
+    if(xnes_cfg.half_clock_us == 0)
+        xnes_cfg.half_clock_us = XNES_HALF_CLOCK_US;
+    if(xnes_cfg.pads == 0)
+        xnes_cfg.pads = 1;
+    if(xnes_cfg.pads > XNES_MAX_PADS)
+        xnes_cfg.pads = XNES_MAX_PADS;
+
+    gpio_reset_pin(xnes_cfg.latch);
+    gpio_set_direction(xnes_cfg.latch, GPIO_MODE_OUTPUT);
+    gpio_reset_pin(xnes_cfg.clock);
+    gpio_set_direction(xnes_cfg.clock, GPIO_MODE_OUTPUT);
+
+    xnes_use_in1 = false;
+    for(int pad = 0; pad < xnes_cfg.pads; pad++)
+    {
+        gpio_num_t data = xnes_cfg.data[pad];
+        gpio_reset_pin(data);
+        gpio_set_direction(data, GPIO_MODE_INPUT);
+        xnes_in_mask[pad] = data < 32 ? 1u << data : 0;
+        xnes_in1_mask[pad] = data < 32 ? 0 : 1u << (data - 32);
+        if(data >= 32)
+            xnes_use_in1 = true;
+    }
+
+    gpio_set_level(xnes_cfg.latch, 0);
+    gpio_set_level(xnes_cfg.clock, 0);
+}
+
+void xnes_read(uint32_t pressed[XNES_MAX_PADS])
+{
+    uint32_t half = xnes_cfg.half_clock_us;
+    int pads = xnes_cfg.pads;
+
+    for(int pad = 0; pad < XNES_MAX_PADS; pad++)
+        pressed[pad] = 0;
+
+    portENTER_CRITICAL(&xnes_mux);
+    gpio_set_level(xnes_cfg.latch, 1);
+    ets_delay_us(XNES_LATCH_US);
+    gpio_set_level(xnes_cfg.latch, 0);
+    //first bit is valid once the latch is released
+    ets_delay_us(half);
+    for(int i = 0; i < xnes_cfg.bits; i++)
+    {
+        //one register read samples every pad on the same edge
+        uint32_t in = GPIO.in;
+        uint32_t in1 = xnes_use_in1 ? GPIO.in1.data : 0;
+        for(int pad = 0; pad < pads; pad++)
+        {
+            if(!(in & xnes_in_mask[pad]) && !(in1 & xnes_in1_mask[pad]))
+                pressed[pad] |= 1u << i;
+        }
+        gpio_set_level(xnes_cfg.clock, 1);
+        ets_delay_us(half);
+        gpio_set_level(xnes_cfg.clock, 0);
+        ets_delay_us(half);
+    }
+    portEXIT_CRITICAL(&xnes_mux);
+}
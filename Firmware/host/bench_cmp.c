@@ -0,0 +1,195 @@
+//
+//  bench_cmp - compares two benchmark runs
+//
+//  Usage: bench_cmp [-t percent] [-k min|med|max] old new
+//
+//  old and new are the output of bench, or monitor logs of a firmware built
+//  with BENCH: only BENCH_LOG_PREFIX lines are read, and of several runs in
+//  one file the last one counts. Prints the chosen figure (-k, default the
+//  median) of every case in both runs and the change in percent.
+//
+//  Exits 1 when a case got slower by more than -t percent (default 5), 2
+//  when a file cannot be read or the runs were taken on different targets
+//  or in different units, so it can gate a build.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+#define MAX_CASES   64
+#define FIELD_LEN   32
+
+enum { KEY_MIN, KEY_MED, KEY_MAX, KEYS };
+static const char *key_name[KEYS] = { "min", "med", "max" };
+
+typedef struct {
+    char name[FIELD_LEN];
+    double value[KEYS];
+} bench_line_t;
+
+typedef struct {
+    char target[FIELD_LEN];
+    char unit[FIELD_LEN];
+    bench_line_t cases[MAX_CASES];
+    int count;
+} bench_file_t;
+
+static void copy_field(char *dst, const char *src)
+{
+    size_t n = strcspn(src, " \t\r\n");
+    if(n >= FIELD_LEN)
+        n = FIELD_LEN - 1;
+    memcpy(dst, src, n);
+    dst[n] = 0;
+}
+
+//Value of key in the key=value fields of line, NULL if it has none
+static const char *field(const char *line, const char *key)
+{
+    size_t len = strlen(key);
+
+    for(const char *p = line; (p = strstr(p, key)) != NULL; p += len)
+    {
+        if((p == line || p[-1] == ' ') && p[len] == '=')
+            return p + len + 1;
+    }
+    return NULL;
+}
+
+static void parse_case(bench_file_t *f, const char *line)
+{
+    bench_line_t c;
+    const char *name = field(line, "case");
+
+    copy_field(c.name, name);
+    for(int k = 0; k < KEYS; k++)
+    {
+        const char *v = field(line, key_name[k]);
+        c.value[k] = v != NULL ? strtod(v, NULL) : 0;
+    }
+    //a case seen again replaces the earlier one
+    for(int i = 0; i < f->count; i++)
+    {
+        if(strcmp(f->cases[i].name, c.name) == 0)
+        {
+            f->cases[i] = c;
+            return;
+        }
+    }
+    if(f->count < MAX_CASES)
+        f->cases[f->count++] = c;
+}
+
+static int read_run(const char *path, bench_file_t *f)
+{
+    char line[512];
+    FILE *in = fopen(path, "r");
+
+    if(in == NULL)
+        return -1;
+    memset(f, 0, sizeof(*f));
+    while(fgets(line, sizeof(line), in) != NULL)
+    {
+        const char *p = strstr(line, BENCH_LOG_PREFIX);
+        if(p == NULL)
+            continue;
+        p += strlen(BENCH_LOG_PREFIX);
+        if(field(p, "case") != NULL)
+            parse_case(f, p);
+        else if(field(p, "unit") != NULL)
+        {
+            //header of a new run
+            f->count = 0;
+            copy_field(f->unit, field(p, "unit"));
+            const char *target = field(p, "target");
+            copy_field(f->target, target != NULL ? target : "");
+        }
+    }
+    fclose(in);
+    return f->unit[0] != 0 ? 0 : -1;
+}
+
+static const bench_line_t *find(const bench_file_t *f, const char *name)
+{
+    for(int i = 0; i < f->count; i++)
+    {
+        if(strcmp(f->cases[i].name, name) == 0)
+            return &f->cases[i];
+    }
+    return NULL;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: bench_cmp [-t percent] [-k min|med|max] old new\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    static bench_file_t old_run, new_run;
+    double threshold = 5;
+    int key = KEY_MED;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:k:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': threshold = atof(optarg); break;
+            case 'k':
+                for(key = 0; key < KEYS && strcmp(optarg, key_name[key]) != 0; key++)
+                    ;
+                if(key == KEYS)
+                    usage();
+                break;
+            default: usage();
+        }
+    }
+    if(optind != argc - 2)
+        usage();
+    const char *old_path = argv[optind];
+    const char *new_path = argv[optind + 1];
+    if(read_run(old_path, &old_run) != 0 || read_run(new_path, &new_run) != 0)
+    {
+        fprintf(stderr, "bench_cmp: no %s run in %s\n", BENCH_LOG_PREFIX,
+            old_run.unit[0] == 0 ? old_path : new_path);
+        return 2;
+    }
+    if(strcmp(old_run.target, new_run.target) != 0 || strcmp(old_run.unit, new_run.unit) != 0)
+    {
+        fprintf(stderr, "bench_cmp: %s in %s against %s in %s, not comparable\n",
+            old_run.target, old_run.unit, new_run.target, new_run.unit);
+        return 2;
+    }
+
+    int slower = 0;
+    printf("%-20s %12s %12s %8s   %s %s\n", "case", "old", "new", "change", key_name[key], new_run.unit);
+    for(int i = 0; i < new_run.count; i++)
+    {
+        const bench_line_t *n = &new_run.cases[i];
+        const bench_line_t *o = find(&old_run, n->name);
+        if(o == NULL)
+        {
+            printf("%-20s %12s %12.1f %8s\n", n->name, "-", n->value[key], "new");
+            continue;
+        }
+        double change = o->value[key] > 0 ? (n->value[key] - o->value[key]) * 100 / o->value[key] : 0;
+        int worse = change > threshold;
+        slower += worse;
+        printf("%-20s %12.1f %12.1f %+7.1f%%%s\n", n->name, o->value[key], n->value[key], change,
+            worse ? "   slower" : change < -threshold ? "   faster" : "");
+    }
+    for(int i = 0; i < old_run.count; i++)
+    {
+        if(find(&new_run, old_run.cases[i].name) == NULL)
+            printf("%-20s %12.1f %12s %8s\n", old_run.cases[i].name, old_run.cases[i].value[key], "-", "gone");
+    }
+    if(slower > 0)
+        printf("%d of %d cases slower by more than %.1f%%\n", slower, new_run.count, threshold);
+    return slower > 0 ? 1 : 0;
+}
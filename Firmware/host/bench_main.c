@@ -0,0 +1,77 @@
+//
+//  bench - the firmware microbenchmarks on the host
+//
+//  Usage: bench [-l] [-r rounds] [-n iters] [case...]
+//
+//  Runs the cases of components/bench, all of them or the ones named, and
+//  prints the same BENCH_LOG_PREFIX lines as a firmware built with BENCH,
+//  in ns instead of cycles. -l lists the cases.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "bench.h"
+
+static const bench_case_t *find_case(const char *name)
+{
+    for(uint32_t i = 0; i < bench_case_count; i++)
+    {
+        if(strcmp(bench_cases[i].name, name) == 0)
+            return &bench_cases[i];
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t rounds = BENCH_ROUNDS;
+    uint32_t iters = BENCH_ITERS;
+    bench_result_t result;
+    int opt;
+
+    while((opt = getopt(argc, argv, "lr:n:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l':
+                for(uint32_t i = 0; i < bench_case_count; i++)
+                    printf("%s\n", bench_cases[i].name);
+                return 0;
+            case 'r': rounds = strtoul(optarg, NULL, 0); break;
+            case 'n': iters = strtoul(optarg, NULL, 0); break;
+            default:
+                fprintf(stderr, "usage: bench [-l] [-r rounds] [-n iters] [case...]\n");
+                return 2;
+        }
+    }
+    if(rounds == 0 || rounds > BENCH_ROUNDS_MAX || iters == 0)
+    {
+        fprintf(stderr, "bench: rounds 1..%u, iters at least 1\n", BENCH_ROUNDS_MAX);
+        return 2;
+    }
+    for(int i = optind; i < argc; i++)
+    {
+        if(find_case(argv[i]) == NULL)
+        {
+            fprintf(stderr, "bench: no case %s, -l lists them\n", argv[i]);
+            return 2;
+        }
+    }
+
+    bench_print_header(rounds, iters);
+    for(uint32_t i = 0; i < bench_case_count; i++)
+    {
+        int wanted = optind == argc;
+        for(int a = optind; a < argc && !wanted; a++)
+            wanted = strcmp(argv[a], bench_cases[i].name) == 0;
+        if(!wanted)
+            continue;
+        bench_run(&bench_cases[i], rounds, iters, &result);
+        bench_print(&result);
+    }
+    bench_print_end();
+    return 0;
+}
@@ -0,0 +1,31 @@
+//
+//  Fuzzing harnesses for the host build
+//
+//  Each fuzz_*.c defines the libFuzzer entry points. Built with clang and
+//  -fsanitize=fuzzer they run under libFuzzer, built with any other
+//  compiler they are linked with replay.c, which runs the corpus and random
+//  mutations of it. A harness reports a broken invariant with FUZZ_CHECK(),
+//  which aborts like a sanitizer finding does.
+//
+
+#ifndef FUZZ_H
+#define FUZZ_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+int LLVMFuzzerInitialize(int *argc, char ***argv);
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+#define FUZZ_CHECK(cond, ...) do { \
+        if(!(cond)) { \
+            fprintf(stderr, "fuzz: %s:%d: ", __FILE__, __LINE__); \
+            fprintf(stderr, __VA_ARGS__); \
+            fprintf(stderr, "\n"); \
+            abort(); \
+        } \
+    } while(0)
+
+#endif
@@ -0,0 +1,94 @@
+//
+//  fuzz_joybus - RMT RX frames into the Joybus link and frame decoders
+//
+//  Input: one configuration byte, then transfers until the input ends.
+//
+//    config    bit 0 N64 link, bits 1..3 GameCube analog mode,
+//              bits 4..5 link state to start in (3 is POLL too)
+//    transfer  item count, 0 for a timeout, then that many RMT items,
+//              4 bytes little endian each
+//
+//  The items are written to the start of a JOYBUS_RX_MAX_ITEMS buffer that
+//  plays the RX channel memory: like on the device, whatever a longer
+//  earlier frame left behind the new one stays there. Each transfer goes
+//  through joybus_link_result() as the poller hands it over.
+//
+//  Checked on top of the sanitizers: a status word is only taken from a
+//  frame that holds all of it, and the N64 decoder agrees with the generic
+//  response decoder.
+//
+
+#include <string.h>
+
+#include "gc_frame.h"
+#include "joybus_capture.h"
+#include "joybus_link.h"
+#include "n64_frame.h"
+
+#include "fuzz.h"
+
+#define CONFIG_N64          0x01
+#define CONFIG_MODE(c)      (((c) >> 1) & 0x07)
+#define CONFIG_STATE(c)     (((c) >> 4) & 0x03)
+
+static uint32_t rx_mem[JOYBUS_RX_MAX_ITEMS];
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    return 0;
+}
+
+//The N64 status the link took must also pass the generic decoder
+static void check_n64(const joybus_link_t *link, const uint32_t *rx, uint16_t rx_items, const uint8_t *status)
+{
+    uint8_t generic[JOYBUS_RESPONSE_MAX_LEN];
+
+    FUZZ_CHECK(rx_items > N64_FRAME_ITEMS, "N64 status from a %u item frame", (unsigned)rx_items);
+    FUZZ_CHECK(joybus_response_decode(&link->poll, rx, rx_items, generic),
+        "N64 frame only accepted by n64_frame_decode()");
+    FUZZ_CHECK(memcmp(status, generic, N64_STATUS_LEN) == 0, "N64 decoders disagree");
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    joybus_link_t link;
+    uint8_t response[JOYBUS_RESPONSE_MAX_LEN];
+
+    if(size == 0)
+        return 0;
+    uint8_t config = data[0];
+    if(config & CONFIG_N64)
+        joybus_link_init_n64(&link);
+    else
+        joybus_link_init(&link, CONFIG_MODE(config), GC_RUMBLE_OFF);
+    switch(CONFIG_STATE(config))
+    {
+        case 0: link.state = JOYBUS_LINK_PROBE; break;
+        case 1: link.state = JOYBUS_LINK_ORIGIN; break;
+        default: link.state = JOYBUS_LINK_POLL; break;
+    }
+    memset(rx_mem, 0, sizeof(rx_mem));
+
+    size_t pos = 1;
+    while(pos < size)
+    {
+        uint8_t count = data[pos++];
+        const uint32_t *rx = NULL;
+        if(count > 0)
+        {
+            for(int i = 0; i < count && pos + 4 <= size; i++, pos += 4)
+                rx_mem[i] = data[pos] | data[pos + 1] << 8 | data[pos + 2] << 16 | (uint32_t)data[pos + 3] << 24;
+            rx = rx_mem;
+        }
+        uint16_t rx_items = rx != NULL ? joybus_frame_len(rx, JOYBUS_RX_MAX_ITEMS) : 0;
+
+        memset(response, 0, sizeof(response));
+        joybus_link_event_t event = joybus_link_result(&link, rx, response);
+        if(event == JOYBUS_LINK_STATUS && link.n64)
+            check_n64(&link, rx, rx_items, response);
+        else if(event == JOYBUS_LINK_STATUS)
+            FUZZ_CHECK(rx_items > GC_FRAME_ITEMS, "GameCube status from a %u item frame", (unsigned)rx_items);
+        FUZZ_CHECK(link.misses <= JOYBUS_LINK_MISS_MAX, "%u misses", link.misses);
+    }
+    return 0;
+}
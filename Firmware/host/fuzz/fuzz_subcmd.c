@@ -0,0 +1,111 @@
+//
+//  fuzz_subcmd - output reports into intr_data_cb() and the subcommand table
+//
+//  Runs BlueCubeModv2 on the sim stand-ins (sim/sim.h), connected to the
+//  virtual host, and hands every input to the firmware's intr_data_cb() as
+//  an output report of exactly that length, then to
+//  switch_subcmd_dispatch() directly so the handlers also see lengths other
+//  than 49. Each input is copied to a buffer of its own size first, so the
+//  sanitizers catch any read past the end of the report.
+//
+//  Checked on top of the sanitizers: every dispatched output report 0x01
+//  is answered by exactly one 0x21 reply of SWITCH_REPLY_LEN bytes that
+//  echoes its subcommand, any other report id by none.
+//
+
+#include <string.h>
+
+#include "switch_subcmd.h"
+
+#include "fuzz.h"
+#include "sim.h"
+
+#define STARTUP_TIMEOUT_MS  5000
+#define CONNECT_DELAY_MS    100
+#define FIRMWARE_REPORT_LEN 49      // intr_data_cb() only dispatches this length
+
+void app_main(void);
+void intr_data_cb(uint8_t report_id, uint16_t len, uint8_t *p_data);
+
+static pthread_mutex_t reply_lock = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t replies;
+static uint16_t reply_len;
+static uint8_t reply_subcmd;
+
+static void on_report(uint8_t report_id, const uint8_t *data, uint16_t len, int64_t time_us)
+{
+    if(report_id != 0x21)
+        return;
+    pthread_mutex_lock(&reply_lock);
+    replies++;
+    reply_len = len;
+    reply_subcmd = len > SWITCH_REPLY_SUBCMD ? data[SWITCH_REPLY_SUBCMD] : 0;
+    pthread_mutex_unlock(&reply_lock);
+}
+
+static uint32_t reply_count(void)
+{
+    pthread_mutex_lock(&reply_lock);
+    uint32_t n = replies;
+    pthread_mutex_unlock(&reply_lock);
+    return n;
+}
+
+static void check_reply(uint32_t before, const uint8_t *p_data, uint16_t len)
+{
+    uint8_t subcmd = len > SWITCH_SUBCMD_OFFSET ? p_data[SWITCH_SUBCMD_OFFSET] : 0;
+
+    pthread_mutex_lock(&reply_lock);
+    uint32_t n = replies - before;
+    if(p_data[0] != SWITCH_OUTPUT_SUBCMD)
+    {
+        pthread_mutex_unlock(&reply_lock);
+        FUZZ_CHECK(n == 0, "%u replies to a report %02x", (unsigned)n, p_data[0]);
+        return;
+    }
+    uint16_t rlen = reply_len;
+    uint8_t echoed = reply_subcmd;
+    pthread_mutex_unlock(&reply_lock);
+    FUZZ_CHECK(n == 1, "%u replies to a %u byte report", (unsigned)n, (unsigned)len);
+    FUZZ_CHECK(rlen == SWITCH_REPLY_LEN, "reply of %u bytes", (unsigned)rlen);
+    FUZZ_CHECK(echoed == subcmd, "reply echoes %02x for subcommand %02x", echoed, subcmd);
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv)
+{
+    sim_pad_plug(true);
+    sim_bt_set_report_cb(on_report);
+    sim_start(app_main);
+    if(!sim_bt_wait_connectable(STARTUP_TIMEOUT_MS))
+    {
+        fprintf(stderr, "fuzz: firmware did not become connectable\n");
+        exit(1);
+    }
+    sim_sleep_until(sim_time_us() + CONNECT_DELAY_MS * 1000);
+    sim_bt_connect();
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if(size == 0 || size > UINT16_MAX)
+        return 0;
+    //the stack hands the callback a buffer it may write to
+    uint8_t *report = malloc(size);
+    memcpy(report, data, size);
+
+    uint32_t before = reply_count();
+    intr_data_cb(report[0], size, report);
+    if(size == FIRMWARE_REPORT_LEN)
+        check_reply(before, report, size);
+    else
+        FUZZ_CHECK(reply_count() == before, "reply to a %u byte report", (unsigned)size);
+
+    memcpy(report, data, size);
+    before = reply_count();
+    switch_subcmd_dispatch(report, size);
+    check_reply(before, report, size);
+
+    free(report);
+    return 0;
+}
@@ -0,0 +1,271 @@
+//
+//  replay - runs a fuzzing harness without libFuzzer
+//
+//  Usage:
+//    fuzz_<name> [-r runs] [-s seed] [-m max_len] corpus...
+//
+//  Runs every file given, and every file in the directories given, through
+//  LLVMFuzzerTestOneInput(). -r then runs that many random mutations of the
+//  corpus (bit flips, byte changes, inserts, erases, copies). The input
+//  being run when a sanitizer or FUZZ_CHECK() aborts is written to
+//  crash-replay, so it can be run again and added to the corpus. The
+//  slowest inputs are reported at the end.
+//
+//  This is no coverage guided fuzzer, it is meant for replaying corpora
+//  and crashes with the native compiler and catching regressions in CI.
+//
+
+#include <dirent.h>
+#include <getopt.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __SANITIZE_ADDRESS__
+#include <sanitizer/common_interface_defs.h>
+#endif
+
+#include "host_util.h"
+#include "fuzz.h"
+
+#define CRASH_FILE      "crash-replay"
+#define MAX_INPUTS      4096
+#define SLOWEST         5
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+} input_t;
+
+typedef struct {
+    uint64_t ns;
+    uint8_t *data;
+    size_t len;
+} slow_t;
+
+static input_t corpus[MAX_INPUTS];
+static size_t corpus_count;
+
+//input of the run in progress, for the crash handler
+static const uint8_t *volatile current;
+static volatile size_t current_len;
+
+static slow_t slowest[SLOWEST];
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+static void save_current(void)
+{
+    if(current != NULL)
+    {
+        FILE *f = fopen(CRASH_FILE, "wb");
+        if(f != NULL)
+        {
+            fwrite((const void *)current, 1, current_len, f);
+            fclose(f);
+            fprintf(stderr, "replay: input written to %s (%u bytes)\n", CRASH_FILE, (unsigned)current_len);
+        }
+        current = NULL;
+    }
+}
+
+static void on_crash(int sig)
+{
+    save_current();
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+
+static void add_file(const char *path)
+{
+    size_t len;
+    uint8_t *data = host_read_file(path, &len);
+
+    if(data == NULL)
+        return;
+    if(corpus_count == MAX_INPUTS)
+    {
+        free(data);
+        return;
+    }
+    corpus[corpus_count].data = data;
+    corpus[corpus_count].len = len;
+    corpus_count++;
+}
+
+static void add_path(const char *path)
+{
+    struct stat st;
+    char name[4096];
+
+    if(stat(path, &st) != 0)
+    {
+        fprintf(stderr, "replay: cannot open %s\n", path);
+        exit(1);
+    }
+    if(!S_ISDIR(st.st_mode))
+    {
+        add_file(path);
+        return;
+    }
+    DIR *dir = opendir(path);
+    struct dirent *e;
+    while(dir != NULL && (e = readdir(dir)) != NULL)
+    {
+        if(e->d_name[0] == '.')
+            continue;
+        snprintf(name, sizeof(name), "%s/%s", path, e->d_name);
+        if(stat(name, &st) == 0 && S_ISREG(st.st_mode))
+            add_file(name);
+    }
+    if(dir != NULL)
+        closedir(dir);
+}
+
+static void run(const uint8_t *data, size_t len)
+{
+    //exact size, so reads past the end are caught
+    uint8_t *exact = malloc(len > 0 ? len : 1);
+
+    memcpy(exact, data, len);
+    current_len = len;
+    current = exact;
+    uint64_t start = host_now_ns();
+    LLVMFuzzerTestOneInput(exact, len);
+    uint64_t ns = host_now_ns() - start;
+    current = NULL;
+    free(exact);
+
+    //keep the SLOWEST slowest, slowest first
+    if(ns <= slowest[SLOWEST - 1].ns)
+        return;
+    free(slowest[SLOWEST - 1].data);
+    int i = SLOWEST - 1;
+    for(; i > 0 && slowest[i - 1].ns < ns; i--)
+        slowest[i] = slowest[i - 1];
+    slowest[i].ns = ns;
+    slowest[i].data = malloc(len > 0 ? len : 1);
+    memcpy(slowest[i].data, data, len);
+    slowest[i].len = len;
+}
+
+static size_t mutate(uint32_t *seed, uint8_t *buf, size_t len, size_t max_len)
+{
+    int changes = 1 + xorshift(seed) % 4;
+
+    for(int c = 0; c < changes; c++)
+    {
+        size_t pos = len > 0 ? xorshift(seed) % len : 0;
+        switch(xorshift(seed) % 5)
+        {
+            case 0:     // flip a bit
+                if(len > 0)
+                    buf[pos] ^= 1 << (xorshift(seed) % 8);
+                break;
+            case 1:     // random byte
+                if(len > 0)
+                    buf[pos] = xorshift(seed);
+                break;
+            case 2:     // insert a byte
+                if(len < max_len)
+                {
+                    memmove(&buf[pos + 1], &buf[pos], len - pos);
+                    buf[pos] = xorshift(seed);
+                    len++;
+                }
+                break;
+            case 3:     // erase a run
+                if(len > 0)
+                {
+                    size_t n = 1 + xorshift(seed) % (len - pos < 16 ? len - pos : 16);
+                    memmove(&buf[pos], &buf[pos + n], len - pos - n);
+                    len -= n;
+                }
+                break;
+            default:    // copy a run over another place
+                if(len > 1)
+                {
+                    size_t from = xorshift(seed) % len;
+                    size_t n = 1 + xorshift(seed) % (len - (from > pos ? from : pos));
+                    memmove(&buf[pos], &buf[from], n);
+                }
+                break;
+        }
+    }
+    return len;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: fuzz_<name> [-r runs] [-s seed] [-m max_len] corpus...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    long runs = 0;
+    uint32_t seed = 1;
+    size_t max_len = 4096;
+    int opt;
+
+    while((opt = getopt(argc, argv, "r:s:m:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'r': runs = atol(optarg); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            case 'm': max_len = strtoul(optarg, NULL, 0); break;
+            default: usage();
+        }
+    }
+    if(optind >= argc || seed == 0 || max_len == 0)
+        usage();
+
+    LLVMFuzzerInitialize(&argc, &argv);
+#ifdef __SANITIZE_ADDRESS__
+    //sanitizer reports end in _exit(), not in a signal
+    __sanitizer_set_death_callback(save_current);
+#endif
+    signal(SIGABRT, on_crash);
+    signal(SIGSEGV, on_crash);
+    signal(SIGBUS, on_crash);
+    signal(SIGFPE, on_crash);
+
+    for(int i = optind; i < argc; i++)
+        add_path(argv[i]);
+    if(corpus_count == 0)
+    {
+        fprintf(stderr, "replay: empty corpus\n");
+        return 1;
+    }
+    for(size_t i = 0; i < corpus_count; i++)
+        run(corpus[i].data, corpus[i].len);
+    printf("replay: %u corpus inputs ok\n", (unsigned)corpus_count);
+
+    uint8_t *buf = malloc(max_len);
+    for(long r = 0; r < runs; r++)
+    {
+        const input_t *in = &corpus[xorshift(&seed) % corpus_count];
+        size_t len = in->len < max_len ? in->len : max_len;
+        memcpy(buf, in->data, len);
+        len = mutate(&seed, buf, len, max_len);
+        run(buf, len);
+    }
+    if(runs > 0)
+        printf("replay: %ld mutations ok\n", runs);
+
+    for(int i = 0; i < SLOWEST && slowest[i].data != NULL; i++)
+        printf("replay: slow input %u bytes %.1fus\n", (unsigned)slowest[i].len, slowest[i].ns / 1000.0);
+    free(buf);
+    fflush(stdout);
+    //harnesses may leave threads running
+    exit(0);
+}
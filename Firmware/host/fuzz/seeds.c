@@ -0,0 +1,318 @@
+//
+//  fuzz_seeds - writes the seed corpus of the fuzzing harnesses
+//
+//  Usage:
+//    fuzz_seeds [-l] [-c capture]... [-t trace]... dir
+//
+//  Writes dir/subcmd for fuzz_subcmd and dir/joybus for fuzz_joybus. The
+//  built-in seeds are the console's pairing packets (switch_pairing.c),
+//  SPI flash writes and rumble-only reports, and Joybus transfers as the
+//  pads answer them: identify, origin and polls in every analog mode,
+//  N64 identify and polls, unplugged pads and a poll cut short behind a
+//  longer frame.
+//
+//  Recorded traffic is added on top: -c takes Joybus captures (GC_CAPTURE
+//  or N64_CAPTURE, see gc_replay), every frame becomes one poll seed; -t
+//  takes HID traces (HID_TRACE, see hid_trace), every output report
+//  becomes one subcommand seed. -l reads both from serial monitor logs.
+//
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "gc_frame.h"
+#include "hid_trace.h"
+#include "joybus_capture.h"
+#include "joybus_cmd.h"
+#include "joybus_link.h"
+#include "n64_frame.h"
+#include "switch_pairing.h"
+#include "switch_subcmd.h"
+#include "gc_synth.h"
+#include "host_util.h"
+
+#define CONFIG_N64          0x01
+#define CONFIG_MODE(m)      ((m) << 1)
+#define CONFIG_PROBE        0x00
+#define CONFIG_ORIGIN       0x10
+#define CONFIG_POLL         0x20
+
+#define MAX_TRANSFER_ITEMS  255     // one count byte per transfer
+
+typedef struct {
+    uint8_t buf[8192];
+    size_t len;
+} seed_t;
+
+static const char *out_dir;
+static uint32_t written;
+
+static void write_seed(const char *sub, const char *name, const uint8_t *data, size_t len)
+{
+    char path[4096];
+
+    snprintf(path, sizeof(path), "%s/%s/%s", out_dir, sub, name);
+    if(host_write_file(path, data, len) != 0)
+    {
+        fprintf(stderr, "fuzz_seeds: cannot write %s\n", path);
+        exit(1);
+    }
+    written++;
+}
+
+//
+//  Subcommand seeds
+//
+
+static void subcmd_seeds(void)
+{
+    uint8_t out[SWITCH_OUTPUT_LEN];
+    char name[64];
+
+    for(size_t i = 0; i < switch_pairing_count; i++)
+    {
+        switch_pairing_packet(&switch_pairing[i], i, out);
+        snprintf(name, sizeof(name), "pair-%02u-%02x", (unsigned)i, switch_pairing[i].subcmd);
+        write_seed("subcmd", name, out, sizeof(out));
+    }
+
+    //user stick calibration write, and one whose end wraps past 4 GB
+    static const switch_pairing_req_t spi_write = { SWITCH_SUBCMD_SPI_WRITE, 5, { 0x10, 0x80, 0, 0, 0x16 }, 0, "" };
+    switch_pairing_packet(&spi_write, 0, out);
+    for(int i = 0; i < 0x16; i++)
+        out[SWITCH_SUBCMD_ARG + 5 + i] = 0x80 + i;
+    write_seed("subcmd", "spi-write-user", out, sizeof(out));
+    out[SWITCH_SUBCMD_ARG] = 0xF0;
+    out[SWITCH_SUBCMD_ARG + 1] = 0xFF;
+    out[SWITCH_SUBCMD_ARG + 2] = 0xFF;
+    out[SWITCH_SUBCMD_ARG + 3] = 0xFF;
+    out[SWITCH_SUBCMD_ARG + 4] = 0x20;
+    write_seed("subcmd", "spi-write-wrap", out, sizeof(out));
+
+    //rumble only, sent in between subcommands
+    switch_pairing_packet(&switch_pairing[0], 1, out);
+    out[0] = 0x10;
+    write_seed("subcmd", "rumble", out, SWITCH_SUBCMD_OFFSET);
+    //full length with a subcommand id in it, must not be answered either
+    write_seed("subcmd", "rumble-49", out, sizeof(out));
+    //a subcommand cut short right after its id
+    switch_pairing_packet(&switch_pairing[2], 2, out);
+    write_seed("subcmd", "spi-read-short", out, SWITCH_SUBCMD_ARG + 2);
+}
+
+static void add_trace(const uint8_t *buf, size_t len, void *arg)
+{
+    static hid_trace_reader_t rd;
+    hid_trace_record_t rec;
+    char name[64];
+    uint32_t *count = arg;
+
+    if(!hid_trace_open(&rd, buf, len))
+        return;
+    while(hid_trace_next(&rd, &rec) > 0)
+    {
+        if(rec.dir != HID_TRACE_OUTPUT)
+            continue;
+        snprintf(name, sizeof(name), "trace-%04u", (unsigned)(*count)++);
+        write_seed("subcmd", name, rec.data, rec.len);
+    }
+}
+
+//
+//  Joybus seeds
+//
+
+static uint32_t *put_byte(uint32_t *p, uint8_t b)
+{
+    for(int bit = 7; bit >= 0; bit--)
+        *p++ = (b >> bit) & 1 ? JOYBUS_ITEM_ONE : JOYBUS_ITEM_ZERO;
+    return p;
+}
+
+static void seed_begin(seed_t *s, uint8_t config)
+{
+    s->buf[0] = config;
+    s->len = 1;
+}
+
+static void seed_items(seed_t *s, const uint32_t *items, uint16_t count)
+{
+    if(count > MAX_TRANSFER_ITEMS)
+        count = MAX_TRANSFER_ITEMS;
+    s->buf[s->len++] = count;
+    for(int i = 0; i < count; i++, s->len += 4)
+    {
+        s->buf[s->len] = items[i];
+        s->buf[s->len + 1] = items[i] >> 8;
+        s->buf[s->len + 2] = items[i] >> 16;
+        s->buf[s->len + 3] = items[i] >> 24;
+    }
+}
+
+static void seed_timeout(seed_t *s)
+{
+    s->buf[s->len++] = 0;
+}
+
+//RX frame of a transfer: command echo, stop bit, response, stop bit, idle
+static void seed_transfer(seed_t *s, joybus_cmd_id_t id, const uint8_t *response, uint8_t response_len)
+{
+    const joybus_cmd_t *cmd = &joybus_cmds[id];
+    uint32_t items[(JOYBUS_CMD_MAX_LEN + JOYBUS_RESPONSE_MAX_LEN) * 8 + 2];
+    uint32_t *p = items;
+
+    for(int i = 0; i < cmd->len; i++)
+        p = put_byte(p, cmd->bytes[i]);
+    *p++ = JOYBUS_ITEM(1, 5);
+    for(int i = 0; i < response_len; i++)
+        p = put_byte(p, response[i]);
+    *p++ = JOYBUS_ITEM(1, 0);
+    seed_items(s, items, p - items);
+}
+
+static void joybus_seeds(void)
+{
+    static const uint8_t gc_identify[] = { 0x09, 0x00, 0x03 };
+    static const uint8_t gc_origin[] = { 0x00, 0x80, 0x80, 0x80, 0x80, 0x80, 0x1F, 0x1F, 0x00, 0x00 };
+    static const uint8_t n64_identify[] = { 0x05, 0x00, JOYBUS_N64_PAK_ABSENT };
+    static const uint8_t n64_poll[] = { 0x90, 0x00, 0x20, 0xE0 };   // A, Start, stick right and down
+    uint32_t seed = 0x4A425553;
+    uint8_t status[GC_STATUS_LEN];
+    seed_t s;
+    char name[64];
+
+    //plugged in, answered, polled, unplugged: every link state once
+    for(uint8_t mode = 0; mode < GC_ANALOG_MODES; mode++)
+    {
+        seed_begin(&s, CONFIG_MODE(mode) | CONFIG_PROBE);
+        seed_transfer(&s, JOYBUS_IDENTIFY, gc_identify, sizeof(gc_identify));
+        seed_transfer(&s, JOYBUS_ORIGIN, gc_origin, sizeof(gc_origin));
+        for(int i = 0; i < 4; i++)
+        {
+            gc_synth_random_status(&seed, status);
+            seed_transfer(&s, JOYBUS_POLL, status, sizeof(status));
+        }
+        for(int i = 0; i < JOYBUS_LINK_MISS_MAX; i++)
+            seed_timeout(&s);
+        snprintf(name, sizeof(name), "gc-mode%u", mode);
+        write_seed("joybus", name, s.buf, s.len);
+    }
+
+    //a poll that ends early leaves the tail of the previous frame in RX memory
+    seed_begin(&s, CONFIG_MODE(GC_ANALOG_MODE_DEFAULT) | CONFIG_POLL);
+    gc_synth_random_status(&seed, status);
+    seed_transfer(&s, JOYBUS_POLL, status, sizeof(status));
+    seed_transfer(&s, JOYBUS_POLL, status, 4);
+    write_seed("joybus", "gc-poll-short", s.buf, s.len);
+
+    seed_begin(&s, CONFIG_N64 | CONFIG_PROBE);
+    seed_transfer(&s, JOYBUS_IDENTIFY, n64_identify, sizeof(n64_identify));
+    seed_transfer(&s, JOYBUS_N64_POLL, n64_poll, sizeof(n64_poll));
+    seed_transfer(&s, JOYBUS_N64_POLL, n64_poll, 2);
+    for(int i = 0; i < JOYBUS_LINK_MISS_MAX; i++)
+        seed_timeout(&s);
+    write_seed("joybus", "n64", s.buf, s.len);
+}
+
+static void add_capture(const uint8_t *buf, size_t len, void *arg)
+{
+    joybus_capture_reader_t rd;
+    uint32_t items[JOYBUS_RX_MAX_ITEMS];
+    uint32_t ts;
+    int n;
+    uint32_t *count = arg;
+    seed_t s;
+    char name[64];
+
+    if(!joybus_capture_open(&rd, buf, len))
+        return;
+    while((n = joybus_capture_next(&rd, &ts, items, JOYBUS_RX_MAX_ITEMS)) > 0)
+    {
+        //GameCube polls are 90 items, N64 polls 42
+        uint8_t config = n > N64_FRAME_ITEMS + 1 ? CONFIG_MODE(GC_ANALOG_MODE_DEFAULT) | CONFIG_POLL
+                                                : CONFIG_N64 | CONFIG_POLL;
+        seed_begin(&s, config);
+        seed_items(&s, items, n);
+        snprintf(name, sizeof(name), "capture-%04u", (unsigned)(*count)++);
+        write_seed("joybus", name, s.buf, s.len);
+    }
+}
+
+static void add_files(char **paths, int count, int from_log, const char *prefix,
+                      void (*add)(const uint8_t *, size_t, void *), uint32_t *seeds)
+{
+    for(int i = 0; i < count; i++)
+    {
+        if(from_log)
+        {
+            if(host_read_log(paths[i], prefix, add, seeds) < 0)
+                fprintf(stderr, "fuzz_seeds: cannot read %s\n", paths[i]);
+            continue;
+        }
+        size_t len;
+        uint8_t *buf = host_read_file(paths[i], &len);
+        if(buf == NULL)
+        {
+            fprintf(stderr, "fuzz_seeds: cannot read %s\n", paths[i]);
+            continue;
+        }
+        add(buf, len, seeds);
+        free(buf);
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: fuzz_seeds [-l] [-c capture]... [-t trace]... dir\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    char *captures[64];
+    char *traces[64];
+    int capture_count = 0;
+    int trace_count = 0;
+    int from_log = 0;
+    uint32_t captured = 0;
+    uint32_t traced = 0;
+    char path[4096];
+    int opt;
+
+    while((opt = getopt(argc, argv, "lc:t:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l': from_log = 1; break;
+            case 'c':
+                if(capture_count < 64)
+                    captures[capture_count++] = optarg;
+                break;
+            case 't':
+                if(trace_count < 64)
+                    traces[trace_count++] = optarg;
+                break;
+            default: usage();
+        }
+    }
+    if(optind != argc - 1)
+        usage();
+    out_dir = argv[optind];
+
+    mkdir(out_dir, 0755);
+    snprintf(path, sizeof(path), "%s/subcmd", out_dir);
+    mkdir(path, 0755);
+    snprintf(path, sizeof(path), "%s/joybus", out_dir);
+    mkdir(path, 0755);
+
+    subcmd_seeds();
+    joybus_seeds();
+    add_files(captures, capture_count, from_log, JOYBUS_CAPTURE_LOG_PREFIX, add_capture, &captured);
+    add_files(traces, trace_count, from_log, HID_TRACE_LOG_PREFIX, add_trace, &traced);
+    printf("fuzz_seeds: %u seeds in %s, %u from captures, %u from traces\n",
+        (unsigned)written, out_dir, (unsigned)captured, (unsigned)traced);
+    return 0;
+}
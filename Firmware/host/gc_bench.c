@@ -0,0 +1,107 @@
+//
+//  gc_bench - cycles per frame of the GameCube frame decoder
+//
+//  Usage: gc_bench [-f frames] [-n repeat] [-i invalid_percent]
+//
+//  Decodes the same set of synthetic frames with the firmware decoder and
+//  with the original pow() based one, checks that both agree and prints the
+//  cost of each. Cycles come from the TSC on x86, elsewhere only ns/frame is
+//  reported.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gc_frame.h"
+#include "gc_frame_ref.h"
+#include "gc_synth.h"
+#include "host_util.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_CYCLES 1
+static uint64_t cycles(void) { return __rdtsc(); }
+#else
+#define HAVE_CYCLES 0
+static uint64_t cycles(void) { return 0; }
+#endif
+
+typedef bool (*decode_fn)(const uint32_t *items, uint8_t status[GC_STATUS_LEN]);
+
+static void run(const char *name, decode_fn decode, const uint32_t *frames, size_t count, long repeat)
+{
+    volatile uint8_t sink = 0;
+    uint8_t status[GC_STATUS_LEN];
+
+    uint64_t c0 = cycles();
+    uint64_t t0 = host_now_ns();
+    for(long r = 0; r < repeat; r++)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            if(decode(frames + i * GC_SYNTH_FRAME_ITEMS, status))
+                sink ^= status[GC_BYTE_LX];
+        }
+    }
+    uint64_t t1 = host_now_ns();
+    uint64_t c1 = cycles();
+
+    double n = (double)count * repeat;
+    printf("%-10s %8.1f ns/frame", name, (t1 - t0) / n);
+    if(HAVE_CYCLES)
+        printf(" %8.1f cycles/frame", (c1 - c0) / n);
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    long count = 10000;
+    long repeat = 100;
+    int invalid_pct = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "f:n:i:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'f': count = atol(optarg); break;
+            case 'n': repeat = atol(optarg); break;
+            case 'i': invalid_pct = atoi(optarg); break;
+            default:
+                fprintf(stderr, "usage: gc_bench [-f frames] [-n repeat] [-i invalid_percent]\n");
+                return 2;
+        }
+    }
+
+    uint32_t *frames = calloc(count, GC_SYNTH_FRAME_ITEMS * sizeof(uint32_t));
+    uint32_t seed = 0xC0FFEE;
+    uint8_t status[GC_STATUS_LEN];
+    for(long i = 0; i < count; i++)
+    {
+        uint32_t *items = frames + i * GC_SYNTH_FRAME_ITEMS;
+        gc_synth_random_status(&seed, status);
+        gc_synth_frame(status, items);
+        //a failed read: controller missing or frame damaged
+        if((long)(seed % 100) < invalid_pct)
+            items[GC_RESPONSE_FIRST + 2] = 0;
+    }
+
+    size_t mismatch = 0;
+    for(long i = 0; i < count; i++)
+    {
+        uint8_t a[GC_STATUS_LEN] = {0};
+        uint8_t b[GC_STATUS_LEN] = {0};
+        bool ok_a = gc_frame_decode(frames + i * GC_SYNTH_FRAME_ITEMS, a);
+        bool ok_b = gc_frame_decode_ref(frames + i * GC_SYNTH_FRAME_ITEMS, b);
+        if(ok_a != ok_b || memcmp(a, b, sizeof(a)) != 0)
+            mismatch++;
+    }
+
+    printf("%ld frames x %ld, %d%% invalid, %zu mismatches\n", count, repeat, invalid_pct, mismatch);
+    run("gc_frame", gc_frame_decode, frames, count, repeat);
+    run("reference", gc_frame_decode_ref, frames, count, repeat);
+    free(frames);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,65 @@
+//
+//  Reference GameCube frame decoder
+//
+//  The original per-axis pow() loops, kept for the host tools to check the
+//  firmware decoder against and to benchmark it. Do not use on the device.
+//
+
+#include <math.h>
+
+#include "gc_frame_ref.h"
+
+static bool gc_item_is_one(const uint32_t *items, int index)
+{
+    return GC_ITEM_DURATION0(items[index]) == 1;
+}
+
+//Analog byte starting at item index first, MSB first
+static uint8_t gc_frame_analog(const uint32_t *items, int first)
+{
+    uint8_t value = 0;
+    for(int x = 8; x > -1; x--)
+    {
+        if(gc_item_is_one(items, x + first))
+        {
+            value += pow(2, 8-x-1);
+        }
+    }
+    return value;
+}
+
+bool gc_frame_decode_ref(const uint32_t *items, uint8_t status[GC_STATUS_LEN])
+{
+    //Check first 3 bits and high bit at index 33
+    if(!(gc_item_is_one(items, 33) && gc_item_is_one(items, 27) &&
+         GC_ITEM_DURATION0(items[26]) == 3 && GC_ITEM_DURATION0(items[25]) == 3))
+    {
+        return false;
+    }
+
+    uint8_t but0 = 0;
+    uint8_t but1 = 0x80;
+    if(gc_item_is_one(items, 32)) but0 += GC_BTN_A;
+    if(gc_item_is_one(items, 31)) but0 += GC_BTN_B;
+    if(gc_item_is_one(items, 30)) but0 += GC_BTN_X;
+    if(gc_item_is_one(items, 29)) but0 += GC_BTN_Y;
+    if(gc_item_is_one(items, 28)) but0 += GC_BTN_START;
+
+    if(gc_item_is_one(items, 40)) but1 += GC_BTN_DLEFT;
+    if(gc_item_is_one(items, 39)) but1 += GC_BTN_DRIGHT;
+    if(gc_item_is_one(items, 38)) but1 += GC_BTN_DDOWN;
+    if(gc_item_is_one(items, 37)) but1 += GC_BTN_DUP;
+    if(gc_item_is_one(items, 36)) but1 += GC_BTN_Z;
+    if(gc_item_is_one(items, 35)) but1 += GC_BTN_R;
+    if(gc_item_is_one(items, 34)) but1 += GC_BTN_L;
+
+    status[GC_BYTE_BUTTONS0] = but0 | 0x20;
+    status[GC_BYTE_BUTTONS1] = but1;
+    status[GC_BYTE_LX] = gc_frame_analog(items, 41);
+    status[GC_BYTE_LY] = gc_frame_analog(items, 49);
+    status[GC_BYTE_CX] = gc_frame_analog(items, 57);
+    status[GC_BYTE_CY] = gc_frame_analog(items, 65);
+    status[GC_BYTE_L_ANALOG] = gc_frame_analog(items, 73);
+    status[GC_BYTE_R_ANALOG] = gc_frame_analog(items, 81);
+    return true;
+}
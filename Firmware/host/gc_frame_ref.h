@@ -0,0 +1,12 @@
+//
+//  Reference GameCube frame decoder (original pow() based implementation)
+//
+
+#ifndef GC_FRAME_REF_H
+#define GC_FRAME_REF_H
+
+#include "gc_frame.h"
+
+bool gc_frame_decode_ref(const uint32_t *items, uint8_t status[GC_STATUS_LEN]);
+
+#endif
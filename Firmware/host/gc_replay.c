@@ -0,0 +1,245 @@
+//
+//  gc_replay - runs the GameCube frame decoder over recorded RMT RX frames
+//
+//  Usage:
+//    gc_replay [-n repeat] [-d] [-w out.jbcp] capture.jbcp...
+//    gc_replay -l [-n repeat] [-d] [-w out.jbcp] monitor.log...
+//    gc_replay -s frames [-n repeat] [-w out.jbcp]
+//
+//  -l  inputs are serial monitor logs containing "JBCP:" dump lines
+//  -s  synthesise random frames instead of loading captures; every decoded
+//      status word is checked against the one the frame was built from
+//  -n  decode the loaded frames this many times (throughput measurement)
+//  -d  print every decoded status word
+//  -w  write the loaded frames as one binary capture file
+//
+//  Every frame is also run through the original pow() based decoder and any
+//  disagreement is counted. The digest printed at the end covers every
+//  decoded status word, so two decoder builds can be compared on the same
+//  capture.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "gc_frame.h"
+#include "gc_frame_ref.h"
+#include "gc_synth.h"
+#include "joybus_capture.h"
+#include "host_util.h"
+
+typedef struct {
+    uint32_t *items;        // all frames back to back
+    uint32_t *offset;       // first item of each frame
+    uint16_t *count;
+    uint32_t *timestamp;
+    uint8_t *expect;        // GC_STATUS_LEN per frame when synthesised
+    size_t frames;
+    size_t frames_cap;
+    size_t items_len;
+    size_t items_cap;
+} frame_set_t;
+
+static void frames_add(frame_set_t *set, uint32_t timestamp, const uint32_t *items, uint16_t count)
+{
+    if(set->frames == set->frames_cap)
+    {
+        set->frames_cap = set->frames_cap ? set->frames_cap * 2 : 1024;
+        set->offset = realloc(set->offset, set->frames_cap * sizeof(*set->offset));
+        set->count = realloc(set->count, set->frames_cap * sizeof(*set->count));
+        set->timestamp = realloc(set->timestamp, set->frames_cap * sizeof(*set->timestamp));
+        set->expect = realloc(set->expect, set->frames_cap * GC_STATUS_LEN);
+    }
+    //decoders may look at a full GameCube frame even if the capture is short
+    size_t room = count < JOYBUS_RX_MAX_ITEMS ? JOYBUS_RX_MAX_ITEMS : count;
+    while(set->items_len + room > set->items_cap)
+    {
+        set->items_cap = set->items_cap ? set->items_cap * 2 : 1 << 16;
+        set->items = realloc(set->items, set->items_cap * sizeof(*set->items));
+    }
+    uint32_t *dst = set->items + set->items_len;
+    memcpy(dst, items, count * sizeof(*items));
+    memset(dst + count, 0, (room - count) * sizeof(*items));
+    set->offset[set->frames] = set->items_len;
+    set->count[set->frames] = count;
+    set->timestamp[set->frames] = timestamp;
+    set->frames++;
+    set->items_len += count;
+}
+
+static int frames_load_capture(frame_set_t *set, const uint8_t *buf, size_t len)
+{
+    joybus_capture_reader_t rd;
+    uint32_t items[JOYBUS_RX_MAX_ITEMS];
+    uint32_t ts;
+    int n;
+
+    if(!joybus_capture_open(&rd, buf, len))
+        return -1;
+    while((n = joybus_capture_next(&rd, &ts, items, JOYBUS_RX_MAX_ITEMS)) > 0)
+        frames_add(set, ts, items, n);
+    return n;
+}
+
+static void log_block(const uint8_t *buf, size_t len, void *arg)
+{
+    if(frames_load_capture(arg, buf, len) < 0)
+        fprintf(stderr, "gc_replay: skipping truncated or damaged dump\n");
+}
+
+static void frames_synth(frame_set_t *set, size_t frames)
+{
+    uint32_t seed = 0x1234567;
+    uint32_t items[GC_SYNTH_FRAME_ITEMS];
+    uint8_t status[GC_STATUS_LEN];
+
+    for(size_t i = 0; i < frames; i++)
+    {
+        gc_synth_random_status(&seed, status);
+        uint16_t n = gc_synth_frame(status, items);
+        frames_add(set, i * 1000, items, n);
+        memcpy(set->expect + (set->frames - 1) * GC_STATUS_LEN, status, GC_STATUS_LEN);
+    }
+}
+
+static int frames_write(const frame_set_t *set, const char *path)
+{
+    size_t size = JOYBUS_CAPTURE_HEADER_LEN;
+    for(size_t i = 0; i < set->frames; i++)
+        size += JOYBUS_CAPTURE_RECORD_LEN + set->count[i] * 5;
+
+    uint8_t *buf = malloc(size);
+    joybus_capture_t cap;
+    joybus_capture_init(&cap, buf, size);
+    for(size_t i = 0; i < set->frames; i++)
+        joybus_capture_add(&cap, set->timestamp[i], set->items + set->offset[i], set->count[i]);
+    int ret = host_write_file(path, buf, cap.len);
+    printf("wrote %zu frames, %zu bytes to %s\n", set->frames, cap.len, path);
+    free(buf);
+    return ret;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: gc_replay [-l] [-n repeat] [-d] [-w out] capture...\n"
+                    "       gc_replay -s frames [-n repeat] [-w out]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    frame_set_t set = {0};
+    const char *write_path = NULL;
+    long repeat = 1;
+    long synth = 0;
+    int from_log = 0;
+    int dump = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "ln:ds:w:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'l': from_log = 1; break;
+            case 'n': repeat = atol(optarg); break;
+            case 'd': dump = 1; break;
+            case 's': synth = atol(optarg); break;
+            case 'w': write_path = optarg; break;
+            default: usage();
+        }
+    }
+    if(repeat < 1 || (synth == 0 && optind == argc))
+        usage();
+
+    if(synth > 0)
+        frames_synth(&set, synth);
+    for(int i = optind; i < argc; i++)
+    {
+        if(from_log)
+        {
+            if(host_read_log(argv[i], JOYBUS_CAPTURE_LOG_PREFIX, log_block, &set) < 0)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            continue;
+        }
+        size_t len;
+        uint8_t *buf = host_read_file(argv[i], &len);
+        if(buf == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        if(frames_load_capture(&set, buf, len) < 0)
+            fprintf(stderr, "gc_replay: %s: not a capture or damaged record\n", argv[i]);
+        free(buf);
+    }
+    if(set.frames == 0)
+    {
+        fprintf(stderr, "gc_replay: no frames\n");
+        return 1;
+    }
+    if(write_path != NULL && frames_write(&set, write_path) != 0)
+    {
+        perror(write_path);
+        return 1;
+    }
+
+    //correctness pass
+    size_t valid = 0;
+    size_t mismatch = 0;
+    size_t ref_mismatch = 0;
+    uint32_t digest = HOST_FNV1A_INIT;
+    for(size_t i = 0; i < set.frames; i++)
+    {
+        uint8_t status[GC_STATUS_LEN] = {0};
+        uint8_t ref[GC_STATUS_LEN] = {0};
+        bool ok = gc_frame_decode(set.items + set.offset[i], status);
+        bool ref_ok = gc_frame_decode_ref(set.items + set.offset[i], ref);
+        if(ok != ref_ok || memcmp(status, ref, GC_STATUS_LEN) != 0)
+            ref_mismatch++;
+        if(!ok)
+        {
+            if(dump)
+                printf("%8zu  invalid\n", i);
+            continue;
+        }
+        valid++;
+        digest = host_fnv1a(digest, status, GC_STATUS_LEN);
+        if(i < (size_t)synth && memcmp(status, set.expect + i * GC_STATUS_LEN, GC_STATUS_LEN) != 0)
+            mismatch++;
+        if(dump)
+        {
+            printf("%8zu ", i);
+            for(int b = 0; b < GC_STATUS_LEN; b++)
+                printf(" %02x", status[b]);
+            printf("\n");
+        }
+    }
+
+    //throughput pass
+    volatile uint8_t sink = 0;
+    uint64_t start = host_now_ns();
+    for(long r = 0; r < repeat; r++)
+    {
+        for(size_t i = 0; i < set.frames; i++)
+        {
+            uint8_t status[GC_STATUS_LEN];
+            if(gc_frame_decode(set.items + set.offset[i], status))
+                sink ^= status[GC_BYTE_LX];
+        }
+    }
+    uint64_t elapsed = host_now_ns() - start;
+    double decoded = (double)set.frames * repeat;
+
+    printf("frames %zu valid %zu invalid %zu reference-mismatch %zu", set.frames, valid, set.frames - valid, ref_mismatch);
+    if(synth > 0)
+        printf(" mismatch %zu", mismatch);
+    printf("\ndecoded %.0f frames in %.3f ms, %.1f ns/frame, %.2f Mframes/s\n",
+           decoded, elapsed / 1e6, elapsed / decoded, decoded * 1e3 / elapsed);
+    printf("digest %08x\n", digest);
+    return mismatch || ref_mismatch ? 1 : 0;
+}
@@ -0,0 +1,49 @@
+//
+//  Synthetic GameCube RMT frames for the host tools
+//
+
+#include "gc_synth.h"
+#include "joybus_cmd.h"
+
+#define ITEM            JOYBUS_ITEM
+#define ITEM_ONE        JOYBUS_ITEM_ONE
+#define ITEM_ZERO       JOYBUS_ITEM_ZERO
+
+static uint32_t *put_byte(uint32_t *p, uint8_t b)
+{
+    for(int bit = 7; bit >= 0; bit--)
+        *p++ = (b >> bit) & 1 ? ITEM_ONE : ITEM_ZERO;
+    return p;
+}
+
+uint16_t gc_synth_frame(const uint8_t status[GC_STATUS_LEN], uint32_t *items)
+{
+    const joybus_cmd_t *poll = &joybus_cmds[JOYBUS_POLL];
+    uint32_t *p = items;
+    for(int i = 0; i < poll->len; i++)
+        p = put_byte(p, poll->bytes[i]);
+    //stop bit, the line then idles high until the controller answers
+    *p++ = ITEM(1, 5);
+    for(int i = 0; i < GC_STATUS_LEN; i++)
+        p = put_byte(p, status[i]);
+    //controller stop bit followed by the idle that ends the frame
+    *p++ = ITEM(1, 0);
+    return p - items;
+}
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+void gc_synth_random_status(uint32_t *seed, uint8_t status[GC_STATUS_LEN])
+{
+    for(int i = 0; i < GC_STATUS_LEN; i++)
+        status[i] = xorshift(seed) & 0xFF;
+    status[GC_BYTE_BUTTONS0] = (status[GC_BYTE_BUTTONS0] & 0x1F) | 0x20;
+    status[GC_BYTE_BUTTONS1] |= 0x80;
+}
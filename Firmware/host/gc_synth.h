@@ -0,0 +1,23 @@
+//
+//  Synthetic GameCube RMT frames for the host tools
+//
+//  Builds the RX item stream the ESP32 would see for a given controller
+//  status word: command echo, 64 response bits, stop bit and end marker.
+//
+
+#ifndef GC_SYNTH_H
+#define GC_SYNTH_H
+
+#include <stdint.h>
+
+#include "gc_frame.h"
+
+#define GC_SYNTH_FRAME_ITEMS    (GC_FRAME_ITEMS + 1)
+
+//Fills items[GC_SYNTH_FRAME_ITEMS], returns the item count
+uint16_t gc_synth_frame(const uint8_t status[GC_STATUS_LEN], uint32_t *items);
+
+//Random but well formed status word (header bits set)
+void gc_synth_random_status(uint32_t *seed, uint8_t status[GC_STATUS_LEN]);
+
+#endif
@@ -0,0 +1,420 @@
+//
+//  hid_trace - decodes HID traffic traces into a subcommand timeline
+//
+//  Usage:
+//    hid_trace [-s reports]
+//    hid_trace [-l] [-a] dump...
+//
+//  Dumps are binary trace files, or serial monitor logs with -l as printed
+//  by the Switch firmwares with HID_TRACE. Every output report carrying a
+//  subcommand and every 0x21 reply is listed with its time, the reply with
+//  the round trip time to its request. 0x30 input reports and pairing
+//  filler are only counted unless -a is given. A summary per subcommand
+//  (requests, replies, round trip min/mean/max) follows.
+//
+//  Without dumps, runs a synthetic pairing session followed by the given
+//  number of 0x30 reports through a small trace ring, so it wraps, and
+//  checks that every surviving record decodes to what was recorded.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "hid_trace.h"
+#include "switch_subcmd.h"
+#include "host_util.h"
+
+#define REPORT_SUBCMD       0x01    // output report with rumble and subcommand
+#define REPORT_RUMBLE       0x10    // output report with rumble only
+#define REPORT_REPLY        0x21
+#define REPORT_INPUT        0x30
+
+typedef struct {
+    uint32_t requests;
+    uint32_t replies;
+    uint32_t rtt_min_us;
+    uint32_t rtt_max_us;
+    uint64_t rtt_total_us;
+    int pending;                // a request is waiting for its reply
+    uint32_t pending_us;
+} subcmd_stats_t;
+
+typedef struct {
+    int all;
+    int have_first;
+    uint32_t first_us;
+    uint32_t records;
+    uint32_t rumble;
+    uint32_t inputs;
+    uint32_t input_gap_max_us;
+    uint32_t last_input_us;
+    uint64_t input_gap_total_us;
+    uint32_t other;
+    subcmd_stats_t subcmd[256];
+} timeline_t;
+
+static const char *subcmd_name(uint8_t subcmd)
+{
+    switch(subcmd)
+    {
+        case 0x01: return "bluetooth manual pairing";
+        case 0x02: return "device info";
+        case 0x03: return "set input report mode";
+        case 0x04: return "trigger buttons elapsed time";
+        case 0x08: return "shipment low power state";
+        case 0x10: return "SPI flash read";
+        case 0x11: return "SPI flash write";
+        case 0x21: return "MCU config";
+        case 0x22: return "MCU state";
+        case 0x30: return "player lights";
+        case 0x38: return "HOME light";
+        case 0x40: return "enable IMU";
+        case 0x41: return "IMU sensitivity";
+        case 0x48: return "enable vibration";
+        default: return "";
+    }
+}
+
+static void print_time(timeline_t *tl, uint32_t us)
+{
+    uint32_t rel = us - tl->first_us;
+    printf("%6u.%06u  ", (unsigned)(rel / 1000000), (unsigned)(rel % 1000000));
+}
+
+static void print_payload(const hid_trace_record_t *rec, int from)
+{
+    for(int i = from; i < rec->len; i++)
+        printf(" %02x", rec->data[i]);
+}
+
+static void timeline_record(timeline_t *tl, const hid_trace_record_t *rec)
+{
+    uint32_t t = rec->timestamp_us;
+
+    if(!tl->have_first)
+    {
+        tl->first_us = t;
+        tl->have_first = 1;
+    }
+    tl->records++;
+
+    if(rec->dir == HID_TRACE_OUTPUT && rec->report_id == REPORT_SUBCMD && rec->len > SWITCH_SUBCMD_OFFSET)
+    {
+        uint8_t subcmd = rec->data[SWITCH_SUBCMD_OFFSET];
+        subcmd_stats_t *s = &tl->subcmd[subcmd];
+        s->requests++;
+        s->pending = 1;
+        s->pending_us = t;
+        print_time(tl, t);
+        printf("out 01 #%02x  subcmd %02x %-28s", rec->data[1], subcmd, subcmd_name(subcmd));
+        //arguments up to the first run of zeros is enough to tell requests apart
+        int end = rec->len;
+        while(end > SWITCH_SUBCMD_ARG && rec->data[end - 1] == 0)
+            end--;
+        for(int i = SWITCH_SUBCMD_ARG; i < end && i < SWITCH_SUBCMD_ARG + 8; i++)
+            printf(" %02x", rec->data[i]);
+        printf("\n");
+    }
+    else if(rec->dir == HID_TRACE_INPUT && rec->report_id == REPORT_REPLY && rec->len > SWITCH_REPLY_SUBCMD)
+    {
+        uint8_t subcmd = rec->data[SWITCH_REPLY_SUBCMD];
+        subcmd_stats_t *s = &tl->subcmd[subcmd];
+        print_time(tl, t);
+        printf("in  21 #%02x  ack %02x %02x %-28s", rec->data[1], rec->data[SWITCH_REPLY_ACK], subcmd, subcmd_name(subcmd));
+        if(s->pending)
+        {
+            uint32_t rtt = t - s->pending_us;
+            if(s->replies == 0 || rtt < s->rtt_min_us)
+                s->rtt_min_us = rtt;
+            if(rtt > s->rtt_max_us)
+                s->rtt_max_us = rtt;
+            s->rtt_total_us += rtt;
+            s->replies++;
+            s->pending = 0;
+            printf(" rtt %uus", (unsigned)rtt);
+        }
+        else
+        {
+            printf(" unrequested");
+        }
+        printf("\n");
+    }
+    else if(rec->dir == HID_TRACE_INPUT && rec->report_id == REPORT_INPUT)
+    {
+        if(tl->inputs > 0)
+        {
+            uint32_t gap = t - tl->last_input_us;
+            tl->input_gap_total_us += gap;
+            if(gap > tl->input_gap_max_us)
+                tl->input_gap_max_us = gap;
+        }
+        tl->last_input_us = t;
+        tl->inputs++;
+        if(tl->all)
+        {
+            print_time(tl, t);
+            printf("in  30 #%02x ", rec->data[1]);
+            print_payload(rec, 2);
+            printf("\n");
+        }
+    }
+    else
+    {
+        if(rec->dir == HID_TRACE_OUTPUT && rec->report_id == REPORT_RUMBLE)
+            tl->rumble++;
+        else
+            tl->other++;
+        if(tl->all)
+        {
+            print_time(tl, t);
+            printf("%s %02x    ", rec->dir == HID_TRACE_OUTPUT ? "out" : "in ", rec->report_id);
+            print_payload(rec, 1);
+            printf("\n");
+        }
+    }
+}
+
+static void timeline_summary(timeline_t *tl)
+{
+    printf("\n%u records, %u 0x30 reports", (unsigned)tl->records, (unsigned)tl->inputs);
+    if(tl->inputs > 1)
+        printf(" (interval mean %uus max %uus)", (unsigned)(tl->input_gap_total_us / (tl->inputs - 1)),
+               (unsigned)tl->input_gap_max_us);
+    printf(", %u rumble only, %u other\n", (unsigned)tl->rumble, (unsigned)tl->other);
+    printf("subcmd  requests replies  rtt min    mean     max\n");
+    for(int i = 0; i < 256; i++)
+    {
+        subcmd_stats_t *s = &tl->subcmd[i];
+        if(s->requests == 0 && s->replies == 0)
+            continue;
+        printf("  %02x    %8u %7u", i, (unsigned)s->requests, (unsigned)s->replies);
+        if(s->replies > 0)
+            printf("  %6uus %6uus %6uus", (unsigned)s->rtt_min_us, (unsigned)(s->rtt_total_us / s->replies),
+                   (unsigned)s->rtt_max_us);
+        printf("  %s\n", subcmd_name(i));
+    }
+}
+
+static int replay_dump(timeline_t *tl, const uint8_t *buf, size_t len)
+{
+    hid_trace_reader_t *rd = malloc(sizeof(*rd));
+    hid_trace_record_t rec;
+    int n;
+
+    if(rd == NULL || !hid_trace_open(rd, buf, len))
+    {
+        free(rd);
+        return -1;
+    }
+    if(rd->dropped > 0)
+        printf("# %u older records were overwritten\n", (unsigned)rd->dropped);
+    while((n = hid_trace_next(rd, &rec)) > 0)
+        timeline_record(tl, &rec);
+    if(rd->skipped > 0)
+        printf("# %u records before the first key of their report skipped\n", (unsigned)rd->skipped);
+    free(rd);
+    return n;
+}
+
+static void log_block(const uint8_t *buf, size_t len, void *arg)
+{
+    if(replay_dump(arg, buf, len) < 0)
+        fprintf(stderr, "hid_trace: skipping truncated or damaged dump\n");
+}
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+//Pairing as the console does it: a subcommand, the reply, the next one
+static const uint8_t synth_subcmds[][3] = {
+    { 0x02 }, { 0x08 }, { 0x10, 0x00, 0x60 }, { 0x03, 0x30 }, { 0x04 }, { 0x10, 0x50, 0x60 },
+    { 0x10, 0x80, 0x60 }, { 0x10, 0x98, 0x60 }, { 0x10, 0x10, 0x80 }, { 0x10, 0x3d, 0x60 },
+    { 0x10, 0x20, 0x60 }, { 0x40, 0x01 }, { 0x48, 0x01 }, { 0x30, 0x01 }, { 0x21, 0x21 },
+};
+
+static int check_synth(long reports)
+{
+    static uint8_t ring[4096];
+    static uint8_t dump[HID_TRACE_HEADER_LEN + sizeof(ring)];
+    hid_trace_t trace;
+    //a request and a reply per subcommand, at most two records per report
+    size_t max = 2 * sizeof(synth_subcmds) / sizeof(synth_subcmds[0]) + 2 * reports;
+    hid_trace_record_t *sent = malloc(sizeof(*sent) * max);
+    hid_trace_reader_t *rd = malloc(sizeof(*rd));
+    hid_trace_record_t rec;
+    uint32_t seed = 0x48494454;
+    uint32_t now = 1000000;
+    uint8_t counter = 0;
+    size_t count = 0;
+
+    hid_trace_init(&trace, ring, sizeof(ring));
+
+    for(size_t i = 0; i < sizeof(synth_subcmds) / sizeof(synth_subcmds[0]); i++)
+    {
+        hid_trace_record_t *out = &sent[count++];
+        memset(out, 0, sizeof(*out));
+        out->dir = HID_TRACE_OUTPUT;
+        out->timestamp_us = now;
+        out->len = 49;
+        out->data[0] = REPORT_SUBCMD;
+        out->data[1] = counter++ & 0x0F;
+        memcpy(&out->data[SWITCH_SUBCMD_OFFSET], synth_subcmds[i], 3);
+        now += 500 + xorshift(&seed) % 3000;
+
+        hid_trace_record_t *in = &sent[count++];
+        memset(in, 0, sizeof(*in));
+        in->dir = HID_TRACE_INPUT;
+        in->timestamp_us = now;
+        in->len = SWITCH_REPLY_LEN;
+        in->data[0] = REPORT_REPLY;
+        in->data[1] = counter;
+        in->data[SWITCH_REPLY_ACK] = SWITCH_ACK | (xorshift(&seed) & 0x1F);
+        in->data[SWITCH_REPLY_SUBCMD] = synth_subcmds[i][0];
+        for(int b = SWITCH_REPLY_DATA; b < SWITCH_REPLY_LEN; b++)
+            in->data[b] = xorshift(&seed);
+        now += 8000 + xorshift(&seed) % 8000;
+    }
+
+    uint8_t input[13] = { REPORT_INPUT, 0, 0x80, 0, 0, 0, 0x00, 0x08, 0x80, 0x00, 0x08, 0x80, 0x08 };
+    for(long i = 0; i < reports; i++)
+    {
+        hid_trace_record_t *in = &sent[count++];
+        memset(in, 0, sizeof(*in));
+        input[1]++;
+        //now and then a button or a stick moves
+        uint32_t r = xorshift(&seed);
+        if(r % 8 == 0)
+            input[3 + (r >> 8) % 9] = r >> 16;
+        in->dir = HID_TRACE_INPUT;
+        in->timestamp_us = now;
+        in->len = sizeof(input);
+        memcpy(in->data, input, sizeof(input));
+        now += 15000;
+        //rumble only output reports in between
+        if(r % 16 == 1)
+        {
+            hid_trace_record_t *out = &sent[count++];
+                    memset(out, 0, sizeof(*out));
+            out->dir = HID_TRACE_OUTPUT;
+            out->timestamp_us = now;
+            out->len = 10;
+            out->data[0] = REPORT_RUMBLE;
+            out->data[1] = counter++ & 0x0F;
+            out->data[2 + r % 8] = r >> 24;
+            now += 100;
+        }
+    }
+
+    for(size_t i = 0; i < count; i++)
+        hid_trace_add(&trace, sent[i].timestamp_us, sent[i].dir, sent[i].data, sent[i].len);
+
+    size_t len = hid_trace_export(&trace, dump, sizeof(dump));
+    if(len == 0 || !hid_trace_open(rd, dump, len))
+    {
+        printf("synth: export failed\n");
+        return 1;
+    }
+
+    //records come back in order, minus the overwritten ones and the deltas
+    //that lost their key
+    size_t next = rd->dropped;
+    long matched = 0, mismatch = 0;
+    int n;
+    while((n = hid_trace_next(rd, &rec)) > 0)
+    {
+        while(next < count && sent[next].timestamp_us != rec.timestamp_us)
+            next++;
+        if(next == count)
+        {
+            mismatch++;
+            break;
+        }
+        hid_trace_record_t *want = &sent[next++];
+        if(rec.dir != want->dir || rec.report_id != want->data[0] || rec.len != want->len ||
+           memcmp(rec.data, want->data, rec.len) != 0)
+            mismatch++;
+        else
+            matched++;
+    }
+    if(n < 0 || rd->dropped + rd->records != count || (uint32_t)matched + rd->skipped != rd->records)
+        mismatch++;
+
+    printf("synth: %zu records, %u kept in %zu bytes (%.1f bytes each), %u overwritten, %u skipped, %ld mismatch\n",
+           count, (unsigned)rd->records, len - HID_TRACE_HEADER_LEN,
+           rd->records ? (double)(len - HID_TRACE_HEADER_LEN) / rd->records : 0.0,
+           (unsigned)rd->dropped, (unsigned)rd->skipped, mismatch);
+
+    //the pairing part alone, without wrapping, is the timeline example
+    if(reports == 0)
+    {
+        timeline_t *tl = calloc(1, sizeof(*tl));
+        replay_dump(tl, dump, len);
+        timeline_summary(tl);
+        free(tl);
+    }
+    free(sent);
+    free(rd);
+    return mismatch != 0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: hid_trace [-s reports]\n"
+                    "       hid_trace [-l] [-a] dump...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    timeline_t *tl = calloc(1, sizeof(*tl));
+    long synth = 10000;
+    int from_log = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "s:la")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': synth = atol(optarg); break;
+            case 'l': from_log = 1; break;
+            case 'a': tl->all = 1; break;
+            default: usage();
+        }
+    }
+
+    if(optind == argc)
+        return check_synth(synth);
+
+    for(int i = optind; i < argc; i++)
+    {
+        if(from_log)
+        {
+            if(host_read_log(argv[i], HID_TRACE_LOG_PREFIX, log_block, tl) < 0)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            continue;
+        }
+        size_t len;
+        uint8_t *buf = host_read_file(argv[i], &len);
+        if(buf == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        if(replay_dump(tl, buf, len) < 0)
+            fprintf(stderr, "hid_trace: %s: not a trace or damaged record\n", argv[i]);
+        free(buf);
+    }
+    timeline_summary(tl);
+    return tl->records == 0;
+}
@@ -0,0 +1,118 @@
+//
+//  Small helpers shared by the host tools
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_util.h"
+
+uint64_t host_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+uint8_t *host_read_file(const char *path, size_t *len)
+{
+    FILE *f = fopen(path, "rb");
+    if(f == NULL)
+        return NULL;
+    size_t cap = 1 << 16;
+    size_t n = 0;
+    uint8_t *buf = malloc(cap);
+    size_t got;
+    while(buf != NULL && (got = fread(buf + n, 1, cap - n, f)) > 0)
+    {
+        n += got;
+        if(n == cap)
+        {
+            cap *= 2;
+            buf = realloc(buf, cap);
+        }
+    }
+    fclose(f);
+    *len = n;
+    return buf;
+}
+
+int host_write_file(const char *path, const uint8_t *buf, size_t len)
+{
+    FILE *f = fopen(path, "wb");
+    if(f == NULL)
+        return -1;
+    size_t put = fwrite(buf, 1, len, f);
+    fclose(f);
+    return put == len ? 0 : -1;
+}
+
+static int hex_nibble(char c)
+{
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int host_read_log(const char *path, const char *prefix, host_log_block_cb block_cb, void *arg)
+{
+    FILE *f = fopen(path, "r");
+    if(f == NULL)
+        return -1;
+
+    size_t cap = 1 << 16;
+    size_t n = 0;
+    uint8_t *buf = malloc(cap);
+    char line[1024];
+    size_t prefix_len = strlen(prefix);
+    int blocks = 0;
+
+    while(fgets(line, sizeof(line), f) != NULL)
+    {
+        //monitor output may carry colour codes or log tags in front
+        char *p = strstr(line, prefix);
+        if(p == NULL)
+            continue;
+        p += prefix_len;
+        if(hex_nibble(*p) < 0)
+        {
+            if(n > 0)
+                block_cb(buf, n, arg);
+            n = 0;
+            blocks++;
+            continue;
+        }
+        while(hex_nibble(p[0]) >= 0 && hex_nibble(p[1]) >= 0)
+        {
+            if(n == cap)
+            {
+                cap *= 2;
+                buf = realloc(buf, cap);
+            }
+            buf[n++] = (hex_nibble(p[0]) << 4) | hex_nibble(p[1]);
+            p += 2;
+        }
+    }
+    //a truncated log still yields the complete lines it has
+    if(n > 0)
+    {
+        block_cb(buf, n, arg);
+        blocks++;
+    }
+    free(buf);
+    fclose(f);
+    return blocks;
+}
+
+uint32_t host_fnv1a(uint32_t hash, const uint8_t *buf, size_t len)
+{
+    for(size_t i = 0; i < len; i++)
+    {
+        hash ^= buf[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,27 @@
+//
+//  Small helpers shared by the host tools
+//
+
+#ifndef HOST_UTIL_H
+#define HOST_UTIL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//Monotonic clock in nanoseconds
+uint64_t host_now_ns(void);
+
+//Reads a whole file, returns NULL on error. Caller frees.
+uint8_t *host_read_file(const char *path, size_t *len);
+int host_write_file(const char *path, const uint8_t *buf, size_t len);
+
+//Collects the hex payload of every "<prefix><hex>" line of a monitor log.
+//Each dump (terminated by an empty prefix line) is passed to block_cb.
+typedef void (*host_log_block_cb)(const uint8_t *buf, size_t len, void *arg);
+int host_read_log(const char *path, const char *prefix, host_log_block_cb block_cb, void *arg);
+
+//FNV-1a
+uint32_t host_fnv1a(uint32_t hash, const uint8_t *buf, size_t len);
+#define HOST_FNV1A_INIT 0x811C9DC5u
+
+#endif
@@ -0,0 +1,297 @@
+//
+//  n64_check - checks the N64 frame decoder and the N64 to Switch mapping
+//
+//  Usage:
+//    n64_check [-s frames]
+//    n64_check [-l] [-d] capture...
+//
+//  Without captures, synthesises random N64 poll frames (and damaged
+//  ones), checks every decoded status against the one the frame was built
+//  from and checks the Switch mapping of every button and stick extreme.
+//
+//  With captures (binary .jbcp files, or serial monitor logs with -l as
+//  recorded by BlueN64Mod with N64_CAPTURE), decodes every recorded frame
+//  and prints the counts and a digest of the decoded status words and
+//  mapped Switch input; -d prints both for every frame.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "joybus_capture.h"
+#include "joybus_cmd.h"
+#include "n64_frame.h"
+#include "switch_input.h"
+#include "switch_n64.h"
+#include "host_util.h"
+
+#define N64_SYNTH_FRAME_ITEMS   (N64_FRAME_ITEMS + 2)
+
+typedef struct {
+    size_t frames;
+    size_t valid;
+    uint32_t digest;
+    int dump;
+    stick_shape_t stick;
+} replay_t;
+
+static uint32_t *put_byte(uint32_t *p, uint8_t b)
+{
+    for(int bit = 7; bit >= 0; bit--)
+        *p++ = (b >> bit) & 1 ? JOYBUS_ITEM_ONE : JOYBUS_ITEM_ZERO;
+    return p;
+}
+
+//RX view of a poll: command echo, 32 status bits, stop bit, end marker
+static uint16_t n64_synth_frame(const uint8_t status[N64_STATUS_LEN], uint32_t *items)
+{
+    uint32_t *p = put_byte(items, joybus_cmds[JOYBUS_N64_POLL].bytes[0]);
+    *p++ = JOYBUS_ITEM(1, 5);
+    for(int i = 0; i < N64_STATUS_LEN; i++)
+        p = put_byte(p, status[i]);
+    *p++ = JOYBUS_ITEM(1, 0);
+    *p++ = 0;
+    return p - items;
+}
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+static int check_synth(long frames)
+{
+    uint32_t seed = 0x64646464;
+    uint32_t items[N64_SYNTH_FRAME_ITEMS];
+    uint8_t status[N64_STATUS_LEN];
+    uint8_t decoded[N64_STATUS_LEN];
+    long mismatch = 0;
+    long accepted_damage = 0;
+
+    for(long i = 0; i < frames; i++)
+    {
+        uint32_t r = xorshift(&seed);
+        memcpy(status, &r, sizeof(status));
+        status[N64_BYTE_BUTTONS1] &= ~N64_BTN_ZERO;
+        n64_synth_frame(status, items);
+        if(!n64_frame_decode(items, decoded) || memcmp(decoded, status, N64_STATUS_LEN) != 0)
+            mismatch++;
+
+        //a cell with equal halves, as left by a glitch on the line
+        items[N64_RESPONSE_FIRST + xorshift(&seed) % (N64_STATUS_LEN * 8)] = JOYBUS_ITEM(2, 2);
+        if(n64_frame_decode(items, decoded))
+            accepted_damage++;
+    }
+    //answer cut short: no stop bit
+    n64_synth_frame(status, items);
+    items[N64_FRAME_ITEMS] = 0;
+    if(n64_frame_decode(items, decoded))
+        accepted_damage++;
+
+    printf("decode: %ld frames, %ld mismatch, %ld damaged frames accepted\n", frames, mismatch, accepted_damage);
+    return mismatch || accepted_damage;
+}
+
+static const struct {
+    const char *name;
+    uint8_t byte;
+    uint8_t mask;
+    uint8_t expect[3];
+} button_cases[] = {
+    { "A",       N64_BYTE_BUTTONS0, N64_BTN_A,      { SWITCH_BTN_A, 0, 0 } },
+    { "B",       N64_BYTE_BUTTONS0, N64_BTN_B,      { SWITCH_BTN_B, 0, 0 } },
+    { "Z",       N64_BYTE_BUTTONS0, N64_BTN_Z,      { 0, 0, SWITCH_BTN_ZL } },
+    { "Start",   N64_BYTE_BUTTONS0, N64_BTN_START,  { 0, SWITCH_BTN_PLUS, 0 } },
+    { "Up",      N64_BYTE_BUTTONS0, N64_BTN_DUP,    { 0, 0, SWITCH_BTN_UP } },
+    { "Down",    N64_BYTE_BUTTONS0, N64_BTN_DDOWN,  { 0, 0, SWITCH_BTN_DOWN } },
+    { "Left",    N64_BYTE_BUTTONS0, N64_BTN_DLEFT,  { 0, 0, SWITCH_BTN_LEFT } },
+    { "Right",   N64_BYTE_BUTTONS0, N64_BTN_DRIGHT, { 0, 0, SWITCH_BTN_RIGHT } },
+    { "L",       N64_BYTE_BUTTONS1, N64_BTN_L,      { 0, 0, SWITCH_BTN_L } },
+    { "R",       N64_BYTE_BUTTONS1, N64_BTN_R,      { SWITCH_BTN_R, 0, 0 } },
+    { "Z+Start", N64_BYTE_BUTTONS0, N64_BTN_Z | N64_BTN_START, { 0, SWITCH_BTN_MINUS, SWITCH_BTN_ZL } },
+    { "Z+Up",    N64_BYTE_BUTTONS0, N64_BTN_Z | N64_BTN_DUP,   { 0, SWITCH_BTN_HOME, SWITCH_BTN_ZL | SWITCH_BTN_UP } },
+};
+
+static const struct {
+    const char *name;
+    uint8_t c;          // N64_BYTE_BUTTONS1
+    int8_t x, y;        // main stick
+    uint16_t lx, ly, cx, cy;
+    uint16_t tolerance;
+} stick_cases[] = {
+    { "center",     0, 0, 0,       0x800, 0x800, 0x800, 0x800, 0 },
+    { "resting",    0, 2, -3,      0x800, 0x800, 0x800, 0x800, 0 },
+    { "full right", 0, N64_STICK_RANGE, 0,  0x800 + STICK_OUT_RANGE, 0x800, 0x800, 0x800, 16 },
+    { "full down",  0, 0, -N64_STICK_RANGE, 0x800, 0x800 - STICK_OUT_RANGE, 0x800, 0x800, 16 },
+    { "C up",       N64_BTN_CUP, 0, 0,    0x800, 0x800, 0x800, 0x800 + STICK_OUT_RANGE, 0 },
+    { "C left",     N64_BTN_CLEFT, 0, 0,  0x800, 0x800, 0x800 - STICK_OUT_RANGE, 0x800, 0 },
+    { "C down+right", N64_BTN_CDOWN | N64_BTN_CRIGHT, 0, 0, 0x800, 0x800, 0x800 + STICK_OUT_RANGE, 0x800 - STICK_OUT_RANGE, 0 },
+};
+
+static void unpack_stick(const uint8_t *p, uint16_t *x, uint16_t *y)
+{
+    *x = p[0] | (p[1] & 0x0F) << 8;
+    *y = p[1] >> 4 | p[2] << 4;
+}
+
+//The mapping as it ends up in the Switch report
+static void map_input(const uint8_t status[N64_STATUS_LEN], const stick_shape_t *stick, switch_input_t *input)
+{
+    pad_state_t state;
+
+    switch_n64_map(status, stick, &state);
+    switch_input_encode_state(input, &state);
+}
+
+static int near(uint16_t a, uint16_t b, uint16_t tolerance)
+{
+    return abs((int)a - (int)b) <= tolerance;
+}
+
+static int check_mapping(const stick_shape_t *stick)
+{
+    int failed = 0;
+    switch_input_t input;
+
+    for(size_t i = 0; i < sizeof(button_cases) / sizeof(button_cases[0]); i++)
+    {
+        uint8_t status[N64_STATUS_LEN] = {0};
+        status[button_cases[i].byte] = button_cases[i].mask;
+        map_input(status, stick, &input);
+        if(memcmp(input.data, button_cases[i].expect, 3) != 0)
+        {
+            printf("map %-12s got %02x %02x %02x expected %02x %02x %02x\n", button_cases[i].name,
+                   input.data[0], input.data[1], input.data[2],
+                   button_cases[i].expect[0], button_cases[i].expect[1], button_cases[i].expect[2]);
+            failed++;
+        }
+    }
+    for(size_t i = 0; i < sizeof(stick_cases) / sizeof(stick_cases[0]); i++)
+    {
+        uint8_t status[N64_STATUS_LEN] = { 0, stick_cases[i].c, (uint8_t)stick_cases[i].x, (uint8_t)stick_cases[i].y };
+        uint16_t lx, ly, cx, cy;
+        map_input(status, stick, &input);
+        unpack_stick(&input.data[3], &lx, &ly);
+        unpack_stick(&input.data[6], &cx, &cy);
+        uint16_t tol = stick_cases[i].tolerance;
+        if(!near(lx, stick_cases[i].lx, tol) || !near(ly, stick_cases[i].ly, tol) ||
+           !near(cx, stick_cases[i].cx, 0) || !near(cy, stick_cases[i].cy, 0))
+        {
+            printf("map %-12s got %03x %03x %03x %03x expected %03x %03x %03x %03x\n", stick_cases[i].name,
+                   lx, ly, cx, cy, stick_cases[i].lx, stick_cases[i].ly, stick_cases[i].cx, stick_cases[i].cy);
+            failed++;
+        }
+    }
+    printf("mapping: %zu cases, %d failed\n",
+           sizeof(button_cases) / sizeof(button_cases[0]) + sizeof(stick_cases) / sizeof(stick_cases[0]), failed);
+    return failed != 0;
+}
+
+static void replay_frame(replay_t *rp, const uint32_t *items)
+{
+    uint8_t status[N64_STATUS_LEN];
+    switch_input_t input;
+
+    rp->frames++;
+    if(!n64_frame_decode(items, status))
+    {
+        if(rp->dump)
+            printf("%8zu  invalid\n", rp->frames - 1);
+        return;
+    }
+    rp->valid++;
+    map_input(status, &rp->stick, &input);
+    rp->digest = host_fnv1a(rp->digest, status, N64_STATUS_LEN);
+    rp->digest = host_fnv1a(rp->digest, input.data, SWITCH_INPUT_LEN);
+    if(rp->dump)
+    {
+        printf("%8zu  %02x %02x %4d %4d  ->", rp->frames - 1, status[0], status[1],
+               (int8_t)status[N64_BYTE_X], (int8_t)status[N64_BYTE_Y]);
+        for(int b = 0; b < SWITCH_INPUT_LEN; b++)
+            printf(" %02x", input.data[b]);
+        printf("\n");
+    }
+}
+
+static int replay_capture(replay_t *rp, const uint8_t *buf, size_t len)
+{
+    joybus_capture_reader_t rd;
+    //the decoder may look past a short capture
+    uint32_t items[JOYBUS_RX_MAX_ITEMS];
+    uint32_t ts;
+    int n;
+
+    if(!joybus_capture_open(&rd, buf, len))
+        return -1;
+    while(memset(items, 0, sizeof(items)), (n = joybus_capture_next(&rd, &ts, items, JOYBUS_RX_MAX_ITEMS)) > 0)
+        replay_frame(rp, items);
+    return n;
+}
+
+static void log_block(const uint8_t *buf, size_t len, void *arg)
+{
+    if(replay_capture(arg, buf, len) < 0)
+        fprintf(stderr, "n64_check: skipping truncated or damaged dump\n");
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: n64_check [-s frames]\n"
+                    "       n64_check [-l] [-d] capture...\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    replay_t rp = { .digest = HOST_FNV1A_INIT };
+    long synth = 100000;
+    int from_log = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "s:ld")) != -1)
+    {
+        switch(opt)
+        {
+            case 's': synth = atol(optarg); break;
+            case 'l': from_log = 1; break;
+            case 'd': rp.dump = 1; break;
+            default: usage();
+        }
+    }
+    switch_n64_stick_init(&rp.stick, 256, 3840, 0);
+
+    if(optind == argc)
+        return check_synth(synth) | check_mapping(&rp.stick);
+
+    for(int i = optind; i < argc; i++)
+    {
+        if(from_log)
+        {
+            if(host_read_log(argv[i], JOYBUS_CAPTURE_LOG_PREFIX, log_block, &rp) < 0)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            continue;
+        }
+        size_t len;
+        uint8_t *buf = host_read_file(argv[i], &len);
+        if(buf == NULL)
+        {
+            perror(argv[i]);
+            return 1;
+        }
+        if(replay_capture(&rp, buf, len) < 0)
+            fprintf(stderr, "n64_check: %s: not a capture or damaged record\n", argv[i]);
+        free(buf);
+    }
+    printf("frames %zu valid %zu invalid %zu\n", rp.frames, rp.valid, rp.frames - rp.valid);
+    printf("digest %08x\n", rp.digest);
+    return rp.valid == 0;
+}
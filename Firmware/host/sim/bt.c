@@ -0,0 +1,207 @@
+//
+//  Bluedroid and the HID device API on the host, driven by a virtual host
+//
+//  The callbacks run in whichever thread calls sim_bt_connect(),
+//  sim_bt_output() and so on, the runner does that from one thread like
+//  the Bluedroid BTC task does on the device.
+//
+
+#include <stdio.h>
+#include <string.h>
+
+#include "esp_bt.h"
+#include "esp_bt_device.h"
+#include "esp_bt_main.h"
+#include "esp_gap_bt_api.h"
+#include "esp_hidd_api.h"
+
+#include "sim.h"
+
+#define BT_MTU  672     // default L2CAP MTU
+
+static pthread_mutex_t bt_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bt_cond;
+static pthread_once_t bt_once = PTHREAD_ONCE_INIT;
+
+static esp_bt_gap_cb_t gap_cb;
+static esp_hidd_callbacks_t hidd_cb;
+static bool registered;
+static bool connectable;
+static bool connected;
+static uint8_t bt_addr[ESP_BD_ADDR_LEN];
+static esp_bd_addr_t host_addr = { 0x98, 0xb6, 0xe9, 0x00, 0x00, 0x01 };
+
+static pthread_mutex_t report_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_report_fn report_cb;
+
+static void bt_init(void)
+{
+    sim_cond_init(&bt_cond);
+}
+
+esp_err_t esp_bt_controller_mem_release(esp_bt_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_mem_release(esp_bt_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_init(esp_bt_controller_config_t *cfg)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_controller_enable(esp_bt_mode_t mode)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bluedroid_enable(void)
+{
+    return ESP_OK;
+}
+
+const uint8_t *esp_bt_dev_get_address(void)
+{
+    const uint8_t *mac = sim_base_mac();
+
+    memcpy(bt_addr, mac, sizeof(bt_addr));
+    bt_addr[5] += 2;
+    return bt_addr;
+}
+
+esp_err_t esp_bt_dev_set_device_name(const char *name)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_gap_register_callback(esp_bt_gap_cb_t callback)
+{
+    gap_cb = callback;
+    return ESP_OK;
+}
+
+esp_err_t esp_bt_gap_set_scan_mode(esp_bt_connection_mode_t c_mode, esp_bt_discovery_mode_t d_mode)
+{
+    pthread_once(&bt_once, bt_init);
+    pthread_mutex_lock(&bt_lock);
+    connectable = c_mode == ESP_BT_CONNECTABLE;
+    pthread_cond_broadcast(&bt_cond);
+    pthread_mutex_unlock(&bt_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_hid_device_register_app(esp_hidd_app_param_t *app_param, esp_hidd_qos_param_t *in_qos,
+                                      esp_hidd_qos_param_t *out_qos)
+{
+    return ESP_OK;
+}
+
+esp_err_t esp_hid_device_init(esp_hidd_callbacks_t *callbacks)
+{
+    pthread_once(&bt_once, bt_init);
+    hidd_cb = *callbacks;
+    //the registration result arrives through the callback, as on the device
+    if(hidd_cb.application_state_cb != NULL)
+        hidd_cb.application_state_cb(bt_addr, ESP_HIDD_APP_STATE_REGISTERED);
+    pthread_mutex_lock(&bt_lock);
+    registered = true;
+    pthread_cond_broadcast(&bt_cond);
+    pthread_mutex_unlock(&bt_lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_hid_device_send_report(esp_hidd_report_type_t type, uint8_t id, uint16_t len, uint8_t *data)
+{
+    int64_t now = sim_time_us();
+
+    pthread_mutex_lock(&bt_lock);
+    bool up = connected;
+    pthread_mutex_unlock(&bt_lock);
+    if(!up)
+        return ESP_FAIL;
+    pthread_mutex_lock(&report_lock);
+    if(report_cb != NULL && len > 0)
+        report_cb(data[0], data, len, now);
+    pthread_mutex_unlock(&report_lock);
+    return ESP_OK;
+}
+
+void sim_bt_set_report_cb(sim_report_fn fn)
+{
+    pthread_mutex_lock(&report_lock);
+    report_cb = fn;
+    pthread_mutex_unlock(&report_lock);
+}
+
+bool sim_bt_wait_connectable(uint32_t timeout_ms)
+{
+    struct timespec ts;
+    bool ready;
+
+    pthread_once(&bt_once, bt_init);
+    sim_deadline(&ts, (int64_t)timeout_ms * 1000);
+    pthread_mutex_lock(&bt_lock);
+    while(!(registered && connectable))
+    {
+        if(pthread_cond_timedwait(&bt_cond, &bt_lock, &ts) != 0)
+            break;
+    }
+    ready = registered && connectable;
+    pthread_mutex_unlock(&bt_lock);
+    return ready;
+}
+
+bool sim_bt_connect(void)
+{
+    esp_bt_gap_cb_param_t param;
+
+    pthread_mutex_lock(&bt_lock);
+    bool ok = registered && connectable && !connected;
+    pthread_mutex_unlock(&bt_lock);
+    if(!ok)
+        return false;
+
+    memset(&param, 0, sizeof(param));
+    memcpy(param.auth_cmpl.bda, host_addr, sizeof(host_addr));
+    param.auth_cmpl.stat = ESP_BT_STATUS_SUCCESS;
+    strcpy((char *)param.auth_cmpl.device_name, "Nintendo Switch");
+    if(gap_cb != NULL)
+        gap_cb(ESP_BT_GAP_AUTH_CMPL_EVT, &param);
+
+    hidd_cb.connection_state_cb(host_addr, ESP_HIDD_CONN_STATE_CONNECTING);
+    //reports go through from here on, the firmware may send from CONNECTED on
+    pthread_mutex_lock(&bt_lock);
+    connected = true;
+    pthread_mutex_unlock(&bt_lock);
+    hidd_cb.connection_state_cb(host_addr, ESP_HIDD_CONN_STATE_CONNECTED);
+    return true;
+}
+
+void sim_bt_disconnect(void)
+{
+    hidd_cb.connection_state_cb(host_addr, ESP_HIDD_CONN_STATE_DISCONNECTING);
+    pthread_mutex_lock(&bt_lock);
+    connected = false;
+    pthread_mutex_unlock(&bt_lock);
+    hidd_cb.connection_state_cb(host_addr, ESP_HIDD_CONN_STATE_DISCONNECTED);
+}
+
+void sim_bt_output(const uint8_t *data, uint16_t len)
+{
+    uint8_t buf[BT_MTU];
+
+    //the stack hands the callback its own copy
+    if(len > sizeof(buf))
+        len = sizeof(buf);
+    memcpy(buf, data, len);
+    hidd_cb.intr_data_cb(len > 0 ? buf[0] : 0, len, buf);
+}
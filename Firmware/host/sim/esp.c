@@ -0,0 +1,412 @@
+//
+//  ESP-IDF system services on the host: esp_timer, logging, NVS, random
+//
+
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "nvs_flash.h"
+
+#include "sim.h"
+
+#define NVS_MAX_ENTRIES     16
+#define NVS_MAX_HANDLES     8
+#define NVS_KEY_LEN         16  // NVS keys and namespaces have at most 15 characters
+#define NVS_BLOB_MAX        512
+
+//
+//  esp_timer
+//
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void *arg;
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    bool armed;
+    int64_t next_us;
+    uint64_t period_us;         // 0 for a one shot timer
+};
+
+int64_t esp_timer_get_time(void)
+{
+    return sim_time_us();
+}
+
+static void *timer_thread(void *arg)
+{
+    struct esp_timer *t = arg;
+    struct timespec ts;
+
+    pthread_mutex_lock(&t->lock);
+    while(1)
+    {
+        if(!t->armed)
+        {
+            pthread_cond_wait(&t->cond, &t->lock);
+            continue;
+        }
+        int64_t wait = t->next_us - sim_time_us();
+        if(wait > 0)
+        {
+            sim_deadline(&ts, wait);
+            pthread_cond_timedwait(&t->cond, &t->lock, &ts);
+            continue;
+        }
+        if(t->period_us > 0)
+            t->next_us += t->period_us;
+        else
+            t->armed = false;
+        //the callback may stop or restart the timer
+        pthread_mutex_unlock(&t->lock);
+        t->callback(t->arg);
+        pthread_mutex_lock(&t->lock);
+    }
+    return NULL;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+    struct esp_timer *t = calloc(1, sizeof(*t));
+
+    if(t == NULL)
+        return ESP_ERR_NO_MEM;
+    t->callback = create_args->callback;
+    t->arg = create_args->arg;
+    pthread_mutex_init(&t->lock, NULL);
+    sim_cond_init(&t->cond);
+    if(pthread_create(&t->thread, NULL, timer_thread, t) != 0)
+        return ESP_ERR_NO_MEM;
+    pthread_detach(t->thread);
+    pthread_setname_np(t->thread, "esp_timer");
+    *out_handle = t;
+    return ESP_OK;
+}
+
+static esp_err_t timer_start(esp_timer_handle_t t, uint64_t us, uint64_t period)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&t->lock);
+    if(t->armed)
+    {
+        err = ESP_ERR_INVALID_STATE;
+    }
+    else
+    {
+        t->armed = true;
+        t->next_us = sim_time_us() + us;
+        t->period_us = period;
+        pthread_cond_signal(&t->cond);
+    }
+    pthread_mutex_unlock(&t->lock);
+    return err;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+    return timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+    return timer_start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&timer->lock);
+    if(!timer->armed)
+        err = ESP_ERR_INVALID_STATE;
+    timer->armed = false;
+    pthread_cond_signal(&timer->cond);
+    pthread_mutex_unlock(&timer->lock);
+    return err;
+}
+
+//
+//  Logging
+//
+
+static pthread_mutex_t log_lock = PTHREAD_MUTEX_INITIALIZER;
+
+uint32_t esp_log_timestamp(void)
+{
+    return sim_time_us() / 1000;
+}
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+{
+    va_list args;
+
+    va_start(args, format);
+    pthread_mutex_lock(&log_lock);
+    vprintf(format, args);
+    pthread_mutex_unlock(&log_lock);
+    va_end(args);
+}
+
+void esp_log_buffer_hex(const char *tag, const void *buffer, uint16_t buff_len)
+{
+    const uint8_t *p = buffer;
+
+    pthread_mutex_lock(&log_lock);
+    printf(LOG_COLOR_I "I (%u) %s:", (unsigned)esp_log_timestamp(), tag);
+    for(int i = 0; i < buff_len; i++)
+        printf(" %02x", p[i]);
+    printf(LOG_RESET_COLOR "\n");
+    pthread_mutex_unlock(&log_lock);
+}
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch(code)
+    {
+        case ESP_OK:                        return "ESP_OK";
+        case ESP_FAIL:                      return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NVS_NOT_INITIALIZED:   return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND:         return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_HANDLE:    return "ESP_ERR_NVS_INVALID_HANDLE";
+        case ESP_ERR_NVS_INVALID_LENGTH:    return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_NVS_NO_FREE_PAGES:     return "ESP_ERR_NVS_NO_FREE_PAGES";
+        case ESP_ERR_NVS_NEW_VERSION_FOUND: return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+        default:                            return "UNKNOWN ERROR";
+    }
+}
+
+//
+//  System
+//
+
+static uint8_t base_mac[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x00 };
+
+uint32_t esp_random(void)
+{
+    static uint32_t seed = 0x2545F491;
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    uint32_t x;
+
+    pthread_mutex_lock(&lock);
+    x = seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    seed = x;
+    pthread_mutex_unlock(&lock);
+    return x;
+}
+
+esp_err_t esp_base_mac_addr_set(uint8_t *mac)
+{
+    memcpy(base_mac, mac, sizeof(base_mac));
+    return ESP_OK;
+}
+
+const uint8_t *sim_base_mac(void)
+{
+    return base_mac;
+}
+
+//
+//  NVS, in memory for the life of the process
+//
+
+typedef struct {
+    char ns[NVS_KEY_LEN];
+    char key[NVS_KEY_LEN];
+    size_t len;
+    uint8_t data[NVS_BLOB_MAX];
+} nvs_entry_t;
+
+typedef struct {
+    bool open;
+    nvs_open_mode mode;
+    char ns[NVS_KEY_LEN];
+} nvs_slot_t;
+
+static pthread_mutex_t nvs_lock = PTHREAD_MUTEX_INITIALIZER;
+static bool nvs_ready;
+static nvs_entry_t nvs_entries[NVS_MAX_ENTRIES];
+static size_t nvs_count;
+static nvs_slot_t nvs_handles[NVS_MAX_HANDLES];
+
+esp_err_t nvs_flash_init(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_ready = true;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_count = 0;
+    pthread_mutex_unlock(&nvs_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode open_mode, nvs_handle *out_handle)
+{
+    esp_err_t err = ESP_ERR_NO_MEM;
+
+    if(strlen(name) >= NVS_KEY_LEN)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&nvs_lock);
+    if(!nvs_ready)
+    {
+        err = ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+    else
+    {
+        for(int i = 0; i < NVS_MAX_HANDLES; i++)
+        {
+            if(nvs_handles[i].open)
+                continue;
+            nvs_handles[i].open = true;
+            nvs_handles[i].mode = open_mode;
+            strcpy(nvs_handles[i].ns, name);
+            //handle 0 is never valid on the device either
+            *out_handle = i + 1;
+            err = ESP_OK;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+static nvs_slot_t *nvs_slot(nvs_handle handle)
+{
+    if(handle == 0 || handle > NVS_MAX_HANDLES || !nvs_handles[handle - 1].open)
+        return NULL;
+    return &nvs_handles[handle - 1];
+}
+
+static nvs_entry_t *nvs_find(const nvs_slot_t *slot, const char *key)
+{
+    for(size_t i = 0; i < nvs_count; i++)
+    {
+        if(strcmp(nvs_entries[i].ns, slot->ns) == 0 && strcmp(nvs_entries[i].key, key) == 0)
+            return &nvs_entries[i];
+    }
+    return NULL;
+}
+
+esp_err_t nvs_get_blob(nvs_handle handle, const char *key, void *out_value, size_t *length)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = nvs_slot(handle);
+    nvs_entry_t *e = slot != NULL ? nvs_find(slot, key) : NULL;
+    if(slot == NULL)
+    {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    else if(e == NULL)
+    {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    }
+    else if(out_value == NULL)
+    {
+        *length = e->len;
+    }
+    else if(*length < e->len)
+    {
+        *length = e->len;
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    }
+    else
+    {
+        memcpy(out_value, e->data, e->len);
+        *length = e->len;
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_set_blob(nvs_handle handle, const char *key, const void *value, size_t length)
+{
+    esp_err_t err = ESP_OK;
+
+    if(strlen(key) >= NVS_KEY_LEN || length > NVS_BLOB_MAX)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = nvs_slot(handle);
+    nvs_entry_t *e = slot != NULL ? nvs_find(slot, key) : NULL;
+    if(slot == NULL || slot->mode != NVS_READWRITE)
+    {
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    }
+    else
+    {
+        if(e == NULL && nvs_count < NVS_MAX_ENTRIES)
+        {
+            e = &nvs_entries[nvs_count++];
+            strcpy(e->ns, slot->ns);
+            strcpy(e->key, key);
+        }
+        if(e == NULL)
+        {
+            err = ESP_ERR_NVS_NO_FREE_PAGES;
+        }
+        else
+        {
+            memcpy(e->data, value, length);
+            e->len = length;
+        }
+    }
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle handle, const char *key)
+{
+    esp_err_t err = ESP_OK;
+
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = nvs_slot(handle);
+    nvs_entry_t *e = slot != NULL ? nvs_find(slot, key) : NULL;
+    if(slot == NULL || slot->mode != NVS_READWRITE)
+        err = ESP_ERR_NVS_INVALID_HANDLE;
+    else if(e == NULL)
+        err = ESP_ERR_NVS_NOT_FOUND;
+    else
+        *e = nvs_entries[--nvs_count];
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+esp_err_t nvs_commit(nvs_handle handle)
+{
+    esp_err_t err;
+
+    pthread_mutex_lock(&nvs_lock);
+    err = nvs_slot(handle) != NULL ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+    pthread_mutex_unlock(&nvs_lock);
+    return err;
+}
+
+void nvs_close(nvs_handle handle)
+{
+    pthread_mutex_lock(&nvs_lock);
+    nvs_slot_t *slot = nvs_slot(handle);
+    if(slot != NULL)
+        slot->open = false;
+    pthread_mutex_unlock(&nvs_lock);
+}
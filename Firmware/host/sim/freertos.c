@@ -0,0 +1,345 @@
+//
+//  FreeRTOS on POSIX threads
+//
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+#include "sim.h"
+
+//Longest a blocked task sleeps before it checks whether it was deleted
+#define SIM_TASK_SLICE_MS   10
+
+struct sim_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    char name[16];
+    BaseType_t core;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify;
+    volatile bool deleted;
+    struct sim_task *next;
+};
+
+struct sim_sem {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    UBaseType_t count;
+    UBaseType_t max;
+};
+
+static __thread struct sim_task *current;
+//every task ever created, deleted ones included
+static struct sim_task *tasks;
+static pthread_mutex_t tasks_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct timespec start_time;
+static pthread_once_t start_once = PTHREAD_ONCE_INIT;
+
+static void time_init(void)
+{
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+}
+
+int64_t sim_time_us(void)
+{
+    struct timespec now;
+
+    pthread_once(&start_once, time_init);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - start_time.tv_sec) * 1000000 + (now.tv_nsec - start_time.tv_nsec) / 1000;
+}
+
+void sim_cond_init(pthread_cond_t *cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+void sim_deadline(struct timespec *ts, int64_t us)
+{
+    clock_gettime(CLOCK_MONOTONIC, ts);
+    ts->tv_sec += us / 1000000;
+    ts->tv_nsec += (us % 1000000) * 1000;
+    if(ts->tv_nsec >= 1000000000)
+    {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000;
+    }
+}
+
+void sim_sleep_until(int64_t us)
+{
+    struct timespec ts;
+
+    sim_deadline(&ts, us - sim_time_us());
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+//Leaves the calling task, the handle stays allocated since other tasks
+//may still hold it
+static void task_exit(void)
+{
+    pthread_exit(NULL);
+}
+
+//Waits on cond (lock held) until woken or the deadline passed. Returns
+//false on timeout. A task deleted meanwhile does not return.
+static bool task_wait(pthread_mutex_t *lock, pthread_cond_t *cond, TickType_t ticks, int64_t end_us)
+{
+    struct timespec ts;
+    int64_t slice = SIM_TASK_SLICE_MS * 1000;
+
+    if(current != NULL && current->deleted)
+    {
+        pthread_mutex_unlock(lock);
+        task_exit();
+    }
+    if(ticks != portMAX_DELAY)
+    {
+        int64_t left = end_us - sim_time_us();
+        if(left <= 0)
+            return false;
+        if(left < slice)
+            slice = left;
+    }
+    sim_deadline(&ts, slice);
+    pthread_cond_timedwait(cond, lock, &ts);
+    if(current != NULL && current->deleted)
+    {
+        pthread_mutex_unlock(lock);
+        task_exit();
+    }
+    return true;
+}
+
+static int64_t ticks_end(TickType_t ticks)
+{
+    return sim_time_us() + (int64_t)ticks * portTICK_PERIOD_MS * 1000;
+}
+
+static void *task_main(void *arg)
+{
+    struct sim_task *task = arg;
+
+    current = task;
+    task->fn(task->arg);
+    //returning from a task function is a bug on the device
+    fprintf(stderr, "sim: task %s returned\n", task->name);
+    abort();
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *created, BaseType_t core)
+{
+    struct sim_task *task = calloc(1, sizeof(*task));
+    pthread_attr_t attr;
+
+    if(task == NULL)
+        return pdFAIL;
+    task->fn = fn;
+    task->arg = arg;
+    snprintf(task->name, sizeof(task->name), "%s", name);
+    task->core = core == tskNO_AFFINITY ? 0 : core;
+    pthread_mutex_init(&task->lock, NULL);
+    sim_cond_init(&task->cond);
+
+    pthread_mutex_lock(&tasks_lock);
+    task->next = tasks;
+    tasks = task;
+    pthread_mutex_unlock(&tasks_lock);
+    //publish the handle before the task runs, it may be used right away
+    if(created != NULL)
+        *created = task;
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if(pthread_create(&task->thread, &attr, task_main, task) != 0)
+    {
+        fprintf(stderr, "sim: cannot start task %s\n", name);
+        abort();
+    }
+    pthread_attr_destroy(&attr);
+    pthread_setname_np(task->thread, task->name);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    if(task == NULL && current == NULL)
+    {
+        //would delete the Bluedroid task on the device
+        fprintf(stderr, "sim: vTaskDelete(NULL) outside of a task\n");
+        abort();
+    }
+    if(task == NULL || task == current)
+        task_exit();
+    task->deleted = true;
+    pthread_mutex_lock(&task->lock);
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    struct sim_task *task = current;
+    int64_t end = ticks_end(ticks);
+    struct timespec ts;
+
+    if(task == NULL)
+    {
+        //not a task (the runner), nothing can delete it
+        sim_deadline(&ts, end - sim_time_us());
+        while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+            ;
+        return;
+    }
+    pthread_mutex_lock(&task->lock);
+    while(task_wait(&task->lock, &task->cond, ticks, end))
+        ;
+    pthread_mutex_unlock(&task->lock);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return sim_time_us() / 1000 / portTICK_PERIOD_MS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return current;
+}
+
+BaseType_t xPortGetCoreID(void)
+{
+    return current != NULL ? current->core : 0;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks)
+{
+    struct sim_task *task = current;
+    int64_t end = ticks_end(ticks);
+    uint32_t value;
+
+    pthread_mutex_lock(&task->lock);
+    while(task->notify == 0 && task_wait(&task->lock, &task->cond, ticks, end))
+        ;
+    value = task->notify;
+    if(value > 0)
+        task->notify = clear_on_exit ? 0 : value - 1;
+    pthread_mutex_unlock(&task->lock);
+    return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    pthread_mutex_lock(&task->lock);
+    task->notify++;
+    pthread_cond_broadcast(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    xTaskNotifyGive(task);
+    if(woken != NULL)
+        *woken = pdTRUE;
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+    struct sim_sem *sem = calloc(1, sizeof(*sem));
+
+    if(sem == NULL)
+        return NULL;
+    pthread_mutex_init(&sem->lock, NULL);
+    sim_cond_init(&sem->cond);
+    sem->max = max_count;
+    sem->count = initial_count;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+    return xSemaphoreCreateCounting(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return xSemaphoreCreateCounting(1, 1);
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    free(sem);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks)
+{
+    int64_t end = ticks_end(ticks);
+    BaseType_t taken = pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    while(sem->count == 0 && task_wait(&sem->lock, &sem->cond, ticks, end))
+        ;
+    if(sem->count > 0)
+    {
+        sem->count--;
+        taken = pdTRUE;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return taken;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    BaseType_t given = pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    if(sem->count < sem->max)
+    {
+        sem->count++;
+        given = pdTRUE;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return given;
+}
+
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken)
+{
+    BaseType_t given = xSemaphoreGive(sem);
+
+    if(woken != NULL)
+        *woken = given;
+    return given;
+}
+
+static void (*main_fn)(void);
+
+static void main_task(void *arg)
+{
+    main_fn();
+    vTaskDelete(NULL);
+}
+
+void sim_start(void (*app_main_fn)(void))
+{
+    main_fn = app_main_fn;
+    //the IDF main task runs app_main on core 0 at priority 1
+    xTaskCreatePinnedToCore(main_task, "main", 3584, NULL, 1, NULL, 0);
+}
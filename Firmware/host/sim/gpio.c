@@ -0,0 +1,72 @@
+//
+//  GPIO driver on the host
+//
+
+#include <stddef.h>
+
+#include "driver/gpio.h"
+#include "rom/ets_sys.h"
+
+#include "sim.h"
+
+gpio_dev_t GPIO;
+
+static uint8_t out_level[GPIO_NUM_MAX];
+
+//Firmwares without a shift register pad ignore their pins
+__attribute__((weak)) void sim_gpio_output(int pin, uint32_t level)
+{
+}
+
+esp_err_t gpio_config(const gpio_config_t *config)
+{
+    return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin(gpio_num_t gpio_num)
+{
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio_num, gpio_mode_t mode)
+{
+    return gpio_num >= 0 && gpio_num < GPIO_NUM_MAX ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t gpio_set_level(gpio_num_t gpio_num, uint32_t level)
+{
+    if(gpio_num < 0 || gpio_num >= GPIO_NUM_MAX)
+        return ESP_ERR_INVALID_ARG;
+    level = level != 0;
+    if(out_level[gpio_num] != level)
+    {
+        out_level[gpio_num] = level;
+        sim_gpio_output(gpio_num, level);
+    }
+    return ESP_OK;
+}
+
+int gpio_get_level(gpio_num_t gpio_num)
+{
+    if(gpio_num < 32)
+        return (GPIO.in >> gpio_num) & 1;
+    return (GPIO.in1.data >> (gpio_num - 32)) & 1;
+}
+
+void sim_gpio_drive(int pin, uint32_t level)
+{
+    if(pin < 32)
+        GPIO.in = level ? GPIO.in | (1u << pin) : GPIO.in & ~(1u << pin);
+    else if(level)
+        GPIO.in1.data |= 1u << (pin - 32);
+    else
+        GPIO.in1.data &= ~(1u << (pin - 32));
+}
+
+void ets_delay_us(uint32_t us)
+{
+    int64_t end = sim_time_us() + us;
+
+    while(sim_time_us() < end)
+        ;
+}
@@ -0,0 +1,14 @@
+//
+//  Host stand-in for driver/periph_ctrl.h
+//
+
+#ifndef DRIVER_PERIPH_CTRL_H
+#define DRIVER_PERIPH_CTRL_H
+
+typedef enum {
+    PERIPH_RMT_MODULE,
+} periph_module_t;
+
+static inline void periph_module_enable(periph_module_t periph) { (void)periph; }
+
+#endif
@@ -0,0 +1,11 @@
+//
+//  Host stand-in for esp_attr.h
+//
+
+#ifndef ESP_ATTR_H
+#define ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif
@@ -0,0 +1,17 @@
+//
+//  Host stand-in for esp_bt_device.h
+//
+
+#ifndef ESP_BT_DEVICE_H
+#define ESP_BT_DEVICE_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+//Derived from the base MAC set with esp_base_mac_addr_set(), as on the device
+const uint8_t *esp_bt_dev_get_address(void);
+esp_err_t esp_bt_dev_set_device_name(const char *name);
+
+#endif
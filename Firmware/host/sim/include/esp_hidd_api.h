@@ -0,0 +1,70 @@
+//
+//  Host stand-in for esp_hidd_api.h (Bluedroid classic HID device)
+//
+//  The callbacks are driven by the virtual host in host/sim/bt.c, reports
+//  the firmware sends are handed to it.
+//
+
+#ifndef ESP_HIDD_API_H
+#define ESP_HIDD_API_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_bt_defs.h"
+
+typedef enum {
+    ESP_HIDD_APP_STATE_NOT_REGISTERED,
+    ESP_HIDD_APP_STATE_REGISTERED,
+} esp_hidd_application_state_t;
+
+typedef enum {
+    ESP_HIDD_CONN_STATE_CONNECTED,
+    ESP_HIDD_CONN_STATE_CONNECTING,
+    ESP_HIDD_CONN_STATE_DISCONNECTED,
+    ESP_HIDD_CONN_STATE_DISCONNECTING,
+    ESP_HIDD_CONN_STATE_UNKNOWN,
+} esp_hidd_connection_state_t;
+
+typedef enum {
+    ESP_HIDD_REPORT_TYPE_OTHER,
+    ESP_HIDD_REPORT_TYPE_INPUT,
+    ESP_HIDD_REPORT_TYPE_OUTPUT,
+    ESP_HIDD_REPORT_TYPE_FEATURE,
+    ESP_HIDD_REPORT_TYPE_INTRDATA,
+} esp_hidd_report_type_t;
+
+typedef struct {
+    const char *name;
+    const char *description;
+    const char *provider;
+    uint8_t subclass;
+    const uint8_t *desc_list;
+    int desc_list_len;
+} esp_hidd_app_param_t;
+
+typedef struct {
+    uint8_t service_type;
+    uint32_t token_rate;
+    uint32_t token_bucket_size;
+    uint32_t peak_bandwidth;
+    uint32_t access_latency;
+    uint32_t delay_variation;
+} esp_hidd_qos_param_t;
+
+typedef struct {
+    void (*application_state_cb)(esp_bd_addr_t bd_addr, esp_hidd_application_state_t state);
+    void (*connection_state_cb)(esp_bd_addr_t bd_addr, esp_hidd_connection_state_t state);
+    void (*get_report_cb)(uint8_t type, uint8_t id, uint16_t buffer_size);
+    void (*set_report_cb)(uint8_t type, uint8_t id, uint16_t len, uint8_t *p_data);
+    void (*set_protocol_cb)(uint8_t protocol);
+    void (*intr_data_cb)(uint8_t report_id, uint16_t len, uint8_t *p_data);
+    void (*vc_unplug_cb)(void);
+} esp_hidd_callbacks_t;
+
+esp_err_t esp_hid_device_register_app(esp_hidd_app_param_t *app_param, esp_hidd_qos_param_t *in_qos,
+                                      esp_hidd_qos_param_t *out_qos);
+esp_err_t esp_hid_device_init(esp_hidd_callbacks_t *callbacks);
+esp_err_t esp_hid_device_send_report(esp_hidd_report_type_t type, uint8_t id, uint16_t len, uint8_t *data);
+
+#endif
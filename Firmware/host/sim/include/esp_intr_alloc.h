@@ -0,0 +1,14 @@
+//
+//  Host stand-in for esp_intr_alloc.h
+//
+
+#ifndef ESP_INTR_ALLOC_H
+#define ESP_INTR_ALLOC_H
+
+#include "esp_attr.h"
+#include "esp_err.h"
+
+typedef struct intr_handle_data_t *intr_handle_t;
+typedef void (*intr_handler_t)(void *arg);
+
+#endif
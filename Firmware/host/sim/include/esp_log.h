@@ -0,0 +1,56 @@
+//
+//  Host stand-in for esp_log.h, prints like the IDF monitor does
+//
+
+#ifndef ESP_LOG_H
+#define ESP_LOG_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+//CONFIG_LOG_DEFAULT_LEVEL of the Switch firmwares
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL         ESP_LOG_INFO
+#endif
+
+#define LOG_COLOR_BLACK         "30"
+#define LOG_COLOR_RED           "31"
+#define LOG_COLOR_GREEN         "32"
+#define LOG_COLOR_BROWN         "33"
+#define LOG_COLOR(COLOR)        "\033[0;" COLOR "m"
+#define LOG_RESET_COLOR         "\033[0m"
+#define LOG_COLOR_E             LOG_COLOR(LOG_COLOR_RED)
+#define LOG_COLOR_W             LOG_COLOR(LOG_COLOR_BROWN)
+#define LOG_COLOR_I             LOG_COLOR(LOG_COLOR_GREEN)
+#define LOG_COLOR_D
+#define LOG_COLOR_V
+
+//Milliseconds since the program started
+uint32_t esp_log_timestamp(void);
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+void esp_log_buffer_hex(const char *tag, const void *buffer, uint16_t buff_len);
+
+#define LOG_FORMAT(letter, format)  LOG_COLOR_ ## letter #letter " (%u) %s: " format LOG_RESET_COLOR "\n"
+
+#define ESP_LOG_LEVEL_LOCAL(level, letter, tag, format, ...) do { \
+        if(LOG_LOCAL_LEVEL >= (level)) \
+            esp_log_write(level, tag, LOG_FORMAT(letter, format), (unsigned)esp_log_timestamp(), tag, ##__VA_ARGS__); \
+    } while(0)
+
+#define ESP_LOGE(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_ERROR, E, tag, format, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_WARN, W, tag, format, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_INFO, I, tag, format, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_DEBUG, D, tag, format, ##__VA_ARGS__)
+#define ESP_LOGV(tag, format, ...)  ESP_LOG_LEVEL_LOCAL(ESP_LOG_VERBOSE, V, tag, format, ##__VA_ARGS__)
+
+#endif
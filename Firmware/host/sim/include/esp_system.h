@@ -0,0 +1,15 @@
+//
+//  Host stand-in for esp_system.h
+//
+
+#ifndef ESP_SYSTEM_H
+#define ESP_SYSTEM_H
+
+#include <stdint.h>
+
+#include "esp_err.h"
+
+uint32_t esp_random(void);
+esp_err_t esp_base_mac_addr_set(uint8_t *mac);
+
+#endif
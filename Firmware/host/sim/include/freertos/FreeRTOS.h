@@ -0,0 +1,49 @@
+//
+//  Host stand-in for FreeRTOS.h (ESP-IDF SMP port)
+//
+//  Tasks are POSIX threads, see host/sim/freertos.c. A critical section
+//  is a recursive mutex: it keeps the other threads out of the data it
+//  guards, but unlike on the device it does not stop the scheduler.
+//
+
+#ifndef FREERTOS_H
+#define FREERTOS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "esp_attr.h"
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+
+//CONFIG_FREERTOS_HZ of the Switch firmwares
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define portMAX_DELAY           ((TickType_t)0xffffffffUL)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms) * configTICK_RATE_HZ / 1000)
+
+typedef struct {
+    pthread_mutex_t lock;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP }
+
+#define portENTER_CRITICAL(mux)         pthread_mutex_lock(&(mux)->lock)
+#define portEXIT_CRITICAL(mux)          pthread_mutex_unlock(&(mux)->lock)
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+#define portYIELD_FROM_ISR()            do {} while(0)
+
+//Core the calling task was pinned to, 0 for unpinned tasks
+BaseType_t xPortGetCoreID(void);
+
+#endif
@@ -0,0 +1,13 @@
+//
+//  Host stand-in for rom/ets_sys.h
+//
+
+#ifndef ROM_ETS_SYS_H
+#define ROM_ETS_SYS_H
+
+#include <stdint.h>
+
+//Busy waits, like the ROM function does
+void ets_delay_us(uint32_t us);
+
+#endif
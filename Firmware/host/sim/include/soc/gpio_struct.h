@@ -0,0 +1,23 @@
+//
+//  Host stand-in for soc/gpio_struct.h, only the input registers
+//
+
+#ifndef SOC_GPIO_STRUCT_H
+#define SOC_GPIO_STRUCT_H
+
+#include <stdint.h>
+
+typedef volatile struct {
+    uint32_t in;                // GPIO0..31
+    union {
+        struct {
+            uint32_t data: 8;   // GPIO32..39
+            uint32_t reserved8: 24;
+        };
+        uint32_t val;
+    } in1;
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#endif
@@ -0,0 +1,17 @@
+//
+//  Host stand-in for soc/rmt_reg.h
+//
+
+#ifndef SOC_RMT_REG_H
+#define SOC_RMT_REG_H
+
+#include <stdint.h>
+
+//64 items per channel, a channel with mem_block_num > 1 runs on into the
+//blocks of the following channels as on the device
+#define RMT_MEM_ITEM_NUM        64
+extern uint32_t sim_rmt_mem[8 * RMT_MEM_ITEM_NUM];
+
+#define RMT_CHANNEL_MEM(i)      (&sim_rmt_mem[(i) * RMT_MEM_ITEM_NUM])
+
+#endif
@@ -0,0 +1,32 @@
+//
+//  Host stand-in for soc/rmt_struct.h, only the registers joybus_rmt.c
+//  touches
+//
+
+#ifndef SOC_RMT_STRUCT_H
+#define SOC_RMT_STRUCT_H
+
+#include <stdint.h>
+
+typedef volatile struct {
+    struct {
+        union {
+            struct {
+                uint32_t tx_start: 1;
+                uint32_t rx_en: 1;
+                uint32_t reserved2: 30;
+            };
+            uint32_t val;
+        } conf1;
+    } conf_ch[8];
+    union {
+        uint32_t val;           // tx_end, rx_end, err for each channel in turn
+    } int_st;
+    union {
+        uint32_t val;
+    } int_clr;
+} rmt_dev_t;
+
+extern rmt_dev_t RMT;
+
+#endif
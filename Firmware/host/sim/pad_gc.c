@@ -0,0 +1,84 @@
+//
+//  Virtual GameCube controller on the Joybus
+//
+//  Answers identify, origin, recalibrate and poll. Polls are answered in
+//  the mode 3 layout whatever analog mode is asked for, the mode the
+//  firmware uses by default.
+//
+
+#include <string.h>
+
+#include "gc_frame.h"
+#include "joybus_cmd.h"
+
+#include "sim.h"
+
+#define GC_TRIGGER_REST     0x20
+
+const char *const sim_pad_name = "GameCube";
+
+static pthread_mutex_t pad_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_pad_state_t pad;
+static bool plugged;
+
+void sim_pad_set(const sim_pad_state_t *state)
+{
+    pthread_mutex_lock(&pad_lock);
+    pad = *state;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+void sim_pad_plug(bool state)
+{
+    pthread_mutex_lock(&pad_lock);
+    plugged = state;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+static void status_word(const sim_pad_state_t *s, uint8_t *status)
+{
+    status[GC_BYTE_BUTTONS0] = 0x20 | (s->a ? GC_BTN_A : 0);
+    status[GC_BYTE_BUTTONS1] = 0x80;
+    status[GC_BYTE_LX] = 0x80 + s->x;
+    status[GC_BYTE_LY] = 0x80 + s->y;
+    status[GC_BYTE_CX] = 0x80;
+    status[GC_BYTE_CY] = 0x80;
+    status[GC_BYTE_L_ANALOG] = GC_TRIGGER_REST;
+    status[GC_BYTE_R_ANALOG] = GC_TRIGGER_REST;
+}
+
+int sim_joybus_respond(const uint8_t *cmd, uint8_t cmd_len, uint8_t *response)
+{
+    static const sim_pad_state_t neutral;
+    sim_pad_state_t s;
+
+    pthread_mutex_lock(&pad_lock);
+    bool present = plugged;
+    s = pad;
+    pthread_mutex_unlock(&pad_lock);
+    if(!present)
+        return -1;
+
+    switch(cmd[0])
+    {
+        case 0x00:  // identify
+        case 0xFF:  // reset
+            response[0] = JOYBUS_TYPE_GC >> 8;
+            response[1] = JOYBUS_TYPE_GC & 0xFF;
+            response[2] = 0x00;
+            return 3;
+        case 0x41:  // origin
+        case 0x42:  // recalibrate
+            status_word(&neutral, response);
+            response[GC_STATUS_LEN] = 0;
+            response[GC_STATUS_LEN + 1] = 0;
+            return GC_STATUS_LEN + 2;
+        case 0x40:  // poll
+            if(cmd_len != 3)
+                return -1;
+            status_word(&s, response);
+            return GC_STATUS_LEN;
+        default:
+            return -1;
+    }
+}
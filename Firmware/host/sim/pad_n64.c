@@ -0,0 +1,58 @@
+//
+//  Virtual N64 controller on the Joybus, nothing in the accessory slot
+//
+
+#include "joybus_cmd.h"
+#include "n64_frame.h"
+
+#include "sim.h"
+
+const char *const sim_pad_name = "N64";
+
+static pthread_mutex_t pad_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_pad_state_t pad;
+static bool plugged;
+
+void sim_pad_set(const sim_pad_state_t *state)
+{
+    pthread_mutex_lock(&pad_lock);
+    pad = *state;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+void sim_pad_plug(bool state)
+{
+    pthread_mutex_lock(&pad_lock);
+    plugged = state;
+    pthread_mutex_unlock(&pad_lock);
+}
+
+int sim_joybus_respond(const uint8_t *cmd, uint8_t cmd_len, uint8_t *response)
+{
+    sim_pad_state_t s;
+
+    pthread_mutex_lock(&pad_lock);
+    bool present = plugged;
+    s = pad;
+    pthread_mutex_unlock(&pad_lock);
+    if(!present)
+        return -1;
+
+    switch(cmd[0])
+    {
+        case 0x00:  // identify
+        case 0xFF:  // reset
+            response[0] = JOYBUS_TYPE_N64 >> 8;
+            response[1] = JOYBUS_TYPE_N64 & 0xFF;
+            response[2] = JOYBUS_N64_PAK_ABSENT;
+            return 3;
+        case 0x01:  // poll
+            response[N64_BYTE_BUTTONS0] = s.a ? N64_BTN_A : 0;
+            response[N64_BYTE_BUTTONS1] = 0;
+            response[N64_BYTE_X] = (uint8_t)s.x;
+            response[N64_BYTE_Y] = (uint8_t)s.y;
+            return N64_STATUS_LEN;
+        default:
+            return -1;
+    }
+}
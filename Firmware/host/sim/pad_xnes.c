@@ -0,0 +1,55 @@
+//
+//  Virtual NES pad behind the XNES shift register reader
+//
+//  Wired like BlueXNESMod's defaults: a rising latch loads the buttons, the
+//  data line shows the first one (low when pressed) and every rising clock
+//  shifts the next one out. A pad that ran out of bits reads released.
+//
+
+#include "sim.h"
+
+#ifndef SIM_XNES_LATCH
+#define SIM_XNES_LATCH  13
+#endif
+#ifndef SIM_XNES_CLOCK
+#define SIM_XNES_CLOCK  14
+#endif
+#ifndef SIM_XNES_DATA
+#define SIM_XNES_DATA   15
+#endif
+
+#define NES_BTN_A       0x01    // first bit shifted out
+
+const char *const sim_pad_name = "NES";
+
+static volatile uint32_t buttons;
+static volatile bool plugged;
+static uint32_t shift;
+
+void sim_pad_set(const sim_pad_state_t *state)
+{
+    //a d-pad only pad, the stick is ignored
+    __atomic_store_n(&buttons, state->a ? NES_BTN_A : 0, __ATOMIC_RELAXED);
+}
+
+void sim_pad_plug(bool state)
+{
+    __atomic_store_n(&plugged, state, __ATOMIC_RELAXED);
+    //nothing pulls the data line down without a pad, it reads all released
+    if(!state)
+        sim_gpio_drive(SIM_XNES_DATA, 1);
+}
+
+//Runs in the reader's thread, from gpio_set_level()
+void sim_gpio_output(int pin, uint32_t level)
+{
+    if(!__atomic_load_n(&plugged, __ATOMIC_RELAXED))
+        return;
+    if(pin == SIM_XNES_LATCH && level)
+        shift = __atomic_load_n(&buttons, __ATOMIC_RELAXED);
+    else if(pin == SIM_XNES_CLOCK && level)
+        shift >>= 1;
+    else
+        return;
+    sim_gpio_drive(SIM_XNES_DATA, !(shift & 1));
+}
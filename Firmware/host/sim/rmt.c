@@ -0,0 +1,231 @@
+//
+//  RMT driver on the host, wired to a virtual Joybus controller
+//
+//  A bus thread plays the data line: once rmt_rx_start() armed the
+//  receiver it decodes the command the TX channel holds, asks the pad for
+//  its answer, waits as long as the frame takes on the wire (4us per bit
+//  plus the RX idle threshold) and then writes the RX frame, command echo
+//  included, into channel memory and raises the RX end interrupt.
+//
+
+#include <string.h>
+
+#include "driver/rmt.h"
+#include "joybus_cmd.h"
+#include "joybus_rmt.h"
+
+#include "sim.h"
+
+#define BIT_US              4
+//the controller answers about 4us after the console's stop bit
+#define TURNAROUND_US       4
+
+rmt_dev_t RMT;
+uint32_t sim_rmt_mem[8 * RMT_MEM_ITEM_NUM];
+
+static pthread_mutex_t bus_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t bus_cond;
+static pthread_once_t bus_once = PTHREAD_ONCE_INIT;
+static pthread_t bus_thread;
+
+static rmt_config_t channels[RMT_CHANNEL_MAX];
+static void (*isr_fn)(void *);
+static void *isr_arg;
+static uint32_t rx_intr_mask;
+
+static uint8_t tx_items_count;
+static uint32_t tx_items[JOYBUS_CMD_MAX_ITEMS];
+static int rx_pending = -1;         // RX channel armed by rmt_rx_start()
+static uint32_t rx_generation;      // bumped by every start and stop
+
+//Joybus-less firmwares (XNES) only configure the channels
+__attribute__((weak)) int sim_joybus_respond(const uint8_t *cmd, uint8_t cmd_len, uint8_t *response)
+{
+    return -1;
+}
+
+static uint32_t *put_byte(uint32_t *p, uint8_t b)
+{
+    for(int bit = 7; bit >= 0; bit--)
+        *p++ = (b >> bit) & 1 ? JOYBUS_ITEM_ONE : JOYBUS_ITEM_ZERO;
+    return p;
+}
+
+//Command bytes from TX items, false if an item is not a Joybus bit cell
+static bool decode_command(uint8_t *cmd, uint8_t *len)
+{
+    int items = 0;
+
+    while(items < tx_items_count && (tx_items[items] & 0x7FFF) != 0)
+        items++;
+    //the last item before the end marker is the stop bit
+    int bits = items - 1;
+    if(bits <= 0 || bits % 8 != 0 || bits > JOYBUS_CMD_MAX_LEN * 8)
+        return false;
+    memset(cmd, 0, JOYBUS_CMD_MAX_LEN);
+    for(int i = 0; i < bits; i++)
+    {
+        uint32_t d0 = tx_items[i] & 0x7FFF;
+        uint32_t d1 = (tx_items[i] >> 16) & 0x7FFF;
+        if(d0 + d1 != BIT_US)
+            return false;
+        if(d0 < d1)
+            cmd[i / 8] |= 0x80 >> (i % 8);
+    }
+    *len = bits / 8;
+    return true;
+}
+
+static void *bus_main(void *arg)
+{
+    uint8_t cmd[JOYBUS_CMD_MAX_LEN];
+    uint8_t response[JOYBUS_RESPONSE_MAX_LEN];
+    uint32_t frame[JOYBUS_CMD_MAX_ITEMS + JOYBUS_RESPONSE_MAX_LEN * 8 + 2];
+    struct timespec ts;
+
+    pthread_mutex_lock(&bus_lock);
+    while(1)
+    {
+        while(rx_pending < 0)
+            pthread_cond_wait(&bus_cond, &bus_lock);
+        int channel = rx_pending;
+        uint32_t generation = rx_generation;
+        uint8_t cmd_len = 0;
+        int len = decode_command(cmd, &cmd_len) ? sim_joybus_respond(cmd, cmd_len, response) : -1;
+        if(len < 0)
+        {
+            //nobody answers, the receiver runs until it is stopped
+            while(rx_pending >= 0 && rx_generation == generation)
+                pthread_cond_wait(&bus_cond, &bus_lock);
+            continue;
+        }
+
+        uint32_t *p = frame;
+        for(int i = 0; i < cmd_len; i++)
+            p = put_byte(p, cmd[i]);
+        *p++ = JOYBUS_ITEM(1, 1 + TURNAROUND_US);
+        for(int i = 0; i < len; i++)
+            p = put_byte(p, response[i]);
+        //controller stop bit, then the line idles until the receiver gives up
+        *p++ = JOYBUS_ITEM(1, 0);
+        *p++ = 0;
+        int64_t wire_us = (cmd_len * 8 + 1 + len * 8 + 1) * BIT_US + TURNAROUND_US + JOYBUS_RX_IDLE_US;
+
+        sim_deadline(&ts, wire_us);
+        while(rx_generation == generation &&
+              pthread_cond_timedwait(&bus_cond, &bus_lock, &ts) == 0)
+            ;
+        //stopped (timed out on the other side) or restarted meanwhile
+        if(rx_generation != generation || !RMT.conf_ch[channel].conf1.rx_en)
+            continue;
+        memcpy(RMT_CHANNEL_MEM(channel), frame, (p - frame) * sizeof(frame[0]));
+        rx_pending = -1;
+        if(isr_fn != NULL && (rx_intr_mask & (1u << channel)))
+        {
+            RMT.int_st.val |= 1u << (channel * 3 + 1);
+            isr_fn(isr_arg);
+            RMT.int_st.val &= ~RMT.int_clr.val;
+            RMT.int_clr.val = 0;
+        }
+    }
+    return NULL;
+}
+
+static void bus_init(void)
+{
+    sim_cond_init(&bus_cond);
+    pthread_create(&bus_thread, NULL, bus_main, NULL);
+    pthread_detach(bus_thread);
+    pthread_setname_np(bus_thread, "joybus");
+}
+
+esp_err_t rmt_config(const rmt_config_t *config)
+{
+    if(config->channel < 0 || config->channel >= RMT_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    if(config->channel + config->mem_block_num > RMT_CHANNEL_MAX)
+        return ESP_ERR_INVALID_ARG;
+    pthread_once(&bus_once, bus_init);
+    pthread_mutex_lock(&bus_lock);
+    channels[config->channel] = *config;
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rx_buf_size, int intr_alloc_flags)
+{
+    return ESP_OK;
+}
+
+esp_err_t rmt_isr_register(void (*fn)(void *), void *arg, int intr_alloc_flags, rmt_isr_handle_t *handle)
+{
+    pthread_mutex_lock(&bus_lock);
+    isr_fn = fn;
+    isr_arg = arg;
+    pthread_mutex_unlock(&bus_lock);
+    if(handle != NULL)
+        *handle = NULL;
+    return ESP_OK;
+}
+
+esp_err_t rmt_set_rx_intr_en(rmt_channel_t channel, bool en)
+{
+    pthread_mutex_lock(&bus_lock);
+    if(en)
+        rx_intr_mask |= 1u << channel;
+    else
+        rx_intr_mask &= ~(1u << channel);
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_fill_tx_items(rmt_channel_t channel, const rmt_item32_t *item, uint16_t item_num, uint16_t mem_offset)
+{
+    if(mem_offset + item_num > RMT_MEM_ITEM_NUM * channels[channel].mem_block_num)
+        return ESP_ERR_INVALID_ARG;
+    pthread_mutex_lock(&bus_lock);
+    for(int i = 0; i < item_num; i++)
+        RMT_CHANNEL_MEM(channel)[mem_offset + i] = item[i].val;
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_tx_start(rmt_channel_t channel, bool tx_idx_rst)
+{
+    const uint32_t *mem = RMT_CHANNEL_MEM(channel);
+
+    //the transmitter runs up to the end marker
+    pthread_mutex_lock(&bus_lock);
+    tx_items_count = 0;
+    while(tx_items_count < JOYBUS_CMD_MAX_ITEMS && tx_items_count < RMT_MEM_ITEM_NUM)
+    {
+        tx_items[tx_items_count] = mem[tx_items_count];
+        if((mem[tx_items_count++] & 0x7FFF) == 0)
+            break;
+    }
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_start(rmt_channel_t channel, bool rx_idx_rst)
+{
+    pthread_mutex_lock(&bus_lock);
+    RMT.conf_ch[channel].conf1.rx_en = 1;
+    rx_pending = channel;
+    rx_generation++;
+    pthread_cond_broadcast(&bus_cond);
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop(rmt_channel_t channel)
+{
+    pthread_mutex_lock(&bus_lock);
+    RMT.conf_ch[channel].conf1.rx_en = 0;
+    if(rx_pending == channel)
+        rx_pending = -1;
+    rx_generation++;
+    pthread_cond_broadcast(&bus_cond);
+    pthread_mutex_unlock(&bus_lock);
+    return ESP_OK;
+}
@@ -0,0 +1,80 @@
+//
+//  POSIX host build of the firmwares
+//
+//  The real main.c of a Switch firmware and the real components are built
+//  against the stand-in IDF headers in sim/include. This header is the
+//  other side: what the runners (sim_main.c, switch_host.c) use to play
+//  the console and the controller, and what the stand-ins share between
+//  each other.
+//
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "latency_hist.h"
+
+//Clock shared by esp_timer_get_time(), the log timestamps and the tick count
+int64_t sim_time_us(void);
+//Condition variables wait on the monotonic clock
+void sim_cond_init(pthread_cond_t *cond);
+void sim_deadline(struct timespec *ts, int64_t us);
+//Sleeps until sim_time_us() reaches us, for the runner thread only
+void sim_sleep_until(int64_t us);
+
+//Base MAC set by the firmware, the Bluetooth address is derived from it
+const uint8_t *sim_base_mac(void);
+
+//Starts app_main() in its own task, like the IDF main task
+void sim_start(void (*app_main_fn)(void));
+
+//Runner statistics (sim/stats.c), printed as "sim: name n .. avg .. max .."
+void sim_hist_add(latency_hist_t *h, int64_t us);
+//Upper end of the bucket that holds the given fraction (per mille) of the samples
+uint32_t sim_hist_percentile(const latency_hist_t *h, uint32_t per_mille);
+void sim_hist_print(const char *name, const latency_hist_t *h);
+
+//
+//  Virtual host (sim/bt.c)
+//
+
+//Gets every report the firmware sends, from the thread that sent it
+typedef void (*sim_report_fn)(uint8_t report_id, const uint8_t *data, uint16_t len, int64_t time_us);
+
+void sim_bt_set_report_cb(sim_report_fn fn);
+//Waits until the HID app is registered and the device is connectable
+bool sim_bt_wait_connectable(uint32_t timeout_ms);
+//Authentication and connection callbacks, as a host pairing with the device
+bool sim_bt_connect(void);
+void sim_bt_disconnect(void);
+//Hands an output report to intr_data_cb, in the calling thread
+void sim_bt_output(const uint8_t *data, uint16_t len);
+
+//
+//  Virtual controller (sim/pad_*.c, one per firmware)
+//
+
+typedef struct {
+    bool a;                     // the button that maps to Switch A
+    int8_t x;                   // main stick, -128..127, up is positive
+    int8_t y;
+} sim_pad_state_t;
+
+//Name printed by the runner
+extern const char *const sim_pad_name;
+void sim_pad_set(const sim_pad_state_t *state);
+void sim_pad_plug(bool plugged);
+
+//Joybus pads: answers a command, returns the response length or -1 when
+//nothing answers (unplugged, unknown command)
+int sim_joybus_respond(const uint8_t *cmd, uint8_t cmd_len, uint8_t *response);
+//Shift register pads: an output pin changed level
+void sim_gpio_output(int pin, uint32_t level);
+//Shift register pads: drives an input pin
+void sim_gpio_drive(int pin, uint32_t level);
+
+#endif
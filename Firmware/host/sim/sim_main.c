@@ -0,0 +1,230 @@
+//
+//  sim - runs a Switch firmware on the host
+//
+//  Usage:
+//    fw_<name> [-t seconds] [-p ms] [-u ms] [-s seed]
+//
+//  Starts the firmware's app_main() on POSIX threads, connects to it as
+//  the console once it is discoverable, sends the MCU config subcommand
+//  that ends pairing and then plays the controller: A is pressed or
+//  released with a random stick position every -p ms (default 100), -u
+//  unplugs the controller for a moment every that many ms. After -t
+//  seconds (default 5) it prints the report rate, the spacing of the
+//  0x30 reports and how long an A press took to show up in one.
+//
+//  The firmware's own log goes to stdout as on the device, the summary
+//  lines start with "sim:".
+//
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "switch_subcmd.h"
+
+#include "sim.h"
+
+#ifndef SIM_FIRMWARE
+#define SIM_FIRMWARE        "firmware"
+#endif
+
+#define STARTUP_TIMEOUT_MS  5000
+//paging and authentication take about as long, app_main has returned by then
+#define CONNECT_DELAY_MS    100
+#define UNPLUG_MS           200
+#define REPORT_A            3       // but1 in reports 0x30 and 0x21
+#define REPORT_A_BIT        0x08
+
+void app_main(void);
+
+typedef struct {
+    uint32_t input;             // 0x30
+    uint32_t reply;             // 0x21
+    uint32_t filler;            // unpaired keep-alive
+    uint32_t other;
+    int64_t last_input_us;
+    latency_hist_t interval;
+    latency_hist_t a_latency;
+    //A change waiting for its report
+    bool a_pending;
+    bool a_state;
+    int64_t a_time_us;
+    uint32_t a_changes;
+    uint32_t a_missed;          // changed again before it was reported
+} sim_stats_t;
+
+static pthread_mutex_t stats_lock = PTHREAD_MUTEX_INITIALIZER;
+static sim_stats_t stats;
+
+static uint32_t xorshift(uint32_t *seed)
+{
+    uint32_t x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *seed = x;
+}
+
+//Runs in the thread that sent the report
+static void on_report(uint8_t report_id, const uint8_t *data, uint16_t len, int64_t time_us)
+{
+    pthread_mutex_lock(&stats_lock);
+    switch(report_id)
+    {
+        case 0x30:
+            stats.input++;
+            if(stats.last_input_us != 0)
+                sim_hist_add(&stats.interval, time_us - stats.last_input_us);
+            stats.last_input_us = time_us;
+            if(stats.a_pending && len > REPORT_A && ((data[REPORT_A] & REPORT_A_BIT) != 0) == stats.a_state)
+            {
+                sim_hist_add(&stats.a_latency, time_us - stats.a_time_us);
+                stats.a_pending = false;
+            }
+            break;
+        case 0x21:
+            stats.reply++;
+            break;
+        case 0x00:
+            stats.filler++;
+            break;
+        default:
+            stats.other++;
+            break;
+    }
+    pthread_mutex_unlock(&stats_lock);
+}
+
+//MCU config is the last subcommand of the pairing sequence, the firmware
+//sends input reports 0x30 from then on
+static void finish_pairing(void)
+{
+    uint8_t report[49] = { 0x01 };
+
+    report[SWITCH_SUBCMD_OFFSET] = 0x21;
+    report[SWITCH_SUBCMD_ARG] = 0x21;
+    sim_bt_output(report, sizeof(report));
+}
+
+static void press(uint32_t *seed, bool a)
+{
+    sim_pad_state_t pad = {
+        .a = a,
+        .x = (int8_t)(xorshift(seed) % 161 - 80),
+        .y = (int8_t)(xorshift(seed) % 161 - 80),
+    };
+
+    pthread_mutex_lock(&stats_lock);
+    if(stats.a_pending)
+        stats.a_missed++;
+    stats.a_pending = true;
+    stats.a_state = a;
+    stats.a_time_us = sim_time_us();
+    stats.a_changes++;
+    pthread_mutex_unlock(&stats_lock);
+    sim_pad_set(&pad);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: fw_<name> [-t seconds] [-p ms] [-u ms] [-s seed]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    double seconds = 5;
+    uint32_t press_ms = 100;
+    uint32_t unplug_ms = 0;
+    uint32_t seed = 1;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:p:u:s:")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': seconds = atof(optarg); break;
+            case 'p': press_ms = strtoul(optarg, NULL, 0); break;
+            case 'u': unplug_ms = strtoul(optarg, NULL, 0); break;
+            case 's': seed = strtoul(optarg, NULL, 0); break;
+            default: usage();
+        }
+    }
+    if(seconds <= 0 || press_ms == 0 || seed == 0)
+        usage();
+
+    sim_pad_plug(true);
+    sim_bt_set_report_cb(on_report);
+    sim_start(app_main);
+    if(!sim_bt_wait_connectable(STARTUP_TIMEOUT_MS))
+    {
+        fprintf(stderr, "sim: %s did not become connectable\n", SIM_FIRMWARE);
+        return 1;
+    }
+    sim_sleep_until(sim_time_us() + CONNECT_DELAY_MS * 1000);
+    sim_bt_connect();
+    finish_pairing();
+
+    int64_t start = sim_time_us();
+    int64_t end = start + (int64_t)(seconds * 1000000);
+    int64_t next_press = start + press_ms * 1000;
+    int64_t next_unplug = unplug_ms > 0 ? start + unplug_ms * 1000 : end;
+    int64_t replug = 0;
+    uint32_t unplugs = 0;
+    bool a = false;
+    while(1)
+    {
+        int64_t next = next_press < next_unplug ? next_press : next_unplug;
+        if(replug != 0 && replug < next)
+            next = replug;
+        if(next >= end)
+            break;
+        sim_sleep_until(next);
+        if(next == replug)
+        {
+            sim_pad_plug(true);
+            replug = 0;
+        }
+        else if(next == next_unplug)
+        {
+            //the firmware reports neutral input while the pad is gone
+            sim_pad_plug(false);
+            pthread_mutex_lock(&stats_lock);
+            stats.a_pending = false;
+            pthread_mutex_unlock(&stats_lock);
+            a = false;
+            unplugs++;
+            replug = next + UNPLUG_MS * 1000;
+            next_unplug += unplug_ms * 1000;
+        }
+        else
+        {
+            if(replug == 0)
+            {
+                a = !a;
+                press(&seed, a);
+            }
+            next_press += press_ms * 1000;
+        }
+    }
+    sim_sleep_until(end);
+
+    pthread_mutex_lock(&stats_lock);
+    sim_stats_t s = stats;
+    pthread_mutex_unlock(&stats_lock);
+    double run = (sim_time_us() - start) / 1e6;
+    printf("sim: %s with a %s controller, %.1fs\n", SIM_FIRMWARE, sim_pad_name, run);
+    printf("sim: reports 0x30 %u (%.1f/s), 0x21 %u, filler %u, other %u\n",
+        (unsigned)s.input, s.input / run, (unsigned)s.reply, (unsigned)s.filler, (unsigned)s.other);
+    sim_hist_print("0x30 interval", &s.interval);
+    sim_hist_print("A to report", &s.a_latency);
+    printf("sim: A changes %u, %u overtaken by the next one, %u unplugs\n",
+        (unsigned)s.a_changes, (unsigned)s.a_missed, (unsigned)unplugs);
+#ifdef LATENCY_TRACE
+    latency_dump(false);
+#endif
+    fflush(stdout);
+    //the firmware tasks never return
+    exit(s.input > 0 ? 0 : 1);
+}
@@ -0,0 +1,45 @@
+//
+//  Latency histograms for the runners
+//
+
+#include <stdio.h>
+
+#include "sim.h"
+
+void sim_hist_add(latency_hist_t *h, int64_t us)
+{
+    uint32_t v = us < 0 ? 0 : us > UINT32_MAX ? UINT32_MAX : (uint32_t)us;
+
+    h->count++;
+    h->total_us += v;
+    if(v > h->max_us)
+        h->max_us = v;
+    h->bucket[latency_bucket(v)]++;
+}
+
+uint32_t sim_hist_percentile(const latency_hist_t *h, uint32_t per_mille)
+{
+    uint64_t want = ((uint64_t)h->count * per_mille + 999) / 1000;
+    uint64_t seen = 0;
+
+    for(int i = 0; i < LATENCY_BUCKETS - 1; i++)
+    {
+        seen += h->bucket[i];
+        if(seen >= want)
+            return latency_bucket_floor(i + 1);
+    }
+    return h->max_us;
+}
+
+void sim_hist_print(const char *name, const latency_hist_t *h)
+{
+    if(h->count == 0)
+    {
+        printf("sim: %s no samples\n", name);
+        return;
+    }
+    printf("sim: %s n %u avg %uus max %uus p50 <%uus p90 <%uus p99 <%uus\n",
+        name, (unsigned)h->count, (unsigned)(h->total_us / h->count), (unsigned)h->max_us,
+        (unsigned)sim_hist_percentile(h, 500), (unsigned)sim_hist_percentile(h, 900),
+        (unsigned)sim_hist_percentile(h, 990));
+}
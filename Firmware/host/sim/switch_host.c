@@ -0,0 +1,309 @@
+//
+//  switch_host - pairs a Switch firmware on the host the way the console does
+//
+//  Usage:
+//    pair_<name> [-n sessions] [-t seconds] [-w ms] [-r retries]
+//
+//  Connects to the firmware once it is discoverable and sends the
+//  subcommands a Switch sends to a new Pro Controller, in its order
+//  (switch_pairing.c): device info, shipment state, the SPI flash reads of
+//  serial number, colours, sensor and stick parameters and calibration,
+//  input report mode, trigger time, IMU, vibration, player lights and MCU
+//  config.
+//  Each one must be answered by a 0x21 reply within -w ms (default 100)
+//  that echoes the subcommand and carries the expected ACK and payload,
+//  SPI reads are compared with the flash bytes written out in
+//  switch_pairing.c, not with switch_spi.c. Like the console it sends a
+//  subcommand again when no reply came, up to -r times (default 3), and
+//  gives up on the session after that.
+//
+//  Once paired it counts the 0x30 reports for -t seconds (default 1),
+//  disconnects and pairs again, -n sessions in all (default 5). One line
+//  per session and a summary follow, all starting with "sim:":
+//
+//    pairing       connect to the MCU config reply
+//    first 0x30    MCU config reply to the first input report
+//    reply         subcommand to its reply
+//    0x30 interval spacing of the input reports while paired
+//
+//  Exits non-zero when a reply was missing or wrong or a session saw no
+//  input report, so it can run as a regression check.
+//
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "switch_pairing.h"
+#include "switch_subcmd.h"
+
+#include "sim.h"
+
+#ifndef SIM_FIRMWARE
+#define SIM_FIRMWARE        "firmware"
+#endif
+
+#define STARTUP_TIMEOUT_MS  5000
+#define CONNECT_DELAY_MS    100
+#define REPLY_REPORT_ID     0x21
+#define INPUT_REPORT_ID     0x30
+#define DEVICE_TYPE_PRO     0x03    // device info byte 2
+
+void app_main(void);
+
+typedef struct {
+    uint32_t sessions;
+    uint32_t paired;
+    uint32_t sent;                  // output reports with a subcommand, retries included
+    uint32_t missing;               // attempts without a reply
+    uint32_t bad;                   // replies with the wrong ACK or payload
+    uint32_t unexpected;            // replies echoing another subcommand
+    uint32_t early_input;           // 0x30 before MCU config was answered
+    uint32_t no_input;              // paired sessions without a 0x30
+    latency_hist_t pairing;
+    latency_hist_t first_input;
+    latency_hist_t reply;
+    latency_hist_t interval;
+} host_stats_t;
+
+static pthread_mutex_t host_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t host_cond;
+
+//Written by on_report, read by the runner under host_lock
+static uint32_t reply_seq;
+static uint8_t reply[SWITCH_OUTPUT_LEN];
+static uint16_t reply_len;
+static int64_t reply_us;
+static bool paired;
+static uint32_t inputs;
+static int64_t first_input_us;
+static int64_t last_input_us;
+
+static host_stats_t stats;
+static uint8_t packet_counter;
+
+//Runs in the thread that sent the report
+static void on_report(uint8_t report_id, const uint8_t *data, uint16_t len, int64_t time_us)
+{
+    pthread_mutex_lock(&host_lock);
+    if(report_id == REPLY_REPORT_ID)
+    {
+        reply_len = len < sizeof(reply) ? len : sizeof(reply);
+        memcpy(reply, data, reply_len);
+        reply_us = time_us;
+        reply_seq++;
+        pthread_cond_broadcast(&host_cond);
+    }
+    else if(report_id == INPUT_REPORT_ID)
+    {
+        if(!paired)
+            stats.early_input++;
+        else
+        {
+            if(inputs == 0)
+                first_input_us = time_us;
+            else
+                sim_hist_add(&stats.interval, time_us - last_input_us);
+            last_input_us = time_us;
+            inputs++;
+        }
+    }
+    pthread_mutex_unlock(&host_lock);
+}
+
+//Compares a reply with what a Pro Controller answers, NULL when it matches
+static const char *check_reply(const switch_pairing_req_t *req, const uint8_t *r, uint16_t len)
+{
+    static char why[64];
+    const uint8_t *payload = &r[SWITCH_REPLY_DATA];
+
+    if(len != SWITCH_REPLY_LEN)
+    {
+        snprintf(why, sizeof(why), "length %u", (unsigned)len);
+        return why;
+    }
+    if(req->ack != 0 ? r[SWITCH_REPLY_ACK] != req->ack : !(r[SWITCH_REPLY_ACK] & SWITCH_ACK))
+    {
+        snprintf(why, sizeof(why), "ack %02x", r[SWITCH_REPLY_ACK]);
+        return why;
+    }
+    if(req->subcmd == 0x02 && payload[2] != DEVICE_TYPE_PRO)
+    {
+        snprintf(why, sizeof(why), "device type %02x", payload[2]);
+        return why;
+    }
+    if(req->subcmd == SWITCH_SUBCMD_SPI_READ)
+    {
+        //address and length are echoed ahead of the data
+        if(memcmp(payload, req->arg, sizeof(req->arg)) != 0)
+            return "address not echoed";
+        if(memcmp(&payload[sizeof(req->arg)], req->data, req->arg[4]) != 0)
+            return "flash data differs";
+    }
+    return NULL;
+}
+
+//Sends one subcommand and waits for its reply, false once the retries
+//are used up or the reply is wrong
+static bool request(const switch_pairing_req_t *req, uint32_t wait_ms, uint32_t retries)
+{
+    uint8_t out[SWITCH_OUTPUT_LEN];
+    struct timespec ts;
+
+    for(uint32_t attempt = 0; attempt <= retries; attempt++)
+    {
+        switch_pairing_packet(req, packet_counter++, out);
+        pthread_mutex_lock(&host_lock);
+        uint32_t seq = reply_seq;
+        pthread_mutex_unlock(&host_lock);
+
+        int64_t sent_us = sim_time_us();
+        stats.sent++;
+        sim_bt_output(out, sizeof(out));
+
+        sim_deadline(&ts, (int64_t)wait_ms * 1000);
+        bool answered = false;
+        pthread_mutex_lock(&host_lock);
+        while(!answered)
+        {
+            while(reply_seq == seq && pthread_cond_timedwait(&host_cond, &host_lock, &ts) == 0)
+                ;
+            if(reply_seq == seq)
+                break;
+            seq = reply_seq;
+            if(reply_len > SWITCH_REPLY_SUBCMD && reply[SWITCH_REPLY_SUBCMD] == req->subcmd)
+                answered = true;
+            else
+                stats.unexpected++;
+        }
+        uint8_t r[SWITCH_OUTPUT_LEN];
+        uint16_t len = reply_len;
+        int64_t at = reply_us;
+        memcpy(r, reply, len);
+        pthread_mutex_unlock(&host_lock);
+
+        if(!answered)
+        {
+            stats.missing++;
+            printf("sim:   %02x %-28s no reply\n", req->subcmd, req->name);
+            continue;
+        }
+        sim_hist_add(&stats.reply, at - sent_us);
+        const char *why = check_reply(req, r, len);
+        if(why != NULL)
+        {
+            stats.bad++;
+            printf("sim:   %02x %-28s bad reply: %s\n", req->subcmd, req->name, why);
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+static void session(uint32_t n, double seconds, uint32_t wait_ms, uint32_t retries)
+{
+    stats.sessions++;
+    if(!sim_bt_wait_connectable(STARTUP_TIMEOUT_MS))
+    {
+        printf("sim: session %u firmware did not become connectable\n", (unsigned)n);
+        return;
+    }
+    sim_sleep_until(sim_time_us() + CONNECT_DELAY_MS * 1000);
+
+    pthread_mutex_lock(&host_lock);
+    paired = false;
+    inputs = 0;
+    pthread_mutex_unlock(&host_lock);
+    packet_counter = 0;
+
+    int64_t start = sim_time_us();
+    sim_bt_connect();
+    for(size_t i = 0; i < switch_pairing_count; i++)
+    {
+        if(!request(&switch_pairing[i], wait_ms, retries))
+        {
+            printf("sim: session %u failed at %02x %s\n", (unsigned)n, switch_pairing[i].subcmd, switch_pairing[i].name);
+            sim_bt_disconnect();
+            return;
+        }
+    }
+
+    pthread_mutex_lock(&host_lock);
+    int64_t paired_us = reply_us;
+    paired = true;
+    pthread_mutex_unlock(&host_lock);
+    stats.paired++;
+    sim_hist_add(&stats.pairing, paired_us - start);
+
+    sim_sleep_until(paired_us + (int64_t)(seconds * 1000000));
+    //no reports get through once disconnected
+    sim_bt_disconnect();
+    pthread_mutex_lock(&host_lock);
+    uint32_t count = inputs;
+    int64_t first = first_input_us;
+    paired = false;
+    pthread_mutex_unlock(&host_lock);
+
+    if(count == 0)
+    {
+        stats.no_input++;
+        printf("sim: session %u paired in %uus, no 0x30 reports\n", (unsigned)n, (unsigned)(paired_us - start));
+        return;
+    }
+    sim_hist_add(&stats.first_input, first - paired_us);
+    printf("sim: session %u paired in %uus, first 0x30 after %uus, %u 0x30 reports\n", (unsigned)n,
+        (unsigned)(paired_us - start), (unsigned)(first - paired_us), (unsigned)count);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: pair_<name> [-n sessions] [-t seconds] [-w ms] [-r retries]\n");
+    exit(2);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t sessions = 5;
+    double seconds = 1;
+    uint32_t wait_ms = 100;
+    uint32_t retries = 3;
+    int opt;
+
+    while((opt = getopt(argc, argv, "n:t:w:r:")) != -1)
+    {
+        switch(opt)
+        {
+            case 'n': sessions = strtoul(optarg, NULL, 0); break;
+            case 't': seconds = atof(optarg); break;
+            case 'w': wait_ms = strtoul(optarg, NULL, 0); break;
+            case 'r': retries = strtoul(optarg, NULL, 0); break;
+            default: usage();
+        }
+    }
+    if(sessions == 0 || seconds <= 0 || wait_ms == 0)
+        usage();
+
+    sim_cond_init(&host_cond);
+    sim_pad_plug(true);
+    sim_bt_set_report_cb(on_report);
+    sim_start(app_main);
+    for(uint32_t n = 1; n <= sessions; n++)
+        session(n, seconds, wait_ms, retries);
+
+    host_stats_t s = stats;
+    printf("sim: %s with a %s controller, %u of %u sessions paired\n",
+        SIM_FIRMWARE, sim_pad_name, (unsigned)s.paired, (unsigned)s.sessions);
+    printf("sim: subcommands %u sent, %u missing replies, %u bad, %u unexpected\n",
+        (unsigned)s.sent, (unsigned)s.missing, (unsigned)s.bad, (unsigned)s.unexpected);
+    printf("sim: 0x30 before pairing %u, sessions without 0x30 %u\n",
+        (unsigned)s.early_input, (unsigned)s.no_input);
+    sim_hist_print("pairing", &s.pairing);
+    sim_hist_print("first 0x30", &s.first_input);
+    sim_hist_print("reply", &s.reply);
+    sim_hist_print("0x30 interval", &s.interval);
+    fflush(stdout);
+    //the firmware tasks never return
+    exit(s.paired == s.sessions && s.missing == 0 && s.bad == 0 && s.no_input == 0 ? 0 : 1);
+}
@@ -0,0 +1,153 @@
+//
+//  stick_check - compares the fixed point stick shaping against a float model
+//
+//  Usage: stick_check [-t tolerance] [-v]
+//
+//  For a set of calibrations and shaping settings, builds the firmware
+//  tables with stick_shape_init() and runs every one of the 65536 raw x/y
+//  combinations through stick_shape_apply() and through a double precision
+//  model of the same steps. Reports the mean and largest difference in
+//  Switch stick units (full deflection = STICK_OUT_RANGE) and fails if any
+//  difference exceeds the tolerance. The const octagon gain table is also
+//  checked against its formula.
+//
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "stick_shape.h"
+
+typedef struct {
+    const char *name;
+    stick_shape_config_t config;
+} stick_case_t;
+
+static const stick_case_t cases[] = {
+    { "gc main stick",      { { 128, 28, 228 }, { 128, 28, 228 }, 256, 3840, 0, true } },
+    { "gc c-stick",         { { 126, 38, 214 }, { 131, 43, 219 }, 384, 3840, 0, true } },
+    { "asymmetric, curve",  { { 120, 30, 230 }, { 135, 25, 220 }, 320, 3968, 128, true } },
+    { "square, quadratic",  { { 128, 0, 255 },  { 128, 0, 255 },  0,   4096, 255, false } },
+    { "wide deadzone",      { { 128, 28, 228 }, { 128, 28, 228 }, 1024, 3584, 64, true } },
+};
+
+static double model_axis(const stick_axis_cal_t *cal, int raw)
+{
+    double d = raw - cal->center;
+    double v = 0;
+    if(d > 0 && cal->max > cal->center)
+        v = d * STICK_NORM / (cal->max - cal->center);
+    else if(d < 0 && cal->center > cal->min)
+        v = d * STICK_NORM / (cal->center - cal->min);
+    if(v > STICK_NORM_MAX) v = STICK_NORM_MAX;
+    if(v < -STICK_NORM_MAX) v = -STICK_NORM_MAX;
+    return v;
+}
+
+static double model_out(double v)
+{
+    v = round(v + STICK_OUT_CENTER);
+    if(v < 0) return 0;
+    if(v > STICK_OUT_MAX) return STICK_OUT_MAX;
+    return v;
+}
+
+static void model_apply(const stick_shape_config_t *c, int raw_x, int raw_y, double *out_x, double *out_y)
+{
+    double x = model_axis(&c->x, raw_x);
+    double y = model_axis(&c->y, raw_y);
+
+    if(c->octagon && (x != 0 || y != 0))
+    {
+        double t = atan2(fmin(fabs(x), fabs(y)), fmax(fabs(x), fabs(y)));
+        double g = cos(t - M_PI / 8) / cos(M_PI / 8);
+        x *= g;
+        y *= g;
+    }
+
+    double r = hypot(x, y);
+    double scale = 0;
+    if(r > c->deadzone)
+    {
+        double u = (r - c->deadzone) / (c->outer - c->deadzone);
+        if(u > 1) u = 1;
+        double k = c->curve / 256.0;
+        double out = u * ((1 - k) + k * u) * STICK_OUT_RANGE;
+        scale = out / r;
+    }
+    *out_x = model_out(x * scale);
+    *out_y = model_out(y * scale);
+}
+
+static int check_octagon_table(void)
+{
+    int bad = 0;
+    for(int i = 0; i <= STICK_OCT_STEPS; i++)
+    {
+        double g = cos(atan((double)i / STICK_OCT_STEPS) - M_PI / 8) / cos(M_PI / 8);
+        if(fabs(g * (1 << STICK_OCT_SHIFT) - stick_octagon_gain[i]) > 0.5)
+        {
+            printf("octagon gain %d: table %u, expected %.1f\n", i, stick_octagon_gain[i], g * (1 << STICK_OCT_SHIFT));
+            bad++;
+        }
+    }
+    return bad;
+}
+
+int main(int argc, char **argv)
+{
+    double tolerance = 8;
+    int verbose = 0;
+    int opt;
+
+    while((opt = getopt(argc, argv, "t:v")) != -1)
+    {
+        switch(opt)
+        {
+            case 't': tolerance = atof(optarg); break;
+            case 'v': verbose = 1; break;
+            default:
+                fprintf(stderr, "usage: stick_check [-t tolerance] [-v]\n");
+                return 2;
+        }
+    }
+
+    int failed = check_octagon_table();
+    static stick_shape_t shape;
+
+    for(size_t n = 0; n < sizeof(cases) / sizeof(cases[0]); n++)
+    {
+        const stick_shape_config_t *c = &cases[n].config;
+        double max_err = 0;
+        double sum_err = 0;
+        int worst_x = 0, worst_y = 0;
+
+        stick_shape_init(&shape, c);
+        for(int rx = 0; rx < 256; rx++)
+        {
+            for(int ry = 0; ry < 256; ry++)
+            {
+                uint16_t fx, fy;
+                double mx, my;
+                stick_shape_apply(&shape, rx, ry, &fx, &fy);
+                model_apply(c, rx, ry, &mx, &my);
+                double err = fmax(fabs(fx - mx), fabs(fy - my));
+                sum_err += err;
+                if(err > max_err)
+                {
+                    max_err = err;
+                    worst_x = rx;
+                    worst_y = ry;
+                }
+                if(verbose && err > tolerance)
+                    printf("  %3d %3d: %4u %4u, model %4.0f %4.0f\n", rx, ry, fx, fy, mx, my);
+            }
+        }
+        int ok = max_err <= tolerance;
+        printf("%-20s mean %.2f max %.0f (at %d,%d) %s\n", cases[n].name,
+               sum_err / 65536, max_err, worst_x, worst_y, ok ? "ok" : "FAIL");
+        failed += !ok;
+    }
+    return failed ? 1 : 0;
+}
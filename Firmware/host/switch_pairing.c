@@ -0,0 +1,71 @@
+//
+//  Switch pairing sequence for the host tools
+//
+
+#include <string.h>
+
+#include "switch_pairing.h"
+#include "switch_subcmd.h"
+
+#define SPI_READ(addr, len, name, data) \
+    { SWITCH_SUBCMD_SPI_READ, 5, { (addr) & 0xFF, (addr) >> 8, 0, 0, (len) }, 0x90, name, data }
+
+//What the firmware's flash image holds at each read, written out here so the
+//runners do not check switch_spi.c against itself
+static const uint8_t serial_number[0x10] = { 0 };
+static const uint8_t colours[0x0D] = { 0 };
+static const uint8_t sensor_parameters[0x18] = {
+    0x5E, 0x01, 0x00, 0x00, 0xF1, 0x0F,
+    0x19, 0xD0, 0x4C, 0xAE, 0x40, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+static const uint8_t stick_parameters_2[0x12] = {
+    0x19, 0xD0, 0x4C, 0xAE, 0x40, 0xE1, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+//no user calibration magic, the factory values apply
+static const uint8_t user_stick_cal[0x18] = { 0 };
+//centre 0x7F0 and 0x7F0 either way for both sticks, then the colours
+static const uint8_t factory_stick_cal[0x19] = {
+    0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F,
+    0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F, 0xF0, 0x07, 0x7F,
+    0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+static const uint8_t factory_imu_cal[0x18] = { 0 };
+static const uint8_t user_imu_cal[0x18] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+const switch_pairing_req_t switch_pairing[] = {
+    { 0x02, 0, { 0 },    0x82, "device info" },
+    { 0x08, 1, { 0x00 }, 0,    "shipment low power state" },
+    SPI_READ(0x6000, 0x10, "serial number", serial_number),
+    SPI_READ(0x6050, 0x0D, "colours", colours),
+    SPI_READ(0x6080, 0x18, "sensor parameters", sensor_parameters),
+    SPI_READ(0x6098, 0x12, "stick parameters 2", stick_parameters_2),
+    SPI_READ(0x8010, 0x18, "user stick calibration", user_stick_cal),
+    SPI_READ(0x603D, 0x19, "factory stick calibration", factory_stick_cal),
+    SPI_READ(0x6020, 0x18, "factory IMU calibration", factory_imu_cal),
+    SPI_READ(0x8028, 0x18, "user IMU calibration", user_imu_cal),
+    { 0x03, 1, { 0x30 }, 0,    "input report mode 0x30" },
+    { 0x04, 0, { 0 },    0x83, "trigger buttons elapsed time" },
+    { 0x40, 1, { 0x01 }, 0,    "enable IMU" },
+    { 0x48, 1, { 0x01 }, 0,    "enable vibration" },
+    { 0x30, 1, { 0x01 }, 0,    "player lights" },
+    { 0x21, 1, { 0x21 }, 0,    "MCU config" },
+};
+const size_t switch_pairing_count = sizeof(switch_pairing) / sizeof(switch_pairing[0]);
+
+void switch_pairing_packet(const switch_pairing_req_t *req, uint8_t counter, uint8_t out[SWITCH_OUTPUT_LEN])
+{
+    //neutral rumble for both motors
+    static const uint8_t rumble[8] = { 0x00, 0x01, 0x40, 0x40, 0x00, 0x01, 0x40, 0x40 };
+
+    memset(out, 0, SWITCH_OUTPUT_LEN);
+    out[0] = SWITCH_OUTPUT_SUBCMD;
+    out[1] = counter & 0x0F;
+    memcpy(&out[2], rumble, sizeof(rumble));
+    out[SWITCH_SUBCMD_OFFSET] = req->subcmd;
+    memcpy(&out[SWITCH_SUBCMD_ARG], req->arg, req->arg_len);
+}
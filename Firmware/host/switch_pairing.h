@@ -0,0 +1,34 @@
+//
+//  Switch pairing sequence for the host tools
+//
+//  The subcommands a Switch sends to a Pro Controller it pairs with, in the
+//  console's order, and the output report 0x01 that carries each of them.
+//  Played by the pair_ runners in sim/ and written out as fuzzing seeds.
+//
+
+#ifndef SWITCH_PAIRING_H
+#define SWITCH_PAIRING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "switch_subcmd.h"
+
+#define SWITCH_OUTPUT_LEN       49
+
+typedef struct {
+    uint8_t subcmd;
+    uint8_t arg_len;
+    uint8_t arg[5];
+    uint8_t ack;                // expected ACK, 0: any ACK (bit 7 set)
+    const char *name;
+    const uint8_t *data;        // SPI reads: expected flash data, arg[4] bytes
+} switch_pairing_req_t;
+
+extern const switch_pairing_req_t switch_pairing[];
+extern const size_t switch_pairing_count;
+
+//Output report for req with packet counter (low 4 bits) and neutral rumble
+void switch_pairing_packet(const switch_pairing_req_t *req, uint8_t counter, uint8_t out[SWITCH_OUTPUT_LEN]);
+
+#endif